@@ -50,21 +50,18 @@ bool Demo::update() {
     return false;
 }
 
-void Demo::render() {
-  using namespace std::string_literals;
-  img->blit(
-      TCODConsole::root,
-      static_cast<float>(getEngine()->getRootWidth() / 2),
-      static_cast<float>(getEngine()->getRootHeight() / 2));
-  tcod::print(*TCODConsole::root, {1, 3}, "Read custom parameters from module.txt:", tcod::ColorRGB{255, 255, 255}, {});
-  tcod::print(
-      *TCODConsole::root, {1, 5}, "chainParam1:"s + getStringParam("chainParam1"), tcod::ColorRGB{255, 255, 255}, {});
-  tcod::print(
-      *TCODConsole::root, {1, 6}, "chainParam2:"s + getStringParam("chainParam2"), tcod::ColorRGB{255, 255, 255}, {});
-  tcod::print(
-      *TCODConsole::root, {1, 7}, "chainParam3:"s + getStringParam("chainParam3"), tcod::ColorRGB{255, 255, 255}, {});
-  tcod::print(
-      *TCODConsole::root, {1, 8}, "moduleParam:"s + getStringParam("moduleParam"), tcod::ColorRGB{255, 255, 255}, {});
+void Demo::recordDraw(render::DrawList& commands) {
+  const auto white = tcod::ColorRGB{255, 255, 255};
+  commands.blit(*img, {0, 0, getEngine()->getRootWidth(), getEngine()->getRootHeight()});
+  commands.print(1, 3, "Read custom parameters from module.txt:", white);
+  commands.printFormatted(1, 5, white, TCOD_LEFT, "chainParam1:{}", chainParam1.get());
+  commands.printFormatted(1, 6, white, TCOD_LEFT, "chainParam2:{}", chainParam2.get());
+  commands.printFormatted(1, 7, white, TCOD_LEFT, "chainParam3:{}", chainParam3.get());
+  commands.printFormatted(1, 8, white, TCOD_LEFT, "moduleParam:{}", moduleParam.get());
+}
+
+void Demo::onResize(int width, int height) {
+  img = std::make_unique<TCODImage>(width, height);
 }
 
 void Demo::onEvent(const SDL_Event& ev) {
@@ -40,15 +40,29 @@ class Demo : public module::Module {
  public:
   void onInitialise() override {
     img = std::make_unique<TCODImage>(getEngine()->getRootWidth(), getEngine()->getRootHeight());
+    chainParam1 = param<const char*>("chainParam1");
+    chainParam2 = param<const char*>("chainParam2");
+    chainParam3 = param<const char*>("chainParam3");
+    moduleParam = param<const char*>("moduleParam");
+    // drawn through draw commands. The noise only sets the backgrounds, so the glyphs of the modules under it stay
+    // visible: the module doesn't hide them and has no opaque region
+    module::LayerSettings layer{};
+    layer.recorded = true;
+    setLayer(layer);
   }
+  void onResize(int width, int height) override;
   bool update() override;
-  void render() override;
+  void recordDraw(render::DrawList& commands) override;
   void onEvent(const SDL_Event& ev) override;
 
  private:
   TCODNoise noise{2, TCODRandom::getInstance()};
   std::unique_ptr<TCODImage> img{};
   float offset{};
+  module::ParamHandle<const char*> chainParam1{};
+  module::ParamHandle<const char*> chainParam2{};
+  module::ParamHandle<const char*> chainParam3{};
+  module::ParamHandle<const char*> moduleParam{};
 };
 
 #endif
@@ -68,8 +68,9 @@ int main(int argc, char* argv[]) {
   salient_engine.setWindowTitle("Salient demo");
   salient_engine.setKeyboardMode(engine::KEYBOARD_SDL);
   // initialise and run the engine
-  if (salient_engine.loadModuleConfiguration("data/cfg/module.txt", new ModuleFactory()) && salient_engine.initialise())
-    return salient_engine.run();
-  else
+  if (!salient_engine.loadModuleConfiguration("data/cfg/module.txt", new ModuleFactory()) ||
+      !salient_engine.initialise())
     return 1;
+  salient_engine.loadStyleSheet("data/cfg/style.txt");
+  return salient_engine.run();
 }
@@ -42,49 +42,67 @@ constexpr std::array CHARACTERS{'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J'
                                 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r', 's', 't', 'u',
                                 'v', 'w', 'x', 'y', 'z', '1', '2', '3', '4', '5', '6', '7', '8', '9'};
 
+Matrix::Matrix() {
+  // advance the leads, dropping those past the end once the systems have run
+  updateSystems.add(ecs::access<MatrixLead>(), [this](ecs::World& world, float) {
+    const auto now = SDL_GetTicks64();
+    world.parallelEach<MatrixLead>(getEngine()->getJobPool(), [&](ecs::Entity entity, MatrixLead& lead) {
+      if (lead.next_y_ms <= now) {
+        ++lead.y;
+        lead.next_y_ms = now + lead.y_duration_ms;
+      }
+      if (lead.y >= console.getHeight()) world.getCommands().destroy(entity);
+    });
+  });
+}
+
 bool Matrix::update() {
   const auto now = SDL_GetTicks64();
   if (next_lead_ms <= now) {
     next_lead_ms = now + rng() % 200;
-    auto& new_lead = leads.emplace_back();
+    MatrixLead new_lead{};
     new_lead.x = rng() % (salient_engine.getRootWidth() - 1);
     new_lead.y_duration_ms = 50 + rng() % 200;
     new_lead.next_y_ms = now + new_lead.y_duration_ms;
+    world.create(new_lead);
   }
-  return getActive();
+  return ecs::WorldModule::update();
 }
 
-void Matrix::render() {
-  const auto now = SDL_GetTicks64();
-  // Advance leads.
-  for (auto& lead : leads) {
-    if (lead.next_y_ms <= now) {
-      ++lead.y;
-      lead.next_y_ms = now + lead.y_duration_ms;
-    }
-  }
-  // Remove leads past the end.
-  leads.erase(
-      std::remove_if(
-          leads.begin(), leads.end(), [&](const MatrixLead& lead) { return lead.y >= salient_engine.getRootHeight(); }),
-      leads.end());
+void Matrix::renderLayer(TCODConsole& layer) {
   // Render leads.
-  for (const auto& lead : leads) {
-    auto& tile = console.at({lead.x, lead.y});
-    tile.ch = CHARACTERS.at(rng() % CHARACTERS.size());
-    tile.fg = tcod::ColorRGB{63, 255, 63};
-  }
-  tcod::blit(*TCODConsole::root, console);
-  // Fade lead colors.
-  const auto fade_function = [](uint8_t v) -> uint8_t { return v ? v - (v / 50 + 1) : 0; };
-  for (auto& tile : console) {
-    tile.fg.r = fade_function(tile.fg.r);
-    tile.fg.g = fade_function(tile.fg.g);
-    tile.fg.b = fade_function(tile.fg.b);
-  }
+  int* glyphs = console.getGlyphs();
+  TCOD_ColorRGBA* colours = console.getColours(render::PlanarConsole::PLANE_FOREGROUND);
+  world.each<const MatrixLead>([&](const MatrixLead& lead) {
+    const size_t index = static_cast<size_t>(lead.y) * console.getWidth() + lead.x;
+    glyphs[index] = CHARACTERS.at(rng() % CHARACTERS.size());
+    colours[index] = TCOD_ColorRGBA{63, 255, 63, 255};
+  });
+  console.toConsole(*layer.get_data());
+  // Fade lead colors: v * 49 / 50 - 1.
+  console.multiply(render::PlanarConsole::PLANE_FOREGROUND, {250, 250, 250, 255});
+  console.fade(render::PlanarConsole::PLANE_FOREGROUND, {1, 1, 1, 0});
 }
 
 void Matrix::onActivate() {
   getEngine()->printCredits(51, 1);
-  console = tcod::Console{salient_engine.getRootWidth(), salient_engine.getRootHeight()};
+  console.resize(salient_engine.getRootWidth(), salient_engine.getRootHeight());
+  // the rain covers the whole screen and only touches the module's own state
+  module::LayerSettings layer{};
+  layer.layered = true;
+  layer.parallel = true;
+  layer.opaqueRegion = {0, 0, console.getWidth(), console.getHeight()};
+  setLayer(layer);
+}
+
+void Matrix::onResize(int width, int height) {
+  if (getActive()) console.resize(width, height);
+  module::LayerSettings layer = getLayer();
+  layer.opaqueRegion = {0, 0, width, height};
+  setLayer(layer);
+  // drop the leads that now fall outside of the console
+  world.each<const MatrixLead>([&](ecs::Entity entity, const MatrixLead& lead) {
+    if (lead.x >= width || lead.y >= height) world.getCommands().destroy(entity);
+  });
+  world.flush();
 }
@@ -35,7 +35,6 @@
 
 #include <libtcod/libtcod.hpp>
 #include <random>
-#include <vector>
 
 struct MatrixLead {
   int x{}, y{};  // coordinates
@@ -43,18 +42,18 @@ struct MatrixLead {
   int y_duration_ms{};  // how long it takes to increment y
 };
 
-class Matrix : public module::Module {
+class Matrix : public ecs::WorldModule {
  public:
+  Matrix();
   bool update() override;
-  void render() override;
+  void renderLayer(TCODConsole& layer) override;
   void onActivate() override;
-  void onEvent(const SDL_Event&) override {}
+  void onResize(int width, int height) override;
 
  private:
-  std::vector<MatrixLead> leads{};
   uint64_t next_lead_ms{};  // The time when the next lead is spawned.
   std::mt19937 rng{std::random_device{}()};
-  tcod::Console console{};
+  render::PlanarConsole console{};
 };
 
 #endif
@@ -35,7 +35,9 @@
 
 #include <algorithm>
 
-void Panel::render() {
+void Panel::hashState(widget::RenderState& state) { bQuit.hashState(state); }
+
+void Panel::renderSurface(TCODConsole& panel) {
   constexpr std::array DECORATOR = {0x250c, 0x2500, 0x2510, 0x2502, 0x20, 0x2502, 0x2514, 0x2500, 0x2518};
   const auto bg = tcod::ColorRGB{63, 63, 63};
   auto fg = tcod::ColorRGB{203, 203, 203};
@@ -44,9 +46,10 @@ void Panel::render() {
   panel.setDefaultForeground(fg);
   panel.setDefaultForeground(bg);
   bQuit.render(&panel);
-  tcod::blit(*TCODConsole::root, panel, {posx, posy}, {0, 0, rect.w, rect.h}, 1.0f, 0.5f);
 }
 
+void Panel::render() { renderCached(1.0f, 0.5f); }
+
 bool Panel::update() {
   const uint64_t time = SDL_GetTicks64();
   if (rect.mouseHover) {
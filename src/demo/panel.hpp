@@ -45,13 +45,12 @@ class Panel : public widget::Widget {
   }
   bool update() override;
   void render() override;
-  void onEvent(const SDL_Event& ev) override {
-    widget::Widget::onEvent(ev);
-    bQuit.onEvent(ev);
-    return;
-  }
+  void hashState(widget::RenderState& state) override;
   void onQuit(widget::Widget*, events::Event) { salient_engine.deactivateAll(true); }
 
+ protected:
+  void renderSurface(TCODConsole& panel) override;
+
  private:
   int width{24};
   int height{48};
@@ -59,7 +58,6 @@ class Panel : public widget::Widget {
   int posy{(getEngine()->getRootHeight() - height) / 2};
   uint32_t delay{3000};
   uint64_t lastHover{0};  // the time the mouse last hovered over the panel
-  TCODConsole panel{width, height};
   widget::Button bQuit{this, 2, 2, 20, 3, "Quit"};
 };
 
@@ -36,7 +36,9 @@
 RabbitWidget::RabbitWidget() {
   rect.set(salient_engine.getRootWidth() / 2 - 12, salient_engine.getRootHeight() / 2 - 6, 24, 12);
   setDragZone(0, 0, 24, 1);
-  button.set(this, 10, 7, 4, 3, "OK");
+  // the button sits at the bottom of the window, centred
+  setLayout(widget::Layout{widget::LAYOUT_COLUMN, 1, 0, widget::ALIGN_CENTER, widget::ALIGN_END});
+  button.set(this, 0, 0, 0, 0, "OK");
 }
 
 void RabbitWidget::onInitialise() {
@@ -49,12 +51,11 @@ void RabbitWidget::onNextDemo(widget::Widget*, events::Event) {
   salient_engine.getModule("matrix")->setActive(false);
 }
 
-void RabbitWidget::render() {
+void RabbitWidget::renderSurface(TCODConsole& rabbit) {
   rabbit.setDefaultForeground(TCODColor::white);
   rabbit.setDefaultBackground(TCODColor::black);
   rabbit.printFrame(0, 0, 24, 12, true, TCOD_BKGND_SET, "Wake up, Neo");
-  rabbit.printRectEx(
-      12, 2, 24, 6, TCOD_BKGND_NONE, TCOD_CENTER, "The Matrix has you. Press OK to follow the white rabbit.");
+  message.draw(rabbit, 12, 2, 24, 6, TCOD_CENTER);
   if (dragZone.mouseHover || isDragging) {
     rabbit.setDefaultBackground(TCODColor::lightRed);
     rabbit.rect(5, 0, 14, 1, false, TCOD_BKGND_SET);
@@ -64,5 +65,6 @@ void RabbitWidget::render() {
   else
     rabbit.setDefaultForeground(TCODColor::white);
   button.render(&rabbit);
-  TCODConsole::blit(&rabbit, 0, 0, rect.w, rect.h, TCODConsole::root, rect.x, rect.y, 1.0f, 0.5f);
 }
+
+void RabbitWidget::render() { renderCached(1.0f, 0.5f); }
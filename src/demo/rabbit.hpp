@@ -40,20 +40,17 @@ class RabbitButton : public widget::StyleSheetSet {};
 class RabbitWidget : public widget::Widget {
  public:
   RabbitWidget();
-  void onEvent(const SDL_Event& ev) override {
-    widget::Widget::onEvent(ev);
-    button.onEvent(ev);
-  }
   void render() override;
   // slots
   void onNextDemo(widget::Widget* w, events::Event ev);
 
  protected:
   void onInitialise() override;
+  void renderSurface(TCODConsole& rabbit) override;
 
  private:
   widget::Button button{};
-  TCODConsole rabbit{24, 12};
+  render::TextLayout message{"The Matrix has you. Press OK to follow the white rabbit."};
 };
 
 #endif
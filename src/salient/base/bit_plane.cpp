@@ -0,0 +1,225 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "base/bit_plane.hpp"
+
+#include <cassert>
+
+namespace base {
+namespace {
+constexpr uint64_t ALL_BITS = ~uint64_t{0};
+
+int popcount(uint64_t word) noexcept {
+#if defined(__GNUC__)
+  return __builtin_popcountll(word);
+#else
+  word = word - ((word >> 1) & 0x5555555555555555);
+  word = (word & 0x3333333333333333) + ((word >> 2) & 0x3333333333333333);
+  word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0f;
+  return static_cast<int>((word * 0x0101010101010101) >> 56);
+#endif
+}
+
+// the index of the lowest set bit of a non-zero word
+int lowestBit(uint64_t word) noexcept {
+#if defined(__GNUC__)
+  return __builtin_ctzll(word);
+#else
+  return popcount((word & (~word + 1)) - 1);
+#endif
+}
+
+// the bits of word j of a row covering the columns [left, right)
+uint64_t spanMask(int j, int left, int right) noexcept {
+  const int low = std::max(left - j * BitPlane::WORD_BITS, 0);
+  const int high = std::min(right - j * BitPlane::WORD_BITS, BitPlane::WORD_BITS);
+  if (low >= high) return 0;
+  return (high == BitPlane::WORD_BITS ? ALL_BITS : (uint64_t{1} << high) - 1) & (ALL_BITS << low);
+}
+}  // namespace
+
+BitPlane::BitPlane(int width, int height, bool value)
+    : width{std::max(width, 0)},
+      height{std::max(height, 0)},
+      wordsPerRow{(this->width + WORD_BITS - 1) / WORD_BITS},
+      words(static_cast<size_t>(wordsPerRow) * this->height, value ? ALL_BITS : 0) {
+  clearPadding();
+}
+
+void BitPlane::clearPadding() noexcept {
+  if (width % WORD_BITS == 0) return;
+  const uint64_t mask = (uint64_t{1} << (width % WORD_BITS)) - 1;
+  for (int y = 0; y < height; ++y) getRow(y)[wordsPerRow - 1] &= mask;
+}
+
+void BitPlane::fill(bool value) {
+  std::fill(words.begin(), words.end(), value ? ALL_BITS : 0);
+  clearPadding();
+}
+
+void BitPlane::fill(const Rect& area, bool value) {
+  const int left = std::max(area.x, 0);
+  const int right = std::min(area.x + area.w, width);
+  if (left >= right) return;
+  for (int y = std::max(area.y, 0); y < std::min(area.y + area.h, height); ++y) {
+    uint64_t* row = getRow(y);
+    for (int j = left / WORD_BITS; j <= (right - 1) / WORD_BITS; ++j) {
+      const uint64_t mask = spanMask(j, left, right);
+      row[j] = value ? row[j] | mask : row[j] & ~mask;
+    }
+  }
+}
+
+BitPlane& BitPlane::operator&=(const BitPlane& other) noexcept {
+  assert(width == other.width && height == other.height);
+  for (size_t i = 0; i < words.size(); ++i) words[i] &= other.words[i];
+  return *this;
+}
+
+BitPlane& BitPlane::operator|=(const BitPlane& other) noexcept {
+  assert(width == other.width && height == other.height);
+  for (size_t i = 0; i < words.size(); ++i) words[i] |= other.words[i];
+  return *this;
+}
+
+BitPlane& BitPlane::operator^=(const BitPlane& other) noexcept {
+  assert(width == other.width && height == other.height);
+  for (size_t i = 0; i < words.size(); ++i) words[i] ^= other.words[i];
+  return *this;
+}
+
+BitPlane& BitPlane::subtract(const BitPlane& other) noexcept {
+  assert(width == other.width && height == other.height);
+  for (size_t i = 0; i < words.size(); ++i) words[i] &= ~other.words[i];
+  return *this;
+}
+
+BitPlane& BitPlane::invert() noexcept {
+  for (uint64_t& word : words) word = ~word;
+  clearPadding();
+  return *this;
+}
+
+void BitPlane::spreadRows(std::vector<uint64_t>& rows, bool grow) const noexcept {
+  for (int y = 0; y < height; ++y) {
+    uint64_t* row = rows.data() + static_cast<size_t>(y) * wordsPerRow;
+    uint64_t previous = 0;  // the original value of the word on the left
+    for (int j = 0; j < wordsPerRow; ++j) {
+      const uint64_t word = row[j];
+      const uint64_t next = j + 1 < wordsPerRow ? row[j + 1] : 0;
+      const uint64_t left = (word << 1) | (previous >> (WORD_BITS - 1));  // each cell's left neighbour
+      const uint64_t right = (word >> 1) | (next << (WORD_BITS - 1));  // each cell's right neighbour
+      row[j] = grow ? word | left | right : word & left & right;
+      previous = word;
+    }
+  }
+}
+
+BitPlane& BitPlane::dilate(int radius) {
+  std::vector<uint64_t> spread{};
+  for (int i = 0; i < radius; ++i) {
+    spread = words;
+    spreadRows(spread, true);
+    for (int y = 0; y < height; ++y) {
+      const uint64_t* current = spread.data() + static_cast<size_t>(y) * wordsPerRow;
+      uint64_t* row = getRow(y);
+      for (int j = 0; j < wordsPerRow; ++j) {
+        uint64_t word = current[j];
+        if (y > 0) word |= current[j - wordsPerRow];
+        if (y + 1 < height) word |= current[j + wordsPerRow];
+        row[j] = word;
+      }
+    }
+    clearPadding();
+  }
+  return *this;
+}
+
+BitPlane& BitPlane::erode(int radius) {
+  std::vector<uint64_t> spread{};
+  for (int i = 0; i < radius; ++i) {
+    spread = words;
+    spreadRows(spread, false);
+    for (int y = 0; y < height; ++y) {
+      const uint64_t* current = spread.data() + static_cast<size_t>(y) * wordsPerRow;
+      uint64_t* row = getRow(y);
+      for (int j = 0; j < wordsPerRow; ++j) {
+        const uint64_t above = y > 0 ? current[j - wordsPerRow] : 0;
+        const uint64_t below = y + 1 < height ? current[j + wordsPerRow] : 0;
+        row[j] = current[j] & above & below;
+      }
+    }
+  }
+  return *this;
+}
+
+size_t BitPlane::count() const noexcept {
+  size_t result = 0;
+  for (uint64_t word : words) result += popcount(word);
+  return result;
+}
+
+size_t BitPlane::count(const Rect& area) const noexcept {
+  const int left = std::max(area.x, 0);
+  const int right = std::min(area.x + area.w, width);
+  if (left >= right) return 0;
+  size_t result = 0;
+  for (int y = std::max(area.y, 0); y < std::min(area.y + area.h, height); ++y) {
+    const uint64_t* row = getRow(y);
+    for (int j = left / WORD_BITS; j <= (right - 1) / WORD_BITS; ++j) {
+      result += popcount(row[j] & spanMask(j, left, right));
+    }
+  }
+  return result;
+}
+
+bool BitPlane::any() const noexcept {
+  for (uint64_t word : words) {
+    if (word) return true;
+  }
+  return false;
+}
+
+int BitPlane::find(int x, int y, bool value) const noexcept {
+  if (y < 0 || y >= height || x >= width) return width;
+  x = std::max(x, 0);
+  const uint64_t* row = getRow(y);
+  const uint64_t flip = value ? 0 : ALL_BITS;
+  int j = x / WORD_BITS;
+  uint64_t word = (row[j] ^ flip) & (ALL_BITS << (x % WORD_BITS));
+  while (true) {
+    // the padding bits read as set when looking for cleared cells, hence the clamp
+    if (word) return std::min(j * WORD_BITS + lowestBit(word), width);
+    if (++j == wordsPerRow) return width;
+    word = row[j] ^ flip;
+  }
+}
+}  // namespace base
@@ -0,0 +1,215 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "base/rect.hpp"
+#include "base/tile_map.hpp"
+
+namespace base {
+/**
+ * A 2D grid of bits, one per cell, holding one property of a map such as "transparent" or "explored". Rows are stored
+ * in 64-bit words, so bulk operations and queries handle 64 cells at a time in loops the compiler can vectorise. The
+ * bits past the end of a row are always zero. Cells outside of the plane count as unset.
+ */
+class BitPlane {
+ public:
+  static constexpr int WORD_BITS = 64;
+  BitPlane() = default;
+  /**
+   * Creates a plane.
+   * @param width the plane's width in cells
+   * @param height the plane's height in cells
+   * @param value the value of every cell
+   */
+  BitPlane(int width, int height, bool value = false);
+  /**
+   * Builds a plane from a property of the tiles of a map.
+   * @param map the map
+   * @param property the predicate telling whether a tile has the property
+   * @return the plane, of the map's size
+   */
+  template <class T, class P>
+  static BitPlane fromTiles(const TileMap<T>& map, P&& property) {
+    BitPlane plane{map.getWidth(), map.getHeight(), static_cast<bool>(property(map.getFill()))};
+    map.forEach(Rect{0, 0, map.getWidth(), map.getHeight()},
+                [&](int x, int y, const T& tile) { plane.set(x, y, static_cast<bool>(property(tile))); });
+    return plane;
+  }
+  bool contains(int x, int y) const noexcept { return x >= 0 && y >= 0 && x < width && y < height; }
+  /**
+   * Reads a cell.
+   * @param x the cell's <i>x</i> coordinate
+   * @param y the cell's <i>y</i> coordinate
+   * @return <code>true</code> if the cell is set, <code>false</code> if it isn't or is outside of the plane
+   */
+  bool get(int x, int y) const noexcept {
+    return contains(x, y) && (words[wordIndex(x, y)] >> (x & (WORD_BITS - 1)) & 1);
+  }
+  /**
+   * Sets or clears a cell. Cells outside of the plane are ignored.
+   * @param x the cell's <i>x</i> coordinate
+   * @param y the cell's <i>y</i> coordinate
+   * @param value the cell's new value
+   */
+  void set(int x, int y, bool value = true) noexcept {
+    if (!contains(x, y)) return;
+    const uint64_t bit = uint64_t{1} << (x & (WORD_BITS - 1));
+    uint64_t& word = words[wordIndex(x, y)];
+    word = value ? word | bit : word & ~bit;
+  }
+  void reset(int x, int y) noexcept { set(x, y, false); }
+  /**
+   * Sets or clears every cell.
+   * @param value the cells' new value
+   */
+  void fill(bool value);
+  /**
+   * Sets or clears every cell of an area.
+   * @param area the area, clipped to the plane
+   * @param value the cells' new value
+   */
+  void fill(const Rect& area, bool value);
+  /**
+   * Combines the plane with another of the same size, cell by cell.
+   * @param other the other plane
+   * @return the plane
+   */
+  BitPlane& operator&=(const BitPlane& other) noexcept;
+  BitPlane& operator|=(const BitPlane& other) noexcept;
+  BitPlane& operator^=(const BitPlane& other) noexcept;
+  /**
+   * Clears the cells set in another plane of the same size.
+   * @param other the other plane
+   * @return the plane
+   */
+  BitPlane& subtract(const BitPlane& other) noexcept;
+  /**
+   * Flips every cell.
+   * @return the plane
+   */
+  BitPlane& invert() noexcept;
+  /**
+   * Sets the cells having a set cell among their 8 neighbours, repeatedly.
+   * @param radius the number of times to grow the set cells
+   * @return the plane
+   */
+  BitPlane& dilate(int radius = 1);
+  /**
+   * Clears the cells having a cleared cell among their 8 neighbours, repeatedly. The cells on the border of the plane
+   * are cleared too, as the cells outside of it count as cleared.
+   * @param radius the number of times to shrink the set cells
+   * @return the plane
+   */
+  BitPlane& erode(int radius = 1);
+  /**
+   * Counts the set cells.
+   * @return the number of set cells
+   */
+  size_t count() const noexcept;
+  /**
+   * Counts the set cells of an area.
+   * @param area the area, clipped to the plane
+   * @return the number of set cells
+   */
+  size_t count(const Rect& area) const noexcept;
+  /**
+   * Checks whether any cell is set.
+   * @return <code>true</code> if a cell is set, <code>false</code> otherwise
+   */
+  bool any() const noexcept;
+  /**
+   * Finds the first cell of a row, at or after a column, with a value.
+   * @param x the first column to look at
+   * @param y the row
+   * @param value the value to look for
+   * @return the cell's column, or the plane's width if there's none
+   */
+  int find(int x, int y, bool value = true) const noexcept;
+  /**
+   * Calls a function on every run of consecutive set cells of an area, row by row, as
+   * <code>f(y, begin, end)</code>, the run covering the columns <code>[begin, end)</code>.
+   * @param area the area, clipped to the plane
+   * @param f the function
+   */
+  template <class F>
+  void forEachSpan(const Rect& area, F&& f) const {
+    const int left = std::max(area.x, 0);
+    const int right = std::min(area.x + area.w, width);
+    for (int y = std::max(area.y, 0); y < std::min(area.y + area.h, height); ++y) {
+      for (int begin = find(left, y, true); begin < right;) {
+        const int end = std::min(find(begin, y, false), right);
+        f(y, begin, end);
+        begin = find(end, y, true);
+      }
+    }
+  }
+  /**
+   * Gets the words of a row. Bit <code>i</code> of word <code>j</code> holds the cell of column
+   * <code>j * 64 + i</code>.
+   * @param y the row
+   * @return the row's first word
+   */
+  const uint64_t* getRow(int y) const noexcept { return words.data() + static_cast<size_t>(y) * wordsPerRow; }
+  uint64_t* getRow(int y) noexcept { return words.data() + static_cast<size_t>(y) * wordsPerRow; }
+  int getWordsPerRow() const noexcept { return wordsPerRow; }
+  int getWidth() const noexcept { return width; }
+  int getHeight() const noexcept { return height; }
+  friend bool operator==(const BitPlane& a, const BitPlane& b) noexcept {
+    return a.width == b.width && a.height == b.height && a.words == b.words;
+  }
+  friend bool operator!=(const BitPlane& a, const BitPlane& b) noexcept { return !(a == b); }
+
+ private:
+  size_t wordIndex(int x, int y) const noexcept {
+    return static_cast<size_t>(y) * wordsPerRow + static_cast<size_t>(x / WORD_BITS);
+  }
+  /**
+   * Clears the bits past the end of every row.
+   */
+  void clearPadding() noexcept;
+  /**
+   * Combines each row with its left and right neighbours, with OR when growing or AND when shrinking.
+   * @param rows the rows to combine
+   * @param grow whether to grow or to shrink
+   */
+  void spreadRows(std::vector<uint64_t>& rows, bool grow) const noexcept;
+  int width{};
+  int height{};
+  int wordsPerRow{};
+  std::vector<uint64_t> words{};
+};
+}  // namespace base
@@ -0,0 +1,89 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace base {
+/**
+ * A vector stored in fixed size chunks. Growing it never moves the elements already stored, so it doesn't pay for the
+ * copies and the peak memory of a reallocation, and neighbouring elements stay in the same chunk for cache friendly
+ * iteration. Used for widgets holding tens of thousands of rows.
+ * @tparam T the element type
+ * @tparam CHUNK_SHIFT the base 2 logarithm of the number of elements per chunk
+ */
+template <class T, size_t CHUNK_SHIFT = 8>
+class ChunkedVector {
+ public:
+  static constexpr size_t CHUNK_SIZE = size_t{1} << CHUNK_SHIFT;
+
+  size_t size() const noexcept { return count; }
+  bool empty() const noexcept { return count == 0; }
+  T& operator[](size_t index) noexcept { return chunks[index >> CHUNK_SHIFT][index & (CHUNK_SIZE - 1)]; }
+  const T& operator[](size_t index) const noexcept { return chunks[index >> CHUNK_SHIFT][index & (CHUNK_SIZE - 1)]; }
+  T& back() noexcept { return (*this)[count - 1]; }
+  /**
+   * Appends an element, starting a new chunk if the last one is full.
+   * @param value the element
+   * @return reference to the stored element
+   */
+  T& push_back(T value) {
+    if ((count & (CHUNK_SIZE - 1)) == 0 && (count >> CHUNK_SHIFT) == chunks.size()) {
+      chunks.push_back(std::make_unique<T[]>(CHUNK_SIZE));
+    }
+    T& slot = (*this)[count++];
+    slot = std::move(value);
+    return slot;
+  }
+  /**
+   * Removes the last element. The chunk is kept for the next insertion.
+   */
+  void pop_back() {
+    back() = T{};
+    --count;
+  }
+  /**
+   * Removes all the elements and frees the chunks.
+   */
+  void clear() {
+    chunks.clear();
+    count = 0;
+  }
+
+ private:
+  std::vector<std::unique_ptr<T[]>> chunks{};
+  size_t count{0};
+};
+}  // namespace base
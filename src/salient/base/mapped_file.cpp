@@ -0,0 +1,175 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "base/mapped_file.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace base {
+#ifdef _WIN32
+MappedFile::MappedFile(const std::filesystem::path& path) {
+  HANDLE file = CreateFileW(
+      path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) return;
+  LARGE_INTEGER fileSize{};
+  if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+    mapping_ = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_) {
+      data_ = static_cast<const unsigned char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+      if (data_)
+        size_ = static_cast<size_t>(fileSize.QuadPart);
+      else
+        close();
+    }
+  }
+  CloseHandle(file);
+}
+
+MappedFile::MappedFile(const std::filesystem::path& path, size_t size) {
+  if (size == 0) return;
+  HANDLE file = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS,
+                            FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) return;
+  LARGE_INTEGER fileSize{};
+  fileSize.QuadPart = static_cast<LONGLONG>(size);
+  if (SetFilePointerEx(file, fileSize, nullptr, FILE_BEGIN) && SetEndOfFile(file)) {
+    mapping_ = CreateFileMappingW(file, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+    if (mapping_) {
+      data_ = static_cast<const unsigned char*>(MapViewOfFile(mapping_, FILE_MAP_WRITE, 0, 0, 0));
+      if (data_) {
+        size_ = size;
+        writable_ = true;
+      } else {
+        close();
+      }
+    }
+  }
+  CloseHandle(file);
+}
+
+void MappedFile::prefetch(size_t offset, size_t length) const noexcept {
+  if (!data_ || offset >= size_) return;
+  WIN32_MEMORY_RANGE_ENTRY range{const_cast<unsigned char*>(data_) + offset, std::min(length, size_ - offset)};
+  PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+void MappedFile::sync() const noexcept {
+  if (writable_) FlushViewOfFile(data_, 0);
+}
+
+void MappedFile::close() noexcept {
+  if (data_) UnmapViewOfFile(data_);
+  if (mapping_) CloseHandle(mapping_);
+  data_ = nullptr;
+  mapping_ = nullptr;
+  size_ = 0;
+  writable_ = false;
+}
+#else
+MappedFile::MappedFile(const std::filesystem::path& path) {
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return;
+  struct stat status {};
+  if (fstat(fd, &status) == 0 && status.st_size > 0) {
+    void* mapped = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped != MAP_FAILED) {
+      data_ = static_cast<const unsigned char*>(mapped);
+      size_ = static_cast<size_t>(status.st_size);
+    }
+  }
+  ::close(fd);  // the mapping keeps the file alive
+}
+
+MappedFile::MappedFile(const std::filesystem::path& path, size_t size) {
+  if (size == 0) return;
+  const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (fd < 0) return;
+  if (ftruncate(fd, static_cast<off_t>(size)) == 0) {
+    void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped != MAP_FAILED) {
+      data_ = static_cast<const unsigned char*>(mapped);
+      size_ = size;
+      writable_ = true;
+    }
+  }
+  ::close(fd);  // the mapping keeps the file alive
+}
+
+void MappedFile::prefetch(size_t offset, size_t length) const noexcept {
+  if (!data_ || offset >= size_) return;
+  // madvise wants a page aligned start
+  const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  const size_t start = offset / page * page;
+  const size_t end = std::min(size_, offset + length);
+  madvise(const_cast<unsigned char*>(data_) + start, end - start, MADV_WILLNEED);
+}
+
+void MappedFile::sync() const noexcept {
+  if (writable_) msync(const_cast<unsigned char*>(data_), size_, MS_SYNC);
+}
+
+void MappedFile::close() noexcept {
+  if (data_) munmap(const_cast<unsigned char*>(data_), size_);
+  data_ = nullptr;
+  size_ = 0;
+  writable_ = false;
+}
+#endif
+
+MappedFile::~MappedFile() { close(); }
+
+MappedFile::MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  if (this != &other) {
+    close();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    writable_ = std::exchange(other.writable_, false);
+#ifdef _WIN32
+    mapping_ = std::exchange(other.mapping_, nullptr);
+#endif
+  }
+  return *this;
+}
+}  // namespace base
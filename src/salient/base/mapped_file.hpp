@@ -0,0 +1,101 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+namespace base {
+/**
+ * A memory mapping of a whole file, read-only or writable. The mapping is released when the object is destroyed.
+ */
+class MappedFile {
+ public:
+  MappedFile() = default;
+  /**
+   * Maps a file in memory.
+   * @param path the file to be mapped
+   */
+  explicit MappedFile(const std::filesystem::path& path);
+  /**
+   * Maps a file in memory for reading and writing, creating it if needed. The file is resized to the given size: the
+   * bytes added are zero and, on file systems supporting it, don't take up disk space until they are written.
+   * @param path the file to be mapped
+   * @param size the size of the file in bytes
+   */
+  MappedFile(const std::filesystem::path& path, size_t size);
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+  /**
+   * Checks whether the file has been successfully mapped.
+   * @return <code>true</code> if the file is mapped, <code>false</code> otherwise
+   */
+  bool isOpen() const noexcept { return data_ != nullptr; }
+  /**
+   * Gets the file's contents.
+   * @return a pointer to the first byte of the file, or <code>nullptr</code> if it isn't mapped
+   */
+  const unsigned char* data() const noexcept { return data_; }
+  /**
+   * Gets the file's contents for writing.
+   * @return a pointer to the first byte of the file, or <code>nullptr</code> if it isn't mapped for writing
+   */
+  unsigned char* writableData() noexcept { return writable_ ? const_cast<unsigned char*>(data_) : nullptr; }
+  /**
+   * Gets the file's size.
+   * @return the size of the file in bytes
+   */
+  size_t size() const noexcept { return size_; }
+  /**
+   * Asks the system to start reading a part of the file in memory, so that accessing it later doesn't block.
+   * @param offset the offset of the first byte
+   * @param length the number of bytes
+   */
+  void prefetch(size_t offset, size_t length) const noexcept;
+  /**
+   * Writes the modified parts of a writable mapping back to the file.
+   */
+  void sync() const noexcept;
+
+ private:
+  void close() noexcept;
+  const unsigned char* data_{};
+  size_t size_{};
+  bool writable_{};
+#ifdef _WIN32
+  void* mapping_{};
+#endif
+};
+}  // namespace base
@@ -0,0 +1,112 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace base {
+/**
+ * A fixed capacity queue that drops its oldest element when a new one is pushed while it's full. The storage is
+ * allocated as the buffer fills up and never moves afterwards, so appending costs no more than storing the element.
+ * @tparam T the element type
+ */
+template <class T>
+class RingBuffer {
+ public:
+  explicit RingBuffer(size_t capacity = 1024) : capacity_{capacity > 0 ? capacity : 1} {}
+  size_t size() const noexcept { return count; }
+  bool empty() const noexcept { return count == 0; }
+  size_t capacity() const noexcept { return capacity_; }
+  /**
+   * Gets the storage slot of an element. Slots are stable as long as the element is in the buffer, so they can index
+   * data kept alongside it.
+   * @param index the element's index, 0 being the oldest
+   * @return the slot, lower than the capacity
+   */
+  size_t slot(size_t index) const noexcept {
+    const size_t position = head + index;
+    return position < capacity_ ? position : position - capacity_;
+  }
+  T& operator[](size_t index) noexcept { return storage[slot(index)]; }
+  const T& operator[](size_t index) const noexcept { return storage[slot(index)]; }
+  /**
+   * Appends an element, replacing the oldest one if the buffer is full.
+   * @param value the element
+   * @return the slot the element has been stored in
+   */
+  size_t push_back(T value) {
+    if (count < capacity_) {
+      const size_t position = slot(count++);
+      if (position == storage.size())
+        storage.push_back(std::move(value));
+      else
+        storage[position] = std::move(value);
+      return position;
+    }
+    const size_t position = head;
+    storage[position] = std::move(value);
+    head = slot(1);
+    return position;
+  }
+  /**
+   * Changes the capacity. The oldest elements are dropped if there are more than the new capacity.
+   * @param capacity the new capacity, at least 1
+   */
+  void setCapacity(size_t capacity) {
+    capacity = capacity > 0 ? capacity : 1;
+    std::vector<T> elements;
+    const size_t kept = count < capacity ? count : capacity;
+    elements.reserve(kept);
+    for (size_t i = count - kept; i < count; ++i) elements.push_back(std::move((*this)[i]));
+    storage = std::move(elements);
+    capacity_ = capacity;
+    head = 0;
+    count = kept;
+  }
+  /**
+   * Removes all the elements and frees the storage.
+   */
+  void clear() {
+    storage.clear();
+    storage.shrink_to_fit();
+    head = count = 0;
+  }
+
+ private:
+  std::vector<T> storage{};
+  size_t capacity_;
+  size_t head{0};  // slot of the oldest element
+  size_t count{0};
+};
+}  // namespace base
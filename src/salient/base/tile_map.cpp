@@ -0,0 +1,226 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "base/tile_map.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <system_error>
+#include <utility>
+
+#include "logger/log.hpp"
+
+namespace base {
+namespace {
+constexpr char MAP_MAGIC[8] = {'S', 'L', 'N', 'T', 'M', 'A', 'P', '0'};
+// bump whenever the layout of the file changes
+constexpr uint32_t MAP_VERSION = 1;
+constexpr size_t PAGE_BYTES = 4096;
+
+// the file is a header, followed by one presence byte per chunk, then a slot for every chunk in row major order. The
+// slots of chunks never written are left as holes, which sparse file systems don't store. Everything is stored in
+// native byte order
+struct MapHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t tileSize;
+  int32_t width;
+  int32_t height;
+  int32_t chunkSize;
+};
+
+size_t alignUp(size_t value, size_t align) { return (value + align - 1) / align * align; }
+}  // namespace
+
+TileStore::TileStore(int width, int height, size_t tileSize, const void* fill)
+    : width{std::max(width, 0)},
+      height{std::max(height, 0)},
+      chunksX{(this->width + CHUNK_SIZE - 1) >> CHUNK_SHIFT},
+      chunksY{(this->height + CHUNK_SIZE - 1) >> CHUNK_SHIFT},
+      regionsX{(chunksX + REGION_SIZE - 1) >> REGION_SHIFT},
+      chunkBytes{tileSize * CHUNK_TILES},
+      fill(tileSize) {
+  std::memcpy(this->fill.data(), fill, tileSize);
+  regions.resize(static_cast<size_t>(regionsX) * ((chunksY + REGION_SIZE - 1) >> REGION_SHIFT));
+}
+
+TileStore::~TileStore() {
+  for (Chunk* chunk : resident) writeBack(*chunk);
+}
+
+bool TileStore::open(const std::filesystem::path& path) {
+  const size_t chunkCount = static_cast<size_t>(chunksX) * chunksY;
+  const size_t offset = alignUp(sizeof(MapHeader) + chunkCount, PAGE_BYTES);
+  const size_t size = offset + chunkCount * chunkBytes;
+  MapHeader expected{};
+  std::memcpy(expected.magic, MAP_MAGIC, sizeof(MAP_MAGIC));
+  expected.version = MAP_VERSION;
+  expected.tileSize = static_cast<uint32_t>(fill.size());
+  expected.width = width;
+  expected.height = height;
+  expected.chunkSize = CHUNK_SIZE;
+  std::error_code error;
+  const bool exists = std::filesystem::exists(path, error);
+  // never resize an existing file: it would be truncated
+  if (exists && std::filesystem::file_size(path, error) != size) {
+    logger::Log::error("TileStore::open | The world file \"%s\" doesn't match the map's size.", path.string());
+    return false;
+  }
+  MappedFile mapped{path, size};
+  if (!mapped.isOpen()) {
+    logger::Log::error("TileStore::open | Could not map the world file \"%s\".", path.string());
+    return false;
+  }
+  if (!exists) {
+    std::memcpy(mapped.writableData(), &expected, sizeof(expected));
+  } else if (std::memcmp(mapped.data(), &expected, sizeof(expected)) != 0) {
+    logger::Log::error("TileStore::open | The world file \"%s\" doesn't match the map's layout.", path.string());
+    return false;
+  }
+  file = std::move(mapped);
+  presence = file.writableData() + sizeof(MapHeader);
+  dataOffset = offset;
+  // the chunks written so far only exist in memory
+  for (Chunk* chunk : resident) chunk->dirty = true;
+  logger::Log::info("TileStore::open | Opened the world file \"%s\".", path.string());
+  return true;
+}
+
+std::unique_ptr<TileStore::Chunk>& TileStore::slotOf(int chunkX, int chunkY) {
+  std::unique_ptr<Region>& region = regions[static_cast<size_t>(chunkY >> REGION_SHIFT) * regionsX +
+                                            (chunkX >> REGION_SHIFT)];
+  if (!region) region = std::make_unique<Region>();
+  return region->chunks[((chunkY & (REGION_SIZE - 1)) << REGION_SHIFT) | (chunkX & (REGION_SIZE - 1))];
+}
+
+TileStore::Chunk* TileStore::findResident(int chunkX, int chunkY) const noexcept {
+  const Region* region =
+      regions[static_cast<size_t>(chunkY >> REGION_SHIFT) * regionsX + (chunkX >> REGION_SHIFT)].get();
+  if (!region) return nullptr;
+  return region->chunks[((chunkY & (REGION_SIZE - 1)) << REGION_SHIFT) | (chunkX & (REGION_SIZE - 1))].get();
+}
+
+const std::byte* TileStore::find(int chunkX, int chunkY) const noexcept {
+  if (const Chunk* chunk = findResident(chunkX, chunkY)) return chunk->tiles.get();
+  const size_t index = static_cast<size_t>(chunkY) * chunksX + chunkX;
+  return isStored(index) ? storedTiles(index) : nullptr;
+}
+
+std::byte* TileStore::page(int chunkX, int chunkY) {
+  Chunk& chunk = load(chunkX, chunkY);
+  chunk.dirty = true;
+  return chunk.tiles.get();
+}
+
+TileStore::Chunk& TileStore::load(int chunkX, int chunkY) {
+  std::unique_ptr<Chunk>& slot = slotOf(chunkX, chunkY);
+  if (!slot) {
+    slot = std::make_unique<Chunk>();
+    slot->index = static_cast<size_t>(chunkY) * chunksX + chunkX;
+    slot->tiles = std::make_unique<std::byte[]>(chunkBytes);
+    if (isStored(slot->index)) {
+      std::memcpy(slot->tiles.get(), storedTiles(slot->index), chunkBytes);
+    } else {
+      for (size_t i = 0; i < chunkBytes; i += fill.size()) std::memcpy(&slot->tiles[i], fill.data(), fill.size());
+    }
+    slot->residentIndex = resident.size();
+    resident.push_back(slot.get());
+    ++regions[static_cast<size_t>(chunkY >> REGION_SHIFT) * regionsX + (chunkX >> REGION_SHIFT)]->count;
+  }
+  slot->lastUse = tick;
+  return *slot;
+}
+
+void TileStore::writeBack(Chunk& chunk) noexcept {
+  if (!chunk.dirty || !file.isOpen()) return;
+  std::memcpy(file.writableData() + dataOffset + chunk.index * chunkBytes, chunk.tiles.get(), chunkBytes);
+  presence[chunk.index] = 1;
+  chunk.dirty = false;
+}
+
+void TileStore::evict(Chunk& chunk) {
+  writeBack(chunk);
+  resident.back()->residentIndex = chunk.residentIndex;
+  resident[chunk.residentIndex] = resident.back();
+  resident.pop_back();
+  const int chunkX = static_cast<int>(chunk.index % chunksX);
+  const int chunkY = static_cast<int>(chunk.index / chunksX);
+  std::unique_ptr<Region>& region = regions[static_cast<size_t>(chunkY >> REGION_SHIFT) * regionsX +
+                                            (chunkX >> REGION_SHIFT)];
+  region->chunks[((chunkY & (REGION_SIZE - 1)) << REGION_SHIFT) | (chunkX & (REGION_SIZE - 1))].reset();
+  if (--region->count == 0) region.reset();
+}
+
+void TileStore::setViewport(const Rect& view, int margin) {
+  ++tick;
+  // the chunks covering [from, to), clipped to the map
+  const auto chunkRange = [](int from, int to, int chunks) {
+    return std::pair{std::clamp(from >> CHUNK_SHIFT, 0, chunks),
+                     std::clamp((to + CHUNK_SIZE - 1) >> CHUNK_SHIFT, 0, chunks)};
+  };
+  const auto [viewLeft, viewRight] = chunkRange(view.x, view.x + view.w, chunksX);
+  const auto [viewTop, viewBottom] = chunkRange(view.y, view.y + view.h, chunksY);
+  const auto [left, right] = chunkRange(view.x - margin, view.x + view.w + margin, chunksX);
+  const auto [top, bottom] = chunkRange(view.y - margin, view.y + view.h + margin, chunksY);
+  for (int chunkY = top; chunkY < bottom; ++chunkY) {
+    for (int chunkX = left; chunkX < right; ++chunkX) {
+      const bool inView = chunkX >= viewLeft && chunkX < viewRight && chunkY >= viewTop && chunkY < viewBottom;
+      const size_t index = static_cast<size_t>(chunkY) * chunksX + chunkX;
+      if (Chunk* chunk = findResident(chunkX, chunkY)) {
+        chunk->lastUse = tick;
+      } else if (inView && isStored(index)) {
+        load(chunkX, chunkY);
+      } else if (isStored(index)) {
+        file.prefetch(dataOffset + index * chunkBytes, chunkBytes);
+      }
+    }
+  }
+  trim();
+}
+
+void TileStore::trim() {
+  if (!file.isOpen() || residentLimit == 0 || resident.size() <= residentLimit) return;
+  std::vector<Chunk*> candidates{};
+  for (Chunk* chunk : resident) {
+    if (chunk->lastUse < tick) candidates.push_back(chunk);
+  }
+  const size_t count = std::min(candidates.size(), resident.size() - residentLimit);
+  std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(),
+                    [](const Chunk* a, const Chunk* b) { return a->lastUse < b->lastUse; });
+  for (size_t i = 0; i < count; ++i) evict(*candidates[i]);
+}
+
+void TileStore::flush() {
+  if (!file.isOpen()) return;
+  for (Chunk* chunk : resident) writeBack(*chunk);
+  file.sync();
+}
+}  // namespace base
@@ -0,0 +1,322 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "base/mapped_file.hpp"
+#include "base/rect.hpp"
+
+namespace base {
+/**
+ * Spreads the low 16 bits of a value over the even bits of the result.
+ * @param value the value
+ * @return the spread bits
+ */
+constexpr uint32_t spreadBits(uint32_t value) noexcept {
+  value &= 0xffff;
+  value = (value | (value << 8)) & 0x00ff00ff;
+  value = (value | (value << 4)) & 0x0f0f0f0f;
+  value = (value | (value << 2)) & 0x33333333;
+  value = (value | (value << 1)) & 0x55555555;
+  return value;
+}
+
+/**
+ * Computes the position of a cell along the Z-order curve, interleaving the bits of its coordinates. Cells that are
+ * close in both directions get close indices, so row and column scans touch few cache lines.
+ * @param x the cell's <i>x</i> coordinate, below 65536
+ * @param y the cell's <i>y</i> coordinate, below 65536
+ * @return the cell's index
+ */
+constexpr uint32_t mortonEncode(uint32_t x, uint32_t y) noexcept { return spreadBits(x) | (spreadBits(y) << 1); }
+
+/**
+ * The untyped storage behind <code>TileMap</code>: a grid of tile chunks allocated on first write, optionally paged in
+ * and out of a world file. Chunks hold their tiles in Z-order. It isn't thread safe.
+ */
+class TileStore {
+ public:
+  static constexpr int CHUNK_SHIFT = 5;
+  static constexpr int CHUNK_SIZE = 1 << CHUNK_SHIFT;  // chunk width and height, in tiles
+  static constexpr int CHUNK_TILES = CHUNK_SIZE * CHUNK_SIZE;
+  /**
+   * Creates an empty store.
+   * @param width the map's width in tiles
+   * @param height the map's height in tiles
+   * @param tileSize the size of a tile in bytes
+   * @param fill the value of the tiles never written, <code>tileSize</code> bytes long
+   */
+  TileStore(int width, int height, size_t tileSize, const void* fill);
+  /**
+   * Writes the modified chunks back to the world file, if there is one, and releases the store.
+   */
+  ~TileStore();
+  TileStore(const TileStore&) = delete;
+  TileStore& operator=(const TileStore&) = delete;
+  /**
+   * Backs the store with a world file, creating it if needed. An existing file must have been created for a map of the
+   * same size and tile size. Once backed, the store can page out chunks to keep its memory use bounded, and the tiles
+   * are kept in the file when the store is destroyed.
+   * @param path the world file
+   * @return <code>true</code> if the file was opened, <code>false</code> otherwise
+   */
+  bool open(const std::filesystem::path& path);
+  bool isOpen() const noexcept { return file.isOpen(); }
+  /**
+   * Finds the tiles of a chunk, for reading. Chunks that aren't resident are read from the world file directly.
+   * @param chunkX the chunk's column
+   * @param chunkY the chunk's row
+   * @return the chunk's tiles, or <code>nullptr</code> if the chunk has never been written
+   */
+  const std::byte* find(int chunkX, int chunkY) const noexcept;
+  /**
+   * Gets the tiles of a chunk for writing, allocating or paging in the chunk if needed.
+   * @param chunkX the chunk's column
+   * @param chunkY the chunk's row
+   * @return the chunk's tiles
+   */
+  std::byte* page(int chunkX, int chunkY);
+  /**
+   * Moves the area of interest. The stored chunks under the view are paged in, those within the margin around it are
+   * read ahead by the system, and if the resident limit is exceeded the chunks that have been out of view the longest
+   * are written back and paged out.
+   * @param view the area of interest, in tiles
+   * @param margin the width of the read ahead margin around the view, in tiles
+   */
+  void setViewport(const Rect& view, int margin);
+  /**
+   * Sets the maximum number of resident chunks. Only file backed stores can page chunks out, and the chunks in view are
+   * always kept.
+   * @param chunks the limit, or 0 for none
+   */
+  void setResidentLimit(size_t chunks) noexcept { residentLimit = chunks; }
+  /**
+   * Writes the modified chunks back to the world file and the file to the disk.
+   */
+  void flush();
+  size_t getResidentCount() const noexcept { return resident.size(); }
+  int getWidth() const noexcept { return width; }
+  int getHeight() const noexcept { return height; }
+  const std::byte* getFill() const noexcept { return fill.data(); }
+
+ private:
+  static constexpr int REGION_SHIFT = 5;
+  static constexpr int REGION_SIZE = 1 << REGION_SHIFT;  // region width and height, in chunks
+  struct Chunk {
+    std::unique_ptr<std::byte[]> tiles{};
+    size_t index{};  // row major index of the chunk in the map
+    size_t residentIndex{};  // index in the resident chunks
+    uint64_t lastUse{};  // the viewport tick the chunk was last in view or written
+    bool dirty{};  // modified since it was paged in
+  };
+  // the chunk directory is split in regions allocated on demand, so huge sparse maps don't pay for a full directory
+  struct Region {
+    std::array<std::unique_ptr<Chunk>, REGION_SIZE * REGION_SIZE> chunks{};
+    size_t count{};
+  };
+  std::unique_ptr<Chunk>& slotOf(int chunkX, int chunkY);
+  Chunk* findResident(int chunkX, int chunkY) const noexcept;
+  /**
+   * Makes a chunk resident, reading it from the world file or filling it.
+   * @return the chunk
+   */
+  Chunk& load(int chunkX, int chunkY);
+  /**
+   * Writes a chunk back to the world file if it was modified and frees it.
+   */
+  void evict(Chunk& chunk);
+  /**
+   * Pages out the least recently used chunks until the resident limit is met.
+   */
+  void trim();
+  void writeBack(Chunk& chunk) noexcept;
+  bool isStored(size_t index) const noexcept { return presence && presence[index]; }
+  const std::byte* storedTiles(size_t index) const noexcept {
+    return reinterpret_cast<const std::byte*>(file.data()) + dataOffset + index * chunkBytes;
+  }
+  int width;
+  int height;
+  int chunksX;
+  int chunksY;
+  int regionsX;
+  size_t chunkBytes;
+  std::vector<std::byte> fill{};  // one tile
+  std::vector<std::unique_ptr<Region>> regions{};
+  std::vector<Chunk*> resident{};
+  size_t residentLimit{};
+  uint64_t tick{};
+  MappedFile file{};
+  unsigned char* presence{};  // one byte per chunk, set if the chunk is stored in the file
+  size_t dataOffset{};
+};
+
+/**
+ * A 2D map of tiles stored in 32x32 chunks. Chunks are only allocated once written to, and the tiles of a chunk are
+ * laid out along the Z-order curve, so that neighbours in both directions are close in memory. Backed by a world file
+ * with <code>open()</code>, the map pages its chunks in and out of it following the viewport, so maps far larger than
+ * the memory can be explored with a bounded working set. It isn't thread safe.
+ * @tparam T the tile type, trivially copyable
+ */
+template <class T>
+class TileMap {
+  static_assert(std::is_trivially_copyable_v<T>, "tiles are copied to and from the world file as bytes");
+  static_assert(alignof(T) <= alignof(std::max_align_t), "tiles must not be over-aligned");
+
+ public:
+  static constexpr int CHUNK_SIZE = TileStore::CHUNK_SIZE;
+  /**
+   * Creates a map whose tiles are all set to a value.
+   * @param width the map's width in tiles
+   * @param height the map's height in tiles
+   * @param fill the value of the tiles never written
+   */
+  TileMap(int width, int height, const T& fill = T{}) : store{width, height, sizeof(T), &fill} {}
+  /**
+   * Backs the map with a world file. See <code>TileStore::open()</code>.
+   * @param path the world file
+   * @return <code>true</code> if the file was opened, <code>false</code> otherwise
+   */
+  bool open(const std::filesystem::path& path) { return store.open(path); }
+  /**
+   * Checks whether a position is on the map.
+   * @param x the tile's <i>x</i> coordinate
+   * @param y the tile's <i>y</i> coordinate
+   * @return <code>true</code> if the tile exists, <code>false</code> otherwise
+   */
+  bool contains(int x, int y) const noexcept {
+    return x >= 0 && y >= 0 && x < store.getWidth() && y < store.getHeight();
+  }
+  /**
+   * Reads a tile. Reading never allocates nor pages chunks in.
+   * @param x the tile's <i>x</i> coordinate, on the map
+   * @param y the tile's <i>y</i> coordinate, on the map
+   * @return the tile
+   */
+  const T& get(int x, int y) const noexcept {
+    const std::byte* tiles = store.find(x >> TileStore::CHUNK_SHIFT, y >> TileStore::CHUNK_SHIFT);
+    if (!tiles) return getFill();
+    return reinterpret_cast<const T*>(tiles)[indexOf(x, y)];
+  }
+  /**
+   * Gets a tile for writing, allocating its chunk if needed. The reference is invalidated when the chunk is paged out.
+   * @param x the tile's <i>x</i> coordinate, on the map
+   * @param y the tile's <i>y</i> coordinate, on the map
+   * @return the tile
+   */
+  T& at(int x, int y) {
+    std::byte* tiles = store.page(x >> TileStore::CHUNK_SHIFT, y >> TileStore::CHUNK_SHIFT);
+    return reinterpret_cast<T*>(tiles)[indexOf(x, y)];
+  }
+  void set(int x, int y, const T& tile) { at(x, y) = tile; }
+  /**
+   * Gets the value of the tiles never written.
+   * @return the tile
+   */
+  const T& getFill() const noexcept { return *reinterpret_cast<const T*>(store.getFill()); }
+  /**
+   * Calls a function on every tile of an area, as <code>f(x, y, tile)</code>, chunk by chunk. The chunks that have
+   * never been written are skipped.
+   * @param area the area, clipped to the map
+   * @param f the function
+   */
+  template <class F>
+  void forEach(const Rect& area, F&& f) const {
+    visit(area, [&](int chunkX, int chunkY, const Rect& part) {
+      const T* tiles = reinterpret_cast<const T*>(store.find(chunkX, chunkY));
+      if (!tiles) return;
+      for (int y = part.y; y < part.y + part.h; ++y) {
+        for (int x = part.x; x < part.x + part.w; ++x) f(x, y, tiles[indexOf(x, y)]);
+      }
+    });
+  }
+  /**
+   * Calls a function on every tile of an area for writing, as <code>f(x, y, tile)</code>, chunk by chunk. All the
+   * chunks of the area are allocated.
+   * @param area the area, clipped to the map
+   * @param f the function
+   */
+  template <class F>
+  void modify(const Rect& area, F&& f) {
+    visit(area, [&](int chunkX, int chunkY, const Rect& part) {
+      T* tiles = reinterpret_cast<T*>(store.page(chunkX, chunkY));
+      for (int y = part.y; y < part.y + part.h; ++y) {
+        for (int x = part.x; x < part.x + part.w; ++x) f(x, y, tiles[indexOf(x, y)]);
+      }
+    });
+  }
+  /**
+   * Moves the area of interest. See <code>TileStore::setViewport()</code>.
+   * @param view the area of interest, in tiles
+   * @param margin the width of the read ahead margin around the view, in tiles
+   */
+  void setViewport(const Rect& view, int margin = CHUNK_SIZE) { store.setViewport(view, margin); }
+  void setResidentLimit(size_t chunks) noexcept { store.setResidentLimit(chunks); }
+  void flush() { store.flush(); }
+  size_t getResidentCount() const noexcept { return store.getResidentCount(); }
+  int getWidth() const noexcept { return store.getWidth(); }
+  int getHeight() const noexcept { return store.getHeight(); }
+
+ private:
+  static uint32_t indexOf(int x, int y) noexcept {
+    return mortonEncode(x & (CHUNK_SIZE - 1), y & (CHUNK_SIZE - 1));
+  }
+  /**
+   * Splits an area in its parts lying in each chunk, calling <code>f(chunkX, chunkY, part)</code> for each.
+   */
+  template <class F>
+  void visit(const Rect& area, F&& f) const {
+    const int left = std::max(area.x, 0);
+    const int top = std::max(area.y, 0);
+    const int right = std::min(area.x + area.w, store.getWidth());
+    const int bottom = std::min(area.y + area.h, store.getHeight());
+    if (left >= right || top >= bottom) return;
+    for (int chunkY = top >> TileStore::CHUNK_SHIFT; chunkY << TileStore::CHUNK_SHIFT < bottom; ++chunkY) {
+      for (int chunkX = left >> TileStore::CHUNK_SHIFT; chunkX << TileStore::CHUNK_SHIFT < right; ++chunkX) {
+        const int x = std::max(left, chunkX << TileStore::CHUNK_SHIFT);
+        const int y = std::max(top, chunkY << TileStore::CHUNK_SHIFT);
+        const int partRight = std::min(right, (chunkX + 1) << TileStore::CHUNK_SHIFT);
+        const int partBottom = std::min(bottom, (chunkY + 1) << TileStore::CHUNK_SHIFT);
+        f(chunkX, chunkY, Rect{x, y, partRight - x, partBottom - y});
+      }
+    }
+  }
+  TileStore store;
+};
+}  // namespace base
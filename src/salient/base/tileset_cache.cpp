@@ -0,0 +1,179 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "base/tileset_cache.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <libtcod/libtcod.hpp>
+#include <system_error>
+#include <vector>
+
+#include "base/mapped_file.hpp"
+#include "logger/log.hpp"
+
+namespace base {
+namespace {
+constexpr char CACHE_MAGIC[8] = {'S', 'L', 'N', 'T', 'T', 'I', 'L', 'E'};
+// bump whenever the layout of the file changes
+constexpr uint32_t CACHE_VERSION = 1;
+
+// the file is a header, followed by the tile pixels and the character map. It is only ever read on the machine that
+// wrote it, so everything is stored in native byte order
+struct CacheHeader {
+  char magic[8];
+  uint32_t version;
+  int32_t fontFlags;
+  int32_t fontColumns;
+  int32_t fontRows;
+  uint64_t sourceSize;
+  int64_t sourceTime;
+  uint64_t mappingHash;
+  int32_t tileWidth;
+  int32_t tileHeight;
+  int32_t tilesCount;
+  int32_t characterMapLength;
+};
+
+// fills the fields identifying the font the tileset was baked from
+bool describeSource(const Font& font, uint64_t mappingHash, CacheHeader& header) {
+  std::error_code error;
+  const std::filesystem::path source{font.filename()};
+  const auto size = std::filesystem::file_size(source, error);
+  if (error) return false;
+  const auto time = std::filesystem::last_write_time(source, error);
+  if (error) return false;
+  std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+  header.version = CACHE_VERSION;
+  header.fontFlags = font.flags();
+  header.fontColumns = font.columns();
+  header.fontRows = font.rows();
+  header.sourceSize = size;
+  header.sourceTime = static_cast<int64_t>(time.time_since_epoch().count());
+  header.mappingHash = mappingHash;
+  return true;
+}
+}  // namespace
+
+std::filesystem::path TilesetCache::cachePath(const Font& font) const {
+  return directory_ / std::filesystem::path{font.filename()}.filename().replace_extension(".tileset");
+}
+
+bool TilesetCache::load(const Font& font, uint64_t mappingHash) const {
+  CacheHeader expected{};
+  if (!describeSource(font, mappingHash, expected)) return false;
+  const std::filesystem::path path = cachePath(font);
+  const MappedFile file{path};
+  if (!file.isOpen() || file.size() < sizeof(CacheHeader)) return false;
+  CacheHeader header;
+  std::memcpy(&header, file.data(), sizeof(header));
+  if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 || header.version != expected.version ||
+      header.fontFlags != expected.fontFlags || header.fontColumns != expected.fontColumns ||
+      header.fontRows != expected.fontRows || header.sourceSize != expected.sourceSize ||
+      header.sourceTime != expected.sourceTime || header.mappingHash != expected.mappingHash) {
+    logger::Log::info("TilesetCache::load | The baked tileset \"%s\" is out of date.", path.string());
+    return false;
+  }
+  const size_t tileLength = static_cast<size_t>(header.tileWidth) * header.tileHeight;
+  const size_t pixelsSize = tileLength * header.tilesCount * sizeof(TCOD_ColorRGBA);
+  const size_t mapSize = static_cast<size_t>(header.characterMapLength) * sizeof(int);
+  if (header.tileWidth <= 0 || header.tileHeight <= 0 || header.tilesCount <= 0 || header.characterMapLength < 0 ||
+      file.size() != sizeof(CacheHeader) + pixelsSize + mapSize) {
+    logger::Log::warning("TilesetCache::load | The baked tileset \"%s\" is corrupted.", path.string());
+    return false;
+  }
+  const auto* pixels = reinterpret_cast<const TCOD_ColorRGBA*>(file.data() + sizeof(CacheHeader));
+  std::vector<int> characterMap(static_cast<size_t>(header.characterMapLength));
+  std::memcpy(characterMap.data(), file.data() + sizeof(CacheHeader) + pixelsSize, mapSize);
+
+  TCOD_Tileset* tileset = TCOD_tileset_new(header.tileWidth, header.tileHeight);
+  if (!tileset) return false;
+  // libtcod only adds tiles through code points: the first code point of each baked tile brings in its pixels, the
+  // following ones share the tile. Unassigned code points point at the blank tile 0, as in a fresh tileset
+  std::vector<int> tileIds(static_cast<size_t>(header.tilesCount), -1);
+  for (int codepoint = 0; codepoint < header.characterMapLength; ++codepoint) {
+    const int tile = characterMap[codepoint];
+    if (tile <= 0 || tile >= header.tilesCount) continue;
+    if (tileIds[tile] < 0) {
+      if (TCOD_tileset_set_tile_(tileset, codepoint, pixels + tileLength * tile) < 0) {
+        TCOD_tileset_delete(tileset);
+        return false;
+      }
+      tileIds[tile] = tileset->character_map[codepoint];
+    } else {
+      TCOD_tileset_assign_tile(tileset, tileIds[tile], codepoint);
+    }
+  }
+  TCOD_set_default_tileset(tileset);
+  TCOD_tileset_delete(tileset);  // the default tileset holds its own reference
+  logger::Log::info("TilesetCache::load | Loaded the baked tileset \"%s\".", path.string());
+  return true;
+}
+
+bool TilesetCache::store(const Font& font, uint64_t mappingHash) const {
+  const TCOD_Tileset* tileset = TCOD_get_default_tileset();
+  CacheHeader header{};
+  if (!tileset || !describeSource(font, mappingHash, header)) return false;
+  header.tileWidth = tileset->tile_width;
+  header.tileHeight = tileset->tile_height;
+  header.tilesCount = tileset->tiles_count;
+  header.characterMapLength = tileset->character_map_length;
+  const std::filesystem::path path = cachePath(font);
+  std::error_code error;
+  std::filesystem::create_directories(directory_, error);
+  // write to a temporary file first so that a crash never leaves a truncated tileset behind
+  std::filesystem::path temporary = path;
+  temporary += ".tmp";
+  {
+    std::ofstream out{temporary, std::ios::binary | std::ios::trunc};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(
+        reinterpret_cast<const char*>(tileset->pixels),
+        static_cast<std::streamsize>(sizeof(TCOD_ColorRGBA)) * tileset->tile_length * tileset->tiles_count);
+    out.write(
+        reinterpret_cast<const char*>(tileset->character_map),
+        static_cast<std::streamsize>(sizeof(int)) * tileset->character_map_length);
+    if (!out) {
+      logger::Log::warning("TilesetCache::store | Could not write the baked tileset \"%s\".", path.string());
+      std::filesystem::remove(temporary, error);
+      return false;
+    }
+  }
+  std::filesystem::rename(temporary, path, error);
+  if (error) {
+    logger::Log::warning("TilesetCache::store | Could not write the baked tileset \"%s\".", path.string());
+    std::filesystem::remove(temporary, error);
+    return false;
+  }
+  logger::Log::info("TilesetCache::store | Baked the tileset of \"%s\".", font.filename());
+  return true;
+}
+}  // namespace base
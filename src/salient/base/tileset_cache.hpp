@@ -0,0 +1,73 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+#include "base/font.hpp"
+
+namespace base {
+/**
+ * A cache of baked tilesets. Loading a font through libtcod decodes its PNG file, converts it to an alpha atlas and
+ * builds the character map; the cache stores the result in a binary file that is memory mapped and handed to libtcod
+ * directly the next time the same font is used.
+ */
+class TilesetCache {
+ public:
+  /**
+   * Creates a tileset cache.
+   * @param directory the directory holding the baked tilesets. It is created when the first tileset is stored.
+   */
+  explicit TilesetCache(std::filesystem::path directory) : directory_{std::move(directory)} {}
+  /**
+   * Loads the baked tileset of a font and makes it libtcod's default tileset, to be picked up by
+   * <code>TCODConsole::initRoot()</code>.
+   * @param font the font to be loaded
+   * @param mappingHash a hash of the custom character mappings applied on top of the font
+   * @return <code>true</code> if an up to date tileset was found, <code>false</code> if the font has to be loaded and
+   * stored again
+   */
+  bool load(const Font& font, uint64_t mappingHash) const;
+  /**
+   * Bakes libtcod's current default tileset.
+   * @param font the font the tileset was loaded from
+   * @param mappingHash a hash of the custom character mappings applied on top of the font
+   * @return <code>true</code> if the tileset has been stored, <code>false</code> otherwise
+   */
+  bool store(const Font& font, uint64_t mappingHash) const;
+
+ private:
+  std::filesystem::path cachePath(const Font& font) const;
+  std::filesystem::path directory_;
+};
+}  // namespace base
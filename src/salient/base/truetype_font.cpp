@@ -0,0 +1,192 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "base/truetype_font.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+
+#include "logger/log.hpp"
+
+// libtcod ships its own copy of stb_truetype: keep ours private to this file
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#elif defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable : 4100 4244 4245 4456 4457 4701)
+#endif
+#include "vendor/stb_truetype.h"
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#elif defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+namespace base {
+namespace {
+constexpr int MIN_PIXEL_HEIGHT = 6;
+constexpr int MAX_PIXEL_HEIGHT = 128;
+}  // namespace
+
+struct TrueTypeFont::FontInfo {
+  stbtt_fontinfo font;
+};
+
+TrueTypeFont::TrueTypeFont(const std::filesystem::path& filename, int pixelHeight, size_t maxGlyphs)
+    : info{std::make_unique<FontInfo>()}, maxGlyphs{std::max<size_t>(maxGlyphs, 256)} {
+  std::ifstream in{filename, std::ios::binary};
+  fontData.assign(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{});
+  if (fontData.empty() ||
+      !stbtt_InitFont(&info->font, fontData.data(), stbtt_GetFontOffsetForIndex(fontData.data(), 0))) {
+    logger::Log::error("TrueTypeFont::TrueTypeFont | Could not load the font \"%s\".", filename.string());
+    fontData.clear();
+    return;
+  }
+  if (!setPixelHeight(pixelHeight)) setPixelHeight(16);
+}
+
+TrueTypeFont::~TrueTypeFont() { TCOD_tileset_delete(tileset); }
+
+bool TrueTypeFont::setPixelHeight(int height) {
+  if (fontData.empty() || height < MIN_PIXEL_HEIGHT || height > MAX_PIXEL_HEIGHT) return false;
+  pixelHeight = height;
+  scale = stbtt_ScaleForPixelHeight(&info->font, static_cast<float>(height));
+  int ascent = 0;
+  int descent = 0;
+  int lineGap = 0;
+  stbtt_GetFontVMetrics(&info->font, &ascent, &descent, &lineGap);
+  baseline = static_cast<int>(std::lround(ascent * scale));
+  // console fonts are monospaced: every glyph advances as much as 'M'
+  int advance = 0;
+  int bearing = 0;
+  stbtt_GetCodepointHMetrics(&info->font, 'M', &advance, &bearing);
+  tileWidth = std::max(1, static_cast<int>(std::ceil(advance * scale)));
+  // start over with an empty tileset, the glyph cache refills it as the code points show up again
+  TCOD_tileset_delete(tileset);
+  tileset = TCOD_tileset_new(tileWidth, pixelHeight);
+  resident.clear();
+  lru.clear();
+  return true;
+}
+
+std::vector<TCOD_ColorRGBA> TrueTypeFont::rasterise(int codepoint) const {
+  std::vector<TCOD_ColorRGBA> pixels(static_cast<size_t>(tileWidth) * pixelHeight, TCOD_ColorRGBA{255, 255, 255, 0});
+  int x0 = 0;
+  int y0 = 0;
+  int x1 = 0;
+  int y1 = 0;
+  stbtt_GetCodepointBitmapBox(&info->font, codepoint, scale, scale, &x0, &y0, &x1, &y1);
+  const int width = x1 - x0;
+  const int height = y1 - y0;
+  if (width <= 0 || height <= 0) return pixels;  // blank glyph, like the space
+  std::vector<unsigned char> coverage(static_cast<size_t>(width) * height);
+  stbtt_MakeCodepointBitmap(&info->font, coverage.data(), width, height, width, scale, scale, codepoint);
+  // copy the coverage into the tile, clipping whatever overhangs it
+  for (int y = 0; y < height; ++y) {
+    const int tileY = baseline + y0 + y;
+    if (tileY < 0 || tileY >= pixelHeight) continue;
+    for (int x = 0; x < width; ++x) {
+      const int tileX = x0 + x;
+      if (tileX < 0 || tileX >= tileWidth) continue;
+      pixels[static_cast<size_t>(tileY) * tileWidth + tileX].a = coverage[static_cast<size_t>(y) * width + x];
+    }
+  }
+  return pixels;
+}
+
+void TrueTypeFont::upload(int codepoint, const std::vector<TCOD_ColorRGBA>& pixels) {
+  if (resident.size() >= maxGlyphs) {
+    // reuse the tile of the least recently displayed glyph, unless everything is on screen right now
+    const int evicted = lru.back();
+    const Resident victim = resident.at(evicted);
+    if (victim.lastFrame == frame) return;
+    lru.pop_back();
+    resident.erase(evicted);
+    TCOD_tileset_assign_tile(tileset, 0, evicted);
+    TCOD_tileset_assign_tile(tileset, victim.tileId, codepoint);
+  }
+  if (TCOD_tileset_set_tile_(tileset, codepoint, pixels.data()) < 0) return;
+  lru.push_front(codepoint);
+  resident.emplace(codepoint, Resident{tileset->character_map[codepoint], lru.begin(), frame});
+}
+
+void TrueTypeFont::cacheGlyph(uint64_t key, std::vector<TCOD_ColorRGBA> pixels) {
+  // the cache spans every pixel height, so it is allowed to grow beyond a single tileset
+  while (glyphCacheOrder.size() >= maxGlyphs * 4) {
+    glyphCache.erase(glyphCacheOrder.front());
+    glyphCacheOrder.pop_front();
+  }
+  glyphCache.emplace(key, std::move(pixels));
+  glyphCacheOrder.emplace_back(key);
+}
+
+void TrueTypeFont::prepare(const TCOD_Console& console, jobs::JobPool& pool) {
+  if (!tileset) return;
+  ++frame;
+  std::vector<int> missing{};
+  for (int i = 0; i < console.elements; ++i) {
+    const int codepoint = console.tiles[i].ch;
+    if (codepoint <= 0) continue;
+    auto it = resident.find(codepoint);
+    if (it == resident.end()) {
+      missing.emplace_back(codepoint);
+    } else if (it->second.lastFrame != frame) {
+      it->second.lastFrame = frame;
+      lru.splice(lru.begin(), lru, it->second.lruPosition);
+    }
+  }
+  if (missing.empty()) return;
+  std::sort(missing.begin(), missing.end());
+  missing.erase(std::unique(missing.begin(), missing.end()), missing.end());
+  // glyphs rasterised for this pixel height before can be uploaded straight away
+  std::vector<int> toRasterise{};
+  for (int codepoint : missing) {
+    auto cached = glyphCache.find(glyphKey(pixelHeight, codepoint));
+    if (cached != glyphCache.end())
+      upload(codepoint, cached->second);
+    else
+      toRasterise.emplace_back(codepoint);
+  }
+  if (toRasterise.empty()) return;
+  std::vector<std::vector<TCOD_ColorRGBA>> glyphs(toRasterise.size());
+  pool.parallelFor(toRasterise.size(), [&](size_t i) { glyphs[i] = rasterise(toRasterise[i]); });
+  for (size_t i = 0; i < toRasterise.size(); ++i) {
+    upload(toRasterise[i], glyphs[i]);
+    cacheGlyph(glyphKey(pixelHeight, toRasterise[i]), std::move(glyphs[i]));
+  }
+}
+}  // namespace base
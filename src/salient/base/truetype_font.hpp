@@ -0,0 +1,123 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <libtcod/libtcod.hpp>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "jobs/pool.hpp"
+
+namespace base {
+/**
+ * A font rasterised at runtime from a TrueType file. Instead of a pre-rendered sheet, the font fills a libtcod tileset
+ * on demand: every frame <code>prepare()</code> looks for the code points the console uses that the tileset doesn't
+ * hold yet, rasterises them on the job pool and uploads them. The tileset holds a bounded number of glyphs and evicts
+ * the least recently displayed ones. Rasterised glyphs are kept in memory independently of the tileset, so switching
+ * back to a pixel height that has been used before doesn't rasterise anything again.
+ */
+class TrueTypeFont {
+ public:
+  /**
+   * Loads a TrueType font.
+   * @param filename the TrueType (.ttf) file
+   * @param pixelHeight the height of the glyphs, in pixels
+   * @param maxGlyphs the maximum number of glyphs held by the tileset at once
+   */
+  TrueTypeFont(const std::filesystem::path& filename, int pixelHeight, size_t maxGlyphs = 4096);
+  ~TrueTypeFont();
+  TrueTypeFont(const TrueTypeFont&) = delete;
+  TrueTypeFont& operator=(const TrueTypeFont&) = delete;
+  /**
+   * Checks whether the font file has been successfully loaded.
+   * @return <code>true</code> if the font can be used, <code>false</code> otherwise
+   */
+  bool isLoaded() const { return tileset != nullptr; }
+  /**
+   * Gets the height of the glyphs.
+   * @return the height of the glyphs, in pixels
+   */
+  int getPixelHeight() const { return pixelHeight; }
+  /**
+   * Changes the height of the glyphs. This replaces the tileset, which then has to be passed to libtcod again.
+   * @param height the new height of the glyphs, in pixels
+   * @return <code>true</code> if the height has been changed, <code>false</code> if it is out of range
+   */
+  bool setPixelHeight(int height);
+  /**
+   * Gets the tileset the glyphs are uploaded to.
+   * @return the tileset, owned by the font
+   */
+  TCOD_Tileset* getTileset() { return tileset; }
+  /**
+   * Makes sure every code point displayed on a console has its glyph in the tileset. Call this on the main thread after
+   * the console has been drawn and before it is presented.
+   * @param console the console about to be presented
+   * @param pool the job pool rasterising the missing glyphs
+   */
+  void prepare(const TCOD_Console& console, jobs::JobPool& pool);
+
+ private:
+  // a glyph resident in the tileset
+  struct Resident {
+    int tileId;
+    std::list<int>::iterator lruPosition;
+    uint64_t lastFrame;
+  };
+  static uint64_t glyphKey(int pixelHeight, int codepoint) {
+    return static_cast<uint64_t>(pixelHeight) << 32 | static_cast<uint32_t>(codepoint);
+  }
+  std::vector<TCOD_ColorRGBA> rasterise(int codepoint) const;
+  void upload(int codepoint, const std::vector<TCOD_ColorRGBA>& pixels);
+  void cacheGlyph(uint64_t key, std::vector<TCOD_ColorRGBA> pixels);
+
+  struct FontInfo;
+  std::vector<unsigned char> fontData{};
+  std::unique_ptr<FontInfo> info;
+  int pixelHeight{};
+  int tileWidth{};
+  int baseline{};
+  float scale{};
+  size_t maxGlyphs{};
+  TCOD_Tileset* tileset{};
+  uint64_t frame{};
+  std::unordered_map<int, Resident> resident{};  // code point -> tile, for the current pixel height
+  std::list<int> lru{};  // resident code points, most recently displayed first
+  std::unordered_map<uint64_t, std::vector<TCOD_ColorRGBA>> glyphCache{};  // rasterised glyphs of all pixel heights
+  std::deque<uint64_t> glyphCacheOrder{};  // oldest cached glyph first
+};
+}  // namespace base
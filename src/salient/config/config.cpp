@@ -32,6 +32,7 @@
 #include "config/config.hpp"
 
 #include <stdio.h>
+#include <string.h>
 
 #include <array>
 #include <libtcod/libtcod.hpp>
@@ -41,6 +42,63 @@
 namespace config {
 static constexpr std::array logLevelName = {"info", "notice", "warning", "error", "fatal error", "none"};
 
+// declares the configuration file structure
+static void declareConfigStructure(TCODParser& parser, bool mandatory) {
+  parser.newStructure("config")
+      ->addProperty("rootWidth", TCOD_TYPE_INT, mandatory)
+      ->addProperty("rootHeight", TCOD_TYPE_INT, mandatory)
+      ->addProperty("fontID", TCOD_TYPE_INT, mandatory)
+      ->addProperty("fullScreen", TCOD_TYPE_BOOL, mandatory)
+      ->addProperty("logLevel", TCOD_TYPE_STRING, mandatory)
+      // optional custom font directory
+      ->addProperty("fontDir", TCOD_TYPE_STRING, false)
+      // optional module chaining
+      ->addProperty("moduleChain", TCOD_TYPE_STRING, false)
+      // optional configuration hot reloading
+      ->addProperty("hotReload", TCOD_TYPE_BOOL, false);
+}
+
+static LogLevel parseLogLevel(const std::string& name) {
+  for (int i = 0; i <= static_cast<int>(LOGLEVEL_NONE); ++i) {
+    if (name == logLevelName.at(i)) return static_cast<LogLevel>(i);
+  }
+  return LOGLEVEL_INFO;
+}
+
+// reads the configuration into a ConfigValues structure. The default listener would exit the program on a syntax
+// error, which is not an option when the file is being edited while the program runs.
+class ConfigReader : public ITCODParserListener {
+ public:
+  ConfigReader(ConfigValues& values, std::string& error) : values(values), error_(error) {}
+  bool parserNewStruct(TCODParser*, const TCODParserStruct*, const char*) override { return true; }
+  bool parserFlag(TCODParser*, const char*) override { return true; }
+  bool parserProperty(TCODParser*, const char* name, TCOD_value_type_t, TCOD_value_t value) override {
+    if (strcmp(name, "rootWidth") == 0)
+      values.rootWidth = value.i;
+    else if (strcmp(name, "rootHeight") == 0)
+      values.rootHeight = value.i;
+    else if (strcmp(name, "fontID") == 0)
+      values.fontID = value.i;
+    else if (strcmp(name, "fullScreen") == 0)
+      values.fullScreen = value.b;
+    else if (strcmp(name, "logLevel") == 0)
+      values.logLevel = parseLogLevel(value.s);
+    else if (strcmp(name, "fontDir") == 0)
+      values.fontDir = value.s;
+    else if (strcmp(name, "moduleChain") == 0)
+      values.moduleChain = value.s;
+    else if (strcmp(name, "hotReload") == 0)
+      values.hotReload = value.b;
+    return true;
+  }
+  bool parserEndStruct(TCODParser*, const TCODParserStruct*, const char*) override { return true; }
+  void error(const char* msg) override { error_ = msg; }
+
+ private:
+  ConfigValues& values;
+  std::string& error_;
+};
+
 void Config::load(std::filesystem::path path) {
   static bool loaded = false;
   TCODParser parser;
@@ -54,16 +112,7 @@ void Config::load(std::filesystem::path path) {
   Config::fileName = path;
 
   // register configuration variables
-  parser.newStructure("config")
-      ->addProperty("rootWidth", TCOD_TYPE_INT, true)
-      ->addProperty("rootHeight", TCOD_TYPE_INT, true)
-      ->addProperty("fontID", TCOD_TYPE_INT, true)
-      ->addProperty("fullScreen", TCOD_TYPE_BOOL, true)
-      ->addProperty("logLevel", TCOD_TYPE_STRING, true)
-      // optional custom font directory
-      ->addProperty("fontDir", TCOD_TYPE_STRING, false)
-      // optional module chaining
-      ->addProperty("moduleChain", TCOD_TYPE_STRING, false);
+  declareConfigStructure(parser, true);
 
   // check if the config file exists
   if (!std::filesystem::exists(path)) {
@@ -80,6 +129,7 @@ void Config::load(std::filesystem::path path) {
   }
 
   // run the parser
+  std::lock_guard lock{parserMutex};
   parser.run(path.string().c_str(), NULL);
 
   // assign parsed values to class variables
@@ -89,20 +139,29 @@ void Config::load(std::filesystem::path path) {
   fullScreen = parser.getBoolProperty("config.fullScreen");
   fontDir = "data/img";  // default value
   if (parser.hasProperty("config.fontDir")) fontDir = parser.getStringProperty("config.fontDir");
-  moduleChain = "";
-  if (parser.hasProperty("config.moduleChain")) moduleChain = parser.getStringProperty("config.moduleChain");
+  moduleChainName = "";
+  if (parser.hasProperty("config.moduleChain")) moduleChainName = parser.getStringProperty("config.moduleChain");
+  moduleChain = moduleChainName.c_str();
+  hotReload = parser.hasProperty("config.hotReload") && parser.getBoolProperty("config.hotReload");
   // set log level
-  {
-    std::string configLogLevel = "info";
-    if (parser.hasProperty("config.logLevel")) configLogLevel = parser.getStringProperty("config.logLevel");
-    for (int i = 0; i <= static_cast<int>(LOGLEVEL_NONE); ++i) {
-      if (configLogLevel == logLevelName.at(i)) logLevel = static_cast<LogLevel>(i);
-    }
-  }
+  if (parser.hasProperty("config.logLevel")) logLevel = parseLogLevel(parser.getStringProperty("config.logLevel"));
   loaded = true;
   logger::Log::closeBlock(logger::LOGRESULT_SUCCESS);
 }
 
+bool Config::read(const std::filesystem::path& path, ConfigValues& values, std::string& error) {
+  if (!std::filesystem::exists(path)) {
+    error = fmt::format("Configuration file {} is missing.", path.string());
+    return false;
+  }
+  TCODParser parser;
+  declareConfigStructure(parser, false);
+  ConfigReader reader{values, error};
+  std::lock_guard lock{parserMutex};
+  parser.run(path.string().c_str(), &reader);
+  return error.empty();
+}
+
 void Config::save() {
   FILE* out;
   std::string modC = "";
@@ -140,6 +199,8 @@ void Config::save() {
       " *                                 (debug mode off)\n"
       " * fontDir (string): the directory containing font files\n"
       " * moduleChain (string): the module chain to load (optional)\n"
+      " * hotReload (boolean): whether configuration files are reloaded when they\n"
+      " *                      change on disk (optional, default false)\n"
       " */\n"
       "\n"
       "config {\n"
@@ -150,6 +211,7 @@ void Config::save() {
       "  logLevel = \"%s\"\n"
       "  fontDir = \"%s\"\n"
       "%s"
+      "  hotReload = %s\n"
       "}\n",
       rootWidth,
       rootHeight,
@@ -157,7 +219,8 @@ void Config::save() {
       (TCODConsole::isFullscreen() ? "true" : "false"),
       logLevelName.at(logLevel),
       fontDir.string().c_str(),
-      modC.c_str());
+      modC.c_str(),
+      (hotReload ? "true" : "false"));
 
   fclose(out);
 }
@@ -181,4 +244,12 @@ bool Config::activateFont(int shift) {
   fontID += s;
   return true;
 }
+
+bool Config::activateFontID(int id) {
+  if (id < 0 || id >= static_cast<int>(fonts.size())) return false;
+  if (font != NULL && id == fontID) return false;
+  font = &fonts.at(id);
+  fontID = id;
+  return true;
+}
 }  // namespace config
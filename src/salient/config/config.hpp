@@ -33,6 +33,8 @@
 #define UMBRA_CONFIG_HPP
 #include <filesystem>
 #include <libtcod/list.hpp>
+#include <mutex>
+#include <string>
 #include <vector>
 
 #include "base/font.hpp"
@@ -40,6 +42,20 @@
 namespace config {
 enum LogLevel { LOGLEVEL_INFO, LOGLEVEL_NOTICE, LOGLEVEL_WARN, LOGLEVEL_ERROR, LOGLEVEL_FATAL, LOGLEVEL_NONE };
 
+/**
+ * The configuration variables as read from a configuration file, before they are applied to the engine.
+ */
+struct ConfigValues {
+  int rootWidth{80};
+  int rootHeight{60};
+  int fontID{0};
+  bool fullScreen{false};
+  LogLevel logLevel{LOGLEVEL_INFO};
+  std::filesystem::path fontDir{"data/img"};
+  std::string moduleChain{};
+  bool hotReload{false};
+};
+
 class Config {
   friend class Engine;
   friend class Log;
@@ -55,6 +71,12 @@ class Config {
   static inline const char* moduleChain{};
   static inline int fontID{};
   static inline std::vector<base::Font> fonts{};
+  static inline bool hotReload{};
+  /**
+   * libtcod's parser keeps its lexer in global state, so any thread running a <code>TCODParser</code> must hold this
+   * mutex.
+   */
+  static inline std::mutex parserMutex{};
 
   // private:
   /**
@@ -65,11 +87,26 @@ class Config {
    * @return <code>true</code> if the font has been successfully changed, <code>false</code> otherwise
    */
   static bool activateFont(int shift = 0);
+  /**
+   * Activates the font with the given ID.
+   * @param id the ID of the font in the registered fonts list
+   * @return <code>true</code> if the font has been successfully changed, <code>false</code> otherwise
+   */
+  static bool activateFontID(int id);
   /**
    * Loads configuration variables from a config file.
    * @param fileName the filename (with path to it) of the configuration file
    */
   static void load(std::filesystem::path fileName);
+  /**
+   * Reads configuration variables from a config file without applying them. Unlike <code>load()</code>, a malformed
+   * file is reported instead of terminating the program, and it is safe to call from any thread.
+   * @param path the filename (with path to it) of the configuration file
+   * @param values the values read from the file
+   * @param error receives the reason of the failure, if any
+   * @return <code>true</code> if the file has been read successfully, <code>false</code> otherwise
+   */
+  static bool read(const std::filesystem::path& path, ConfigValues& values, std::string& error);
   /**
    * Saves the configuration to a config file. It is called on application exit, so any changes to the configuration are
    * stored.
@@ -81,6 +118,9 @@ class Config {
    */
   static void registerFont(const base::Font& new_font);
   [[deprecated]] static void registerFont(base::Font* new_font) { registerFont(*new_font); }
+
+ private:
+  static inline std::string moduleChainName{};  // storage for moduleChain
 };
 }  // namespace config
 #endif
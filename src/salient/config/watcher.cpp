@@ -0,0 +1,200 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "config/watcher.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace config {
+// editors usually save a file in several steps, so wait for things to settle before re-reading it
+static constexpr auto SETTLE_DELAY = std::chrono::milliseconds(50);
+// how often modification times are checked when inotify isn't available
+static constexpr auto POLL_INTERVAL = std::chrono::milliseconds(500);
+
+static size_t hashFileContents(const std::filesystem::path& path) {
+  std::ifstream in{path, std::ios::binary};
+  if (!in) return 0;
+  std::ostringstream contents;
+  contents << in.rdbuf();
+  return std::hash<std::string>{}(contents.str());
+}
+
+static std::filesystem::file_time_type writeTimeOf(const std::filesystem::path& path) {
+  std::error_code ec;
+  auto time = std::filesystem::last_write_time(path, ec);
+  return ec ? std::filesystem::file_time_type{} : time;
+}
+
+FileWatcher::~FileWatcher() { stop(); }
+
+void FileWatcher::watch(const std::filesystem::path& path, ParseFunc parse) {
+  std::lock_guard lock{filesMutex};
+  auto& file = files.emplace_back(WatchedFile{path, std::move(parse), hashFileContents(path), writeTimeOf(path), -1});
+  if (running) addSystemWatch(file);
+}
+
+void FileWatcher::start() {
+  if (running) return;
+#ifdef __linux__
+  inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (inotifyFd >= 0 && pipe2(wakePipe, O_CLOEXEC) != 0) {
+    close(inotifyFd);
+    inotifyFd = -1;
+  }
+#endif
+  {
+    std::lock_guard lock{filesMutex};
+    for (auto& file : files) addSystemWatch(file);
+  }
+  running = true;
+  thread = std::thread(&FileWatcher::threadMain, this);
+}
+
+void FileWatcher::stop() {
+  if (!running) return;
+  {
+    std::lock_guard lock{wakeMutex};
+    running = false;
+  }
+  wakeCondition.notify_all();
+#ifdef __linux__
+  if (wakePipe[1] >= 0) {
+    const char byte = 0;
+    [[maybe_unused]] auto written = write(wakePipe[1], &byte, 1);
+  }
+#endif
+  if (thread.joinable()) thread.join();
+#ifdef __linux__
+  const auto closeFd = [](int& fd) {
+    if (fd >= 0) close(fd);
+    fd = -1;
+  };
+  closeFd(inotifyFd);
+  closeFd(wakePipe[0]);
+  closeFd(wakePipe[1]);
+  std::lock_guard lock{filesMutex};
+  for (auto& file : files) file.watchDescriptor = -1;
+#endif
+}
+
+void FileWatcher::applyPending() {
+  std::vector<ApplyFunc> toApply;
+  {
+    std::unique_lock lock{pendingMutex, std::try_to_lock};
+    if (!lock.owns_lock() || pending.empty()) return;
+    toApply.swap(pending);
+  }
+  for (auto& apply : toApply) apply();
+}
+
+void FileWatcher::reparse(WatchedFile& file) {
+  const size_t hash = hashFileContents(file.path);
+  if (hash == 0 || hash == file.contentHash) return;
+  file.contentHash = hash;
+  ApplyFunc apply = file.parse(file.path);
+  if (!apply) return;
+  std::lock_guard lock{pendingMutex};
+  pending.emplace_back(std::move(apply));
+}
+
+void FileWatcher::addSystemWatch([[maybe_unused]] WatchedFile& file) {
+#ifdef __linux__
+  if (inotifyFd < 0) return;
+  // watch the directory rather than the file: many editors save by writing a new file and renaming it over the old one
+  auto dir = file.path.parent_path();
+  if (dir.empty()) dir = ".";
+  file.watchDescriptor = inotify_add_watch(inotifyFd, dir.string().c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+#endif
+}
+
+void FileWatcher::threadMain() {
+#ifdef __linux__
+  if (inotifyFd >= 0) {
+    alignas(inotify_event) char buffer[4096];
+    while (running) {
+      pollfd fds[2] = {{inotifyFd, POLLIN, 0}, {wakePipe[0], POLLIN, 0}};
+      if (poll(fds, 2, -1) < 0) {
+        if (errno == EINTR) continue;
+        break;
+      }
+      if (fds[1].revents || !running) break;
+      std::this_thread::sleep_for(SETTLE_DELAY);
+      std::vector<std::pair<int, std::string>> changed;
+      ssize_t length;
+      while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+        for (char* ptr = buffer; ptr < buffer + length;) {
+          const auto* event = reinterpret_cast<const inotify_event*>(ptr);
+          if (event->len > 0) changed.emplace_back(event->wd, event->name);
+          ptr += sizeof(inotify_event) + event->len;
+        }
+      }
+      std::lock_guard lock{filesMutex};
+      for (auto& file : files) {
+        const auto found = std::find(
+            changed.begin(), changed.end(), std::make_pair(file.watchDescriptor, file.path.filename().string()));
+        if (found != changed.end()) reparse(file);
+      }
+    }
+    return;
+  }
+#endif
+  // no inotify: fall back to checking modification times
+  while (running) {
+    {
+      std::unique_lock lock{wakeMutex};
+      wakeCondition.wait_for(lock, POLL_INTERVAL, [this] { return !running; });
+    }
+    if (running) pollChanges();
+  }
+}
+
+void FileWatcher::pollChanges() {
+  std::lock_guard lock{filesMutex};
+  for (auto& file : files) {
+    const auto time = writeTimeOf(file.path);
+    if (time == file.writeTime) continue;
+    file.writeTime = time;
+    std::this_thread::sleep_for(SETTLE_DELAY);
+    reparse(file);
+  }
+}
+}  // namespace config
@@ -0,0 +1,122 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace config {
+/**
+ * Watches files for changes on disk. Changed files are re-parsed on a background thread and the resulting changes are
+ * queued until the engine applies them between two frames, so that a reload never stalls a frame nor touches a module
+ * while it's being updated or rendered. Uses inotify on Linux and falls back to polling file modification times on
+ * other platforms.
+ */
+class FileWatcher {
+ public:
+  /**
+   * Work executed on the main thread, between two frames, once a watched file has been re-parsed.
+   */
+  using ApplyFunc = std::function<void()>;
+  /**
+   * Parses a changed file. It is called on the watcher thread and must not touch any engine or module state (this
+   * includes the log): everything that needs changing goes into the returned function instead. It may return an empty
+   * function if there is nothing to apply.
+   */
+  using ParseFunc = std::function<ApplyFunc(const std::filesystem::path&)>;
+
+  FileWatcher() = default;
+  FileWatcher(const FileWatcher&) = delete;
+  FileWatcher& operator=(const FileWatcher&) = delete;
+  ~FileWatcher();
+  /**
+   * Adds a file to the watch list. Files can be added whether or not the watcher is running.
+   * @param path the file to be watched
+   * @param parse the function re-parsing the file whenever it changes
+   */
+  void watch(const std::filesystem::path& path, ParseFunc parse);
+  /**
+   * Starts the watcher thread. Does nothing if the watcher is already running.
+   */
+  void start();
+  /**
+   * Stops the watcher thread and waits for it to finish. Changes that have already been parsed stay queued.
+   */
+  void stop();
+  /**
+   * Checks whether the watcher thread is running.
+   * @return <code>true</code> if the watcher is running, <code>false</code> otherwise
+   */
+  bool isRunning() const noexcept { return running; }
+  /**
+   * Applies all the queued changes. Called by the engine between two frames. If the watcher thread is busy queuing a
+   * change, the queue is left for the next frame rather than waiting for it.
+   */
+  void applyPending();
+
+ private:
+  struct WatchedFile {
+    std::filesystem::path path;
+    ParseFunc parse;
+    size_t contentHash;  // hash of the last parsed contents, used to skip writes that didn't change anything
+    std::filesystem::file_time_type writeTime;  // last seen modification time (polling fallback)
+    int watchDescriptor;  // inotify watch on the file's directory
+  };
+  /**
+   * Checks whether the file contents changed since the last parse and re-parses it if so.
+   * @param file the watched file
+   */
+  void reparse(WatchedFile& file);
+  /**
+   * Adds an inotify watch on the file's directory. Does nothing on platforms without inotify.
+   * @param file the watched file
+   */
+  void addSystemWatch(WatchedFile& file);
+  void threadMain();
+  void pollChanges();
+
+  std::vector<WatchedFile> files{};
+  std::mutex filesMutex{};  // guards files
+  std::vector<ApplyFunc> pending{};
+  std::mutex pendingMutex{};  // guards pending
+  std::thread thread{};
+  std::atomic<bool> running{false};
+  std::mutex wakeMutex{};
+  std::condition_variable wakeCondition{};  // wakes up the polling fallback when stopping
+  int inotifyFd{-1};
+  int wakePipe[2]{-1, -1};  // wakes up the inotify thread when stopping
+};
+}  // namespace config
@@ -0,0 +1,120 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "ecs/archetype.hpp"
+
+#include <algorithm>
+
+namespace ecs {
+namespace {
+constexpr size_t CACHE_LINE = 64;
+
+size_t alignUp(size_t value, size_t align) { return (value + align - 1) / align * align; }
+}  // namespace
+
+Archetype::Archetype(ComponentMask mask) : mask{mask} {
+  chunkAlign = std::max(CACHE_LINE, alignof(Entity));
+  size_t rowBytes = sizeof(Entity);
+  for (ComponentId id = 0; id < MAX_COMPONENTS; ++id) {
+    if (!(mask & (ComponentMask{1} << id))) continue;
+    components.push_back(id);
+    rowBytes += ComponentRegistry::get(id).size;
+    chunkAlign = std::max(chunkAlign, ComponentRegistry::get(id).align);
+  }
+  // start from the rows that would fit without padding and drop rows until the padded layout fits too
+  capacity = std::max<size_t>(1, CHUNK_BYTES / rowBytes);
+  while (capacity > 1 && layout(capacity) > CHUNK_BYTES) --capacity;
+  chunkBytes = alignUp(std::max(CHUNK_BYTES, layout(capacity)), chunkAlign);
+}
+
+Archetype::~Archetype() {
+  for (size_t row = 0; row < count; ++row) {
+    for (ComponentId id : components) ComponentRegistry::get(id).destroy(getComponent(row, id));
+  }
+}
+
+size_t Archetype::layout(size_t rows) {
+  size_t bytes = rows * sizeof(Entity);
+  for (ComponentId id : components) {
+    const ComponentInfo& info = ComponentRegistry::get(id);
+    // align every array on a cache line so that the arrays of one chunk don't share lines
+    bytes = alignUp(bytes, std::max(info.align, CACHE_LINE));
+    offsets[id] = bytes;
+    bytes += rows * info.size;
+  }
+  return bytes;
+}
+
+size_t Archetype::allocate(Entity entity) {
+  const size_t row = count++;
+  if (row / capacity >= chunks.size()) {
+    auto* bytes = static_cast<std::byte*>(::operator new(chunkBytes, std::align_val_t{chunkAlign}));
+    chunks.emplace_back(bytes, ChunkDeleter{chunkAlign});
+  }
+  getEntities(row / capacity)[row % capacity] = entity;
+  return row;
+}
+
+Entity Archetype::remove(size_t row) {
+  for (ComponentId id : components) ComponentRegistry::get(id).destroy(getComponent(row, id));
+  return fill(row);
+}
+
+Entity Archetype::moveTo(size_t row, Archetype& destination, size_t destinationRow) {
+  for (ComponentId id : components) {
+    if (destination.mask & (ComponentMask{1} << id)) {
+      ComponentRegistry::get(id).relocate(destination.getComponent(destinationRow, id), getComponent(row, id));
+    } else {
+      ComponentRegistry::get(id).destroy(getComponent(row, id));
+    }
+  }
+  return fill(row);
+}
+
+Entity Archetype::fill(size_t row) {
+  const size_t last = --count;
+  Entity moved{};
+  if (row != last) {
+    for (ComponentId id : components) {
+      ComponentRegistry::get(id).relocate(getComponent(row, id), getComponent(last, id));
+    }
+    moved = getEntities(last / capacity)[last % capacity];
+    getEntities(row / capacity)[row % capacity] = moved;
+  }
+  shrink();
+  return moved;
+}
+
+void Archetype::shrink() {
+  const size_t used = getChunkCount();
+  if (chunks.size() > used + 1) chunks.resize(used + 1);
+}
+}  // namespace ecs
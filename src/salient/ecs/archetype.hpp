@@ -0,0 +1,159 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "ecs/component.hpp"
+
+namespace ecs {
+/**
+ * The entities sharing one set of component types. They are stored in fixed size chunks, with one array per component
+ * type in each chunk, so that a query walks over contiguous arrays of the components it reads. The chunks are kept
+ * dense: all of them are full except the last one.
+ */
+class Archetype {
+ public:
+  /**
+   * The preferred size of a chunk, in bytes. Chunks only get bigger when a single entity doesn't fit.
+   */
+  static constexpr size_t CHUNK_BYTES = 16384;
+  /**
+   * Creates an empty archetype.
+   * @param mask the component types of the archetype's entities
+   */
+  explicit Archetype(ComponentMask mask);
+  ~Archetype();
+  Archetype(const Archetype&) = delete;
+  Archetype& operator=(const Archetype&) = delete;
+  /**
+   * Adds a row for an entity. Its components are left unconstructed: the caller must construct all of them.
+   * @param entity the entity
+   * @return the entity's row
+   */
+  size_t allocate(Entity entity);
+  /**
+   * Destroys the components of a row and moves the last row into it.
+   * @param row the row to remove
+   * @return the entity moved into the row, or an invalid entity if the removed row was the last one
+   */
+  Entity remove(size_t row);
+  /**
+   * Moves the components of a row into a row of another archetype, destroying those the other archetype doesn't have,
+   * then moves the last row into the freed one. The destination's components that this archetype doesn't have are left
+   * unconstructed.
+   * @param row the row to move
+   * @param destination the archetype to move the row to
+   * @param destinationRow the row of the destination archetype, as returned by <code>allocate()</code>
+   * @return the entity moved into the freed row, or an invalid entity if the moved row was the last one
+   */
+  Entity moveTo(size_t row, Archetype& destination, size_t destinationRow);
+  /**
+   * Gets a component of a row.
+   * @param row the row
+   * @param id the component type, which must be part of the archetype
+   * @return the component
+   */
+  void* getComponent(size_t row, ComponentId id) {
+    return getColumnData(row / capacity, id) + (row % capacity) * ComponentRegistry::get(id).size;
+  }
+  /**
+   * Gets the array of a component type in a chunk.
+   * @tparam T the component type, which must be part of the archetype
+   * @param chunk the chunk index
+   * @return the first component of the chunk
+   */
+  template <class T>
+  T* getColumn(size_t chunk) {
+    return reinterpret_cast<T*>(getColumnData(chunk, componentId<T>()));
+  }
+  /**
+   * Gets the entities stored in a chunk.
+   * @param chunk the chunk index
+   * @return the first entity of the chunk
+   */
+  Entity* getEntities(size_t chunk) { return reinterpret_cast<Entity*>(chunks[chunk].get()); }
+  /**
+   * Gets the number of rows used in a chunk.
+   * @param chunk the chunk index
+   * @return the number of rows
+   */
+  size_t getRowCount(size_t chunk) const {
+    const size_t first = chunk * capacity;
+    return count > first ? std::min(capacity, count - first) : 0;
+  }
+  size_t getChunkCount() const { return (count + capacity - 1) / capacity; }
+  size_t getCount() const { return count; }
+  ComponentMask getMask() const { return mask; }
+  /**
+   * The archetypes reached by adding or removing one component type, filled lazily by the world.
+   */
+  std::array<Archetype*, MAX_COMPONENTS> addEdges{};
+  std::array<Archetype*, MAX_COMPONENTS> removeEdges{};
+
+ private:
+  struct ChunkDeleter {
+    size_t align;
+    void operator()(std::byte* chunk) const { ::operator delete(chunk, std::align_val_t{align}); }
+  };
+  using Chunk = std::unique_ptr<std::byte[], ChunkDeleter>;
+  std::byte* getColumnData(size_t chunk, ComponentId id) { return chunks[chunk].get() + offsets[id]; }
+  /**
+   * Lays the chunk out for a number of rows.
+   * @param rows the number of rows
+   * @return the number of bytes used
+   */
+  size_t layout(size_t rows);
+  /**
+   * Moves the last row into a row whose components have been destroyed or moved out.
+   * @param row the freed row
+   * @return the entity moved into the row, or an invalid entity if the freed row was the last one
+   */
+  Entity fill(size_t row);
+  /**
+   * Frees the chunks past the last used one, keeping one spare to avoid reallocating on every add and remove.
+   */
+  void shrink();
+  ComponentMask mask{};
+  std::vector<ComponentId> components{};  // the archetype's component types, in ID order
+  std::array<size_t, MAX_COMPONENTS> offsets{};  // the offset of each component type's array in a chunk
+  std::vector<Chunk> chunks{};
+  size_t capacity{};  // rows per chunk
+  size_t chunkBytes{};
+  size_t chunkAlign{alignof(std::max_align_t)};
+  size_t count{};  // rows used in all chunks
+};
+}  // namespace ecs
@@ -0,0 +1,123 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace ecs {
+/**
+ * The maximum number of component types. Archetypes are identified by a bit mask of their component types.
+ */
+constexpr size_t MAX_COMPONENTS = 64;
+using ComponentId = uint32_t;
+using ComponentMask = uint64_t;
+
+/**
+ * An entity handle. The generation tells a destroyed entity from a newer one reusing its index.
+ */
+struct Entity {
+  uint32_t index{std::numeric_limits<uint32_t>::max()};
+  uint32_t generation{0};
+  friend bool operator==(const Entity& a, const Entity& b) {
+    return a.index == b.index && a.generation == b.generation;
+  }
+  friend bool operator!=(const Entity& a, const Entity& b) { return !(a == b); }
+};
+
+/**
+ * How a component type is laid out and handled in the archetype chunks.
+ */
+struct ComponentInfo {
+  size_t size{};
+  size_t align{};
+  void (*relocate)(void* destination, void* source){};  // move constructs the destination and destroys the source
+  void (*destroy)(void* component){};
+};
+
+/**
+ * The registry of component types. Each type gets its ID the first time it is used.
+ */
+class ComponentRegistry {
+ public:
+  /**
+   * Registers a component type. Registering more than <code>MAX_COMPONENTS</code> types is a fatal error.
+   * @param info the component type's layout and handlers
+   * @return the component type's ID
+   */
+  static ComponentId add(const ComponentInfo& info);
+  static const ComponentInfo& get(ComponentId id) { return infos[id]; }
+
+ private:
+  static std::array<ComponentInfo, MAX_COMPONENTS> infos;
+  static std::atomic<uint32_t> count;
+};
+
+/**
+ * Gets the ID of a component type, registering it the first time.
+ * @tparam T the component type
+ * @return the component type's ID
+ */
+template <class T>
+ComponentId componentId() {
+  if constexpr (!std::is_same_v<T, std::remove_cv_t<T>>) {
+    return componentId<std::remove_cv_t<T>>();
+  } else {
+    static_assert(std::is_move_constructible_v<T>, "components must be move constructible");
+    static const ComponentId id = ComponentRegistry::add(ComponentInfo{
+        sizeof(T),
+        alignof(T),
+        [](void* destination, void* source) {
+          new (destination) T(std::move(*static_cast<T*>(source)));
+          static_cast<T*>(source)->~T();
+        },
+        [](void* component) { static_cast<T*>(component)->~T(); }});
+    return id;
+  }
+}
+
+/**
+ * Gets the mask of a set of component types. <code>const</code> qualifiers are ignored.
+ * @tparam Ts the component types
+ * @return the mask
+ */
+template <class... Ts>
+ComponentMask componentMask() {
+  return (ComponentMask{0} | ... | (ComponentMask{1} << componentId<Ts>()));
+}
+}  // namespace ecs
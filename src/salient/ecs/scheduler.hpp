@@ -0,0 +1,113 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+#include "ecs/world.hpp"
+#include "jobs/pool.hpp"
+
+namespace ecs {
+/**
+ * The component types a system reads and writes.
+ */
+struct SystemAccess {
+  ComponentMask reads{};
+  ComponentMask writes{};
+  /**
+   * Whether the system touches state outside of the world, such as a console. Exclusive systems never run alongside
+   * other systems.
+   */
+  bool exclusive{false};
+  /**
+   * Checks whether two systems may not run at the same time.
+   * @param other the other system's access
+   * @return <code>true</code> if either system is exclusive or writes a component type the other one uses,
+   * <code>false</code> otherwise
+   */
+  bool conflicts(const SystemAccess& other) const {
+    return exclusive || other.exclusive || (writes & (other.reads | other.writes)) || (reads & other.writes);
+  }
+};
+
+/**
+ * Builds the access of a system from the component types it queries: <code>const</code> types are read, the others
+ * are written.
+ * @tparam Ts the component types
+ * @return the access
+ */
+template <class... Ts>
+SystemAccess access() {
+  SystemAccess result{};
+  (((std::is_const_v<Ts> ? result.reads : result.writes) |= componentMask<Ts>()), ...);
+  return result;
+}
+
+/**
+ * Runs systems over a world. Systems are grouped into batches: the systems of a batch run in parallel on the job pool,
+ * and the batches run one after the other. A system is put in the batch following the last one holding an earlier
+ * system it conflicts with, so conflicting systems always run in the order they were added.
+ */
+class Scheduler {
+ public:
+  /**
+   * A system, called with the world and the time elapsed since the last frame, in seconds. It may make structural
+   * changes through the world's command buffer only.
+   */
+  using System = std::function<void(World&, float)>;
+  /**
+   * Adds a system.
+   * @param access the component types the system reads and writes
+   * @param system the system
+   */
+  void add(const SystemAccess& access, System system);
+  /**
+   * Runs all the systems.
+   * @param world the world
+   * @param pool the job pool running the systems of a batch in parallel
+   * @param elapsed the time elapsed since the last frame, in seconds
+   */
+  void run(World& world, jobs::JobPool& pool, float elapsed);
+  size_t getBatchCount() const { return batches.size(); }
+
+ private:
+  struct Entry {
+    SystemAccess access{};
+    System system{};
+    size_t batch{};
+  };
+  std::vector<Entry> systems{};
+  std::vector<std::vector<size_t>> batches{};  // the indices of the systems of each batch
+};
+}  // namespace ecs
@@ -0,0 +1,115 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "ecs/world.hpp"
+
+namespace ecs {
+void CommandBuffer::destroy(Entity entity) {
+  push([entity](World& world) { world.destroy(entity); });
+}
+
+void CommandBuffer::push(std::function<void(World&)> command) {
+  std::lock_guard<std::mutex> lock{mutex};
+  commands.push_back(std::move(command));
+}
+
+std::vector<std::function<void(World&)>> CommandBuffer::take() {
+  std::vector<std::function<void(World&)>> taken{};
+  std::lock_guard<std::mutex> lock{mutex};
+  taken.swap(commands);
+  return taken;
+}
+
+World::World() = default;
+
+World::~World() = default;
+
+void World::destroy(Entity entity) {
+  if (!isAlive(entity)) return;
+  Record& record = records[entity.index];
+  const Entity moved = record.archetype->remove(record.row);
+  if (moved.index != Entity{}.index) records[moved.index].row = record.row;
+  record.archetype = nullptr;
+  ++record.generation;
+  freeIndices.push_back(entity.index);
+  --entityCount;
+}
+
+void World::flush() {
+  for (auto pending = commands.take(); !pending.empty(); pending = commands.take()) {
+    for (auto& command : pending) command(*this);
+  }
+}
+
+Archetype* World::getArchetype(ComponentMask mask) {
+  auto found = archetypesByMask.find(mask);
+  if (found != archetypesByMask.end()) return found->second;
+  Archetype* archetype = archetypes.emplace_back(std::make_unique<Archetype>(mask)).get();
+  archetypesByMask.emplace(mask, archetype);
+  std::lock_guard<std::mutex> lock{queryMutex};
+  for (auto& [queried, matches] : queries) {
+    if ((mask & queried) == queried) matches.push_back(archetype);
+  }
+  return archetype;
+}
+
+const std::vector<Archetype*>& World::query(ComponentMask mask) {
+  std::lock_guard<std::mutex> lock{queryMutex};
+  auto [found, added] = queries.try_emplace(mask);
+  if (added) {
+    for (auto& archetype : archetypes) {
+      if ((archetype->getMask() & mask) == mask) found->second.push_back(archetype.get());
+    }
+  }
+  return found->second;
+}
+
+Entity World::allocateEntity() {
+  ++entityCount;
+  if (freeIndices.empty()) {
+    records.emplace_back();
+    return Entity{static_cast<uint32_t>(records.size() - 1), 0};
+  }
+  const uint32_t index = freeIndices.back();
+  freeIndices.pop_back();
+  return Entity{index, records[index].generation};
+}
+
+size_t World::move(Entity entity, Archetype& target) {
+  Record& record = records[entity.index];
+  const size_t row = target.allocate(entity);
+  const Entity moved = record.archetype->moveTo(record.row, target, row);
+  if (moved.index != Entity{}.index) records[moved.index].row = record.row;
+  record.archetype = &target;
+  record.row = row;
+  return row;
+}
+}  // namespace ecs
@@ -0,0 +1,314 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ecs/archetype.hpp"
+#include "jobs/pool.hpp"
+
+namespace ecs {
+class World;
+
+/**
+ * Structural changes (creating and destroying entities, adding and removing components) recorded while the world is
+ * being iterated, and applied in order by <code>World::flush()</code>. Recording is thread safe. The recorded
+ * components are copied, so they must be copy constructible.
+ */
+class CommandBuffer {
+  friend class World;
+
+ public:
+  /**
+   * Records the creation of an entity.
+   * @param components the entity's components
+   */
+  template <class... Ts>
+  void create(Ts... components);
+  /**
+   * Records the destruction of an entity. Entities destroyed in the meantime are ignored.
+   * @param entity the entity
+   */
+  void destroy(Entity entity);
+  /**
+   * Records adding a component to an entity, or replacing it if the entity already has one.
+   * @param entity the entity
+   * @param component the component
+   */
+  template <class T>
+  void add(Entity entity, T component);
+  /**
+   * Records removing a component from an entity.
+   * @tparam T the component type
+   * @param entity the entity
+   */
+  template <class T>
+  void remove(Entity entity);
+  /**
+   * Records an arbitrary change.
+   * @param command the change, applied to the world
+   */
+  void push(std::function<void(World&)> command);
+
+ private:
+  std::vector<std::function<void(World&)>> take();
+  std::mutex mutex{};
+  std::vector<std::function<void(World&)>> commands{};
+};
+
+/**
+ * A set of entities and their components. The entities sharing the same component types are stored together in an
+ * archetype, and queries walk over the archetypes holding the queried components.<br>Structural changes must not be
+ * made while iterating: they move entities between archetypes. Record them in the command buffer instead, and they
+ * will be applied by <code>flush()</code>. Components may be read and written from several threads as long as no two
+ * threads write the same component type, which is what <code>Scheduler</code> ensures.
+ */
+class World {
+ public:
+  World();
+  ~World();
+  World(const World&) = delete;
+  World& operator=(const World&) = delete;
+  /**
+   * Creates an entity.
+   * @param components the entity's components, of distinct types
+   * @return the entity
+   */
+  template <class... Ts>
+  Entity create(Ts... components) {
+    Archetype* archetype = getArchetype(componentMask<Ts...>());
+    const Entity entity = allocateEntity();
+    const size_t row = archetype->allocate(entity);
+    (new (archetype->getComponent(row, componentId<Ts>())) Ts(std::move(components)), ...);
+    records[entity.index].archetype = archetype;
+    records[entity.index].row = row;
+    return entity;
+  }
+  /**
+   * Destroys an entity and its components. Destroying a dead entity does nothing.
+   * @param entity the entity
+   */
+  void destroy(Entity entity);
+  /**
+   * Checks whether an entity exists.
+   * @param entity the entity
+   * @return <code>true</code> if the entity has been created and not destroyed since, <code>false</code> otherwise
+   */
+  bool isAlive(Entity entity) const {
+    return entity.index < records.size() && records[entity.index].generation == entity.generation &&
+           records[entity.index].archetype;
+  }
+  /**
+   * Checks whether an entity has a component.
+   * @tparam T the component type
+   * @param entity the entity
+   * @return <code>true</code> if the entity is alive and has the component, <code>false</code> otherwise
+   */
+  template <class T>
+  bool has(Entity entity) const {
+    return isAlive(entity) && (records[entity.index].archetype->getMask() & componentMask<T>());
+  }
+  /**
+   * Gets a component of an entity. The pointer is invalidated by the next structural change.
+   * @tparam T the component type
+   * @param entity the entity
+   * @return the component, or <code>nullptr</code> if the entity is dead or doesn't have it
+   */
+  template <class T>
+  T* get(Entity entity) {
+    if (!has<T>(entity)) return nullptr;
+    const Record& record = records[entity.index];
+    return static_cast<T*>(record.archetype->getComponent(record.row, componentId<T>()));
+  }
+  /**
+   * Adds a component to an entity, or replaces it if the entity already has one. Adding to a dead entity does nothing.
+   * @param entity the entity
+   * @param component the component
+   * @return the entity's component, or <code>nullptr</code> if the entity is dead
+   */
+  template <class T>
+  T* add(Entity entity, T component) {
+    if (!isAlive(entity)) return nullptr;
+    if (T* existing = get<T>(entity)) {
+      *existing = std::move(component);
+      return existing;
+    }
+    const ComponentId id = componentId<T>();
+    Archetype* source = records[entity.index].archetype;
+    Archetype*& target = source->addEdges[id];
+    if (!target) target = getArchetype(source->getMask() | componentMask<T>());
+    const size_t row = move(entity, *target);
+    return new (target->getComponent(row, id)) T(std::move(component));
+  }
+  /**
+   * Removes a component from an entity. Removing a component the entity doesn't have does nothing.
+   * @tparam T the component type
+   * @param entity the entity
+   */
+  template <class T>
+  void remove(Entity entity) {
+    if (!has<T>(entity)) return;
+    const ComponentId id = componentId<T>();
+    Archetype* source = records[entity.index].archetype;
+    Archetype*& target = source->removeEdges[id];
+    if (!target) target = getArchetype(source->getMask() & ~componentMask<T>());
+    move(entity, *target);
+  }
+  /**
+   * Calls a function on every entity having a set of components, as <code>f(components...)</code> or
+   * <code>f(entity, components...)</code>. Components queried as <code>const</code> are passed as
+   * <code>const</code> references.
+   * @tparam Ts the component types
+   * @param f the function
+   */
+  template <class... Ts, class F>
+  void each(F&& f) {
+    for (Archetype* archetype : query(componentMask<Ts...>())) {
+      for (size_t chunk = 0; chunk < archetype->getChunkCount(); ++chunk) eachRow<Ts...>(*archetype, chunk, f);
+    }
+  }
+  /**
+   * Calls a function on every entity having a set of components, like <code>each()</code>, spreading the archetype
+   * chunks across the job pool.
+   * @tparam Ts the component types
+   * @param pool the job pool
+   * @param f the function, called concurrently
+   */
+  template <class... Ts, class F>
+  void parallelEach(jobs::JobPool& pool, F&& f) {
+    std::vector<std::pair<Archetype*, size_t>> chunks{};
+    for (Archetype* archetype : query(componentMask<Ts...>())) {
+      for (size_t chunk = 0; chunk < archetype->getChunkCount(); ++chunk) chunks.emplace_back(archetype, chunk);
+    }
+    pool.parallelFor(chunks.size(), [&](size_t i) { eachRow<Ts...>(*chunks[i].first, chunks[i].second, f); });
+  }
+  /**
+   * Calls a function on every archetype chunk holding entities with a set of components, as
+   * <code>f(count, entities, components...)</code>, where each component argument points to the chunk's array of that
+   * component.
+   * @tparam Ts the component types
+   * @param f the function
+   */
+  template <class... Ts, class F>
+  void eachChunk(F&& f) {
+    for (Archetype* archetype : query(componentMask<Ts...>())) {
+      for (size_t chunk = 0; chunk < archetype->getChunkCount(); ++chunk) {
+        f(archetype->getRowCount(chunk), const_cast<const Entity*>(archetype->getEntities(chunk)),
+          archetype->getColumn<Ts>(chunk)...);
+      }
+    }
+  }
+  /**
+   * Gets the buffer recording the structural changes to apply at the next <code>flush()</code>.
+   * @return the command buffer
+   */
+  CommandBuffer& getCommands() { return commands; }
+  /**
+   * Applies the recorded structural changes, including those recorded while applying them.
+   */
+  void flush();
+  size_t getEntityCount() const { return entityCount; }
+  size_t getArchetypeCount() const { return archetypes.size(); }
+
+ private:
+  struct Record {
+    Archetype* archetype{};  // nullptr if the entity is dead
+    size_t row{};
+    uint32_t generation{};
+  };
+  template <class... Ts, class F>
+  static void eachRow(Archetype& archetype, size_t chunk, F& f) {
+    const size_t rows = archetype.getRowCount(chunk);
+    const Entity* entities = archetype.getEntities(chunk);
+    auto columns = std::make_tuple(archetype.getColumn<Ts>(chunk)...);
+    for (size_t row = 0; row < rows; ++row) {
+      if constexpr (std::is_invocable_v<F&, Entity, Ts&...>) {
+        std::apply([&](auto*... column) { f(entities[row], column[row]...); }, columns);
+      } else {
+        std::apply([&](auto*... column) { f(column[row]...); }, columns);
+      }
+    }
+  }
+  /**
+   * Finds the archetype of a set of components, creating it if needed.
+   * @param mask the component types
+   * @return the archetype
+   */
+  Archetype* getArchetype(ComponentMask mask);
+  /**
+   * Finds the archetypes holding a set of components. The result is cached and kept up to date as archetypes are
+   * created.
+   * @param mask the component types
+   * @return the archetypes
+   */
+  const std::vector<Archetype*>& query(ComponentMask mask);
+  Entity allocateEntity();
+  /**
+   * Moves an entity to another archetype, leaving the components it didn't have unconstructed.
+   * @param entity the entity
+   * @param target the archetype
+   * @return the entity's row in the archetype
+   */
+  size_t move(Entity entity, Archetype& target);
+  std::vector<std::unique_ptr<Archetype>> archetypes{};
+  std::unordered_map<ComponentMask, Archetype*> archetypesByMask{};
+  std::unordered_map<ComponentMask, std::vector<Archetype*>> queries{};
+  std::mutex queryMutex{};  // queries may be made by systems running in parallel
+  std::vector<Record> records{};
+  std::vector<uint32_t> freeIndices{};
+  size_t entityCount{};
+  CommandBuffer commands{};
+};
+
+template <class... Ts>
+void CommandBuffer::create(Ts... components) {
+  push([components...](World& world) { world.create(components...); });
+}
+
+template <class T>
+void CommandBuffer::add(Entity entity, T component) {
+  push([entity, component](World& world) { world.add(entity, component); });
+}
+
+template <class T>
+void CommandBuffer::remove(Entity entity) {
+  push([entity](World& world) { world.remove<T>(entity); });
+}
+}  // namespace ecs
@@ -0,0 +1,82 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include "ecs/scheduler.hpp"
+#include "ecs/world.hpp"
+#include "module/module.hpp"
+
+namespace ecs {
+/**
+ * A module hosting a world. Its update systems run in <code>update()</code> and its render systems in
+ * <code>render()</code> or <code>renderLayer()</code>, and the structural changes they record are applied after each
+ * of them.
+ */
+class WorldModule : public module::Module {
+ public:
+  using module::Module::Module;
+  bool update() override;
+  void render() override;
+  void renderLayer(TCODConsole& layer) override;
+  void onEvent(const SDL_Event&) override {}
+  World& getWorld() { return world; }
+  /**
+   * Gets the systems run on every update.
+   * @return the update scheduler
+   */
+  Scheduler& getUpdateSystems() { return updateSystems; }
+  /**
+   * Gets the systems run on every render. They draw on the console returned by <code>getTarget()</code>.
+   * @return the render scheduler
+   */
+  Scheduler& getRenderSystems() { return renderSystems; }
+  /**
+   * Gets the console being rendered on: the root console in <code>render()</code>, the module's layer in
+   * <code>renderLayer()</code>.
+   * @return the console, or <code>nullptr</code> outside of rendering
+   */
+  TCODConsole* getTarget() { return target; }
+
+ protected:
+  World world{};
+  Scheduler updateSystems{};
+  Scheduler renderSystems{};
+
+ private:
+  /**
+   * Runs the render systems on a console.
+   * @param console the console to draw on
+   */
+  void renderTo(TCODConsole& console);
+  TCODConsole* target{};
+};
+}  // namespace ecs
@@ -33,14 +33,19 @@
 
 #include <SDL_events.h>
 #include <SDL_timer.h>
+#include <SDL_video.h>
 #include <fmt/core.h>
 #include <stdarg.h>
 #include <stdio.h>
 
 #include <cassert>
+#include <cstdio>
+#include <cstring>
 #include <filesystem>
 #include <iostream>
 #include <libtcod/libtcod.hpp>
+#include <memory>
+#include <optional>
 #include <vector>
 
 #include "base/font.hpp"
@@ -55,6 +60,21 @@ namespace engine {
 TCOD_renderer_t Engine::renderer = TCOD_RENDERER_SDL2;
 Engine* Engine::engineInstance = NULL;
 
+// a custom parameter, as read from the module configuration file
+struct ModuleParameterSpec {
+  std::string name;
+  TCOD_value_type_t type;
+  TCOD_value_t value;
+  std::string text;  // copy of the value of string parameters
+};
+
+// sets a module parameter from its configuration file declaration
+static void setParameter(module::Module* mod, const ModuleParameterSpec& spec) {
+  TCOD_value_t value = spec.value;
+  if (spec.type == TCOD_TYPE_STRING) value.s = const_cast<char*>(spec.text.c_str());
+  mod->setParameter(spec.name, spec.type, value);
+}
+
 // specific parser for module.txt file
 class UmbraModuleConfigParser : public ITCODParserListener {
  private:
@@ -71,7 +91,7 @@ class UmbraModuleConfigParser : public ITCODParserListener {
   // module to activate
   std::vector<module::Module*> toActivate;
   // custom parameters defined at the module chain level
-  std::vector<module::Module::ModuleParameter> chain_parameters_;
+  std::vector<ModuleParameterSpec> chain_parameters_;
   // all the modules in the chain
   std::vector<module::Module*> chainModules;
 
@@ -114,7 +134,7 @@ class UmbraModuleConfigParser : public ITCODParserListener {
     }
     return true;
   }
-  bool parserProperty(TCODParser*, const char* name, TCOD_value_type_t, TCOD_value_t value) {
+  bool parserProperty(TCODParser*, const char* name, TCOD_value_type_t type, TCOD_value_t value) {
     if (skip) return true;
     if (strcmp(name, "timeout") == 0) {
       module->setTimeout(value.i);
@@ -140,10 +160,11 @@ class UmbraModuleConfigParser : public ITCODParserListener {
       // dynamically declared property.
       if (module) {
         // at module level
-        module->setParameter(name, value);
+        module->setParameter(name, type, value);
       } else {
         // at module chain level
-        chain_parameters_.emplace_back(module::Module::ModuleParameter{std::string{name}, value});
+        chain_parameters_.emplace_back(
+            ModuleParameterSpec{name, type, value, type == TCOD_TYPE_STRING && value.s ? value.s : ""});
       }
     }
     return true;
@@ -159,9 +180,8 @@ class UmbraModuleConfigParser : public ITCODParserListener {
           // inherits all chain parameters
           // those parameters can be overloaded in the module declaration
           for (const auto& chainParam : chain_parameters_) {
-            module::Module::ModuleParameter moduleParam = mod->getParameter(chainParam.name);
-            if (moduleParam.name.empty()) {
-              mod->setParameter(chainParam.name, chainParam.value);
+            if (!mod->hasParameter(chainParam.name)) {
+              setParameter(mod, chainParam);
             }  // else parameter overloaded by the module.
           }
         }
@@ -179,6 +199,106 @@ class UmbraModuleConfigParser : public ITCODParserListener {
   void error(const char* msg) override { logger::Log::error(fmt::format("UmbraModuleConfigParser | {}", msg)); }
 };
 
+// a module declaration, as read from the module configuration file
+struct ModuleSpec {
+  std::string name;
+  std::optional<int> priority;
+  std::optional<int> timeout;
+  std::string fallback;
+  std::vector<ModuleParameterSpec> parameters;
+};
+
+// a module chain, as read from the module configuration file
+struct ModuleChainSpec {
+  std::vector<ModuleSpec> modules;
+  std::vector<ModuleParameterSpec> parameters;  // chain level parameters
+  bool found{false};
+  std::string error;
+};
+
+// reads a module chain without touching the engine, so that it can run on the file watcher thread
+class ModuleChainReader : public ITCODParserListener {
+ public:
+  ModuleChainReader(ModuleChainSpec& chain, const std::string& chainName) : chain(chain), chainName(chainName) {}
+  bool parserNewStruct(TCODParser*, const TCODParserStruct* str, const char* name) override {
+    if (strcmp(str->getName(), "moduleChain") == 0) {
+      skip = chain.found || (!chainName.empty() && chainName != name);
+      if (!skip) chain.found = true;
+    } else if (strcmp(str->getName(), "module") == 0 && !skip) {
+      module = &chain.modules.emplace_back();
+      module->name = name;
+    }
+    return true;
+  }
+  // activation flags only matter when the chain is first loaded
+  bool parserFlag(TCODParser*, const char*) override { return true; }
+  bool parserProperty(TCODParser*, const char* name, TCOD_value_type_t type, TCOD_value_t value) override {
+    if (skip) return true;
+    if (module && strcmp(name, "timeout") == 0) {
+      module->timeout = value.i;
+    } else if (module && strcmp(name, "priority") == 0) {
+      module->priority = value.i;
+    } else if (module && strcmp(name, "fallback") == 0) {
+      module->fallback = value.s;
+    } else {
+      auto& parameters = module ? module->parameters : chain.parameters;
+      parameters.emplace_back(
+          ModuleParameterSpec{name, type, value, type == TCOD_TYPE_STRING && value.s ? value.s : ""});
+    }
+    return true;
+  }
+  bool parserEndStruct(TCODParser*, const TCODParserStruct* str, const char*) override {
+    if (strcmp(str->getName(), "module") == 0) module = nullptr;
+    return true;
+  }
+  void error(const char* msg) override { chain.error = msg; }
+
+ private:
+  ModuleChainSpec& chain;
+  const std::string& chainName;
+  ModuleSpec* module{};
+  bool skip{false};
+};
+
+// declares the structure of the module configuration file
+static void declareModuleConfigStructure(TCODParser& parser) {
+  TCODParserStruct* moduleChain = parser.newStructure("moduleChain");
+  TCODParserStruct* module = parser.newStructure("module");
+  moduleChain->addStructure(module);
+  module->addProperty("timeout", TCOD_TYPE_INT, false);
+  module->addProperty("priority", TCOD_TYPE_INT, false);
+  module->addProperty("fallback", TCOD_TYPE_STRING, false);
+  module->addFlag("active");
+}
+
+// compares a parameter read from the module configuration file with the one a module currently holds
+static bool isSameParameter(const ModuleParameterSpec& spec, module::Module* mod) {
+  if (!mod->hasParameter(spec.name)) return false;
+  const TCOD_value_t& current = mod->getParameter(spec.name);
+  switch (spec.type) {
+    case TCOD_TYPE_BOOL:
+      return spec.value.b == current.b;
+    case TCOD_TYPE_CHAR:
+      return spec.value.c == current.c;
+    case TCOD_TYPE_INT:
+      return spec.value.i == current.i;
+    case TCOD_TYPE_FLOAT:
+      return spec.value.f == current.f;
+    case TCOD_TYPE_STRING:
+      return current.s && spec.text == current.s;
+    case TCOD_TYPE_COLOR:
+      return spec.value.col.r == current.col.r && spec.value.col.g == current.col.g &&
+             spec.value.col.b == current.col.b;
+    case TCOD_TYPE_DICE:
+      return spec.value.dice.nb_rolls == current.dice.nb_rolls &&
+             spec.value.dice.nb_faces == current.dice.nb_faces &&
+             spec.value.dice.multiplier == current.dice.multiplier &&
+             spec.value.dice.addsub == current.dice.addsub;
+    default:
+      return false;
+  }
+}
+
 int Engine::onSDLEvent(void* userdata, SDL_Event* event) {
   auto self = static_cast<Engine*>(userdata);
   for (auto& module : self->activeModules) module->onEvent(*event);
@@ -292,8 +412,34 @@ struct TmpFontData {
   std::string name;
   int flags;
   int size;
+  int charWidth;
+  int charHeight;
+  bool valid;
 };
 
+// reads the image dimensions from the IHDR chunk of a PNG file, without decoding the image
+static bool readPngSize(const std::filesystem::path& path, int& width, int& height) {
+  static constexpr unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+  // signature, then the IHDR chunk: length, type, width, height
+  unsigned char header[24];
+  FILE* file = fopen(path.string().c_str(), "rb");
+  if (!file) return false;
+  const size_t read = fread(header, 1, sizeof(header), file);
+  fclose(file);
+  if (read != sizeof(header)) return false;
+  if (memcmp(header, signature, sizeof(signature)) != 0 || memcmp(header + 12, "IHDR", 4) != 0) return false;
+  const auto bigEndian = [](const unsigned char* bytes) {
+    return static_cast<uint32_t>(bytes[0]) << 24 | static_cast<uint32_t>(bytes[1]) << 16 |
+           static_cast<uint32_t>(bytes[2]) << 8 | static_cast<uint32_t>(bytes[3]);
+  };
+  const uint32_t w = bigEndian(header + 16);
+  const uint32_t h = bigEndian(header + 20);
+  if (w == 0 || h == 0 || w > INT32_MAX || h > INT32_MAX) return false;
+  width = static_cast<int>(w);
+  height = static_cast<int>(h);
+  return true;
+}
+
 bool Engine::registerFonts() {
   logger::Log::openBlock("Engine::registerFonts | Attempting to automatically register fonts.");
   // if fonts registered by the user, do nothing
@@ -333,18 +479,34 @@ bool Engine::registerFonts() {
       // default is TCOD |GREYSCALE
       fontFlag |= TCOD_FONT_LAYOUT_TCOD;
     }
-    // compute font grid size from image size & char size
     fontDataList.emplace_back();
     fontDataList.back().name = (getFontDir() / fontName).string();
-    TCODImage tmp(fontDataList.back().name.c_str());
-    int w = 0;
-    int h = 0;
-    tmp.getSize(&w, &h);
     fontDataList.back().size = charWidth * charHeight;
-    fontDataList.back().rows = h / charHeight;
-    fontDataList.back().columns = w / charWidth;
     fontDataList.back().flags = fontFlag;
+    fontDataList.back().charWidth = charWidth;
+    fontDataList.back().charHeight = charHeight;
   }
+  // compute font grid size from image size & char size. Only the PNG headers are read: the image of the font that is
+  // actually used gets decoded when it is activated
+  jobPool.parallelFor(fontDataList.size(), [&fontDataList](size_t i) {
+    TmpFontData& dat = fontDataList[i];
+    int w = 0;
+    int h = 0;
+    dat.valid = readPngSize(dat.name, w, h);
+    dat.rows = h / dat.charHeight;
+    dat.columns = w / dat.charWidth;
+  });
+  fontDataList.erase(
+      std::remove_if(
+          fontDataList.begin(),
+          fontDataList.end(),
+          [](const TmpFontData& dat) {
+            if (!dat.valid) {
+              logger::Log::warning("Engine::registerFonts | \"%s\" is not a valid PNG file.", dat.name);
+            }
+            return !dat.valid;
+          }),
+      fontDataList.end());
   // sort fonts by size
   std::sort(fontDataList.begin(), fontDataList.end(), [](auto& a, auto& b) { return a.size < b.size; });
   for (const auto& dat : fontDataList) {
@@ -393,17 +555,18 @@ bool Engine::loadModuleConfiguration(const char* filename, module::ModuleFactory
     return false;  // file doesn't exist
   }
   TCODParser parser;
-  TCODParserStruct* moduleChain = parser.newStructure("moduleChain");
-  TCODParserStruct* module = parser.newStructure("module");
-  moduleChain->addStructure(module);
-  module->addProperty("timeout", TCOD_TYPE_INT, false);
-  module->addProperty("priority", TCOD_TYPE_INT, false);
-  module->addProperty("fallback", TCOD_TYPE_STRING, false);
-  module->addFlag("active");
-  if (chainName == NULL && config::Config::moduleChain != NULL) {
-    parser.run(filename, new UmbraModuleConfigParser(factory, config::Config::moduleChain));
-  } else
+  declareModuleConfigStructure(parser);
+  if (chainName == NULL && config::Config::moduleChain != NULL && config::Config::moduleChain[0] != '\0') {
+    chainName = config::Config::moduleChain;
+  }
+  {
+    std::lock_guard lock{config::Config::parserMutex};
     parser.run(filename, new UmbraModuleConfigParser(factory, chainName));
+  }
+  // remember what has been loaded for hot reloading
+  moduleFactory = factory;
+  moduleConfigFile = filename;
+  moduleChainName = chainName ? chainName : "";
   logger::Log::closeBlock(logger::LOGRESULT_SUCCESS);
   return true;
 }
@@ -557,16 +720,11 @@ bool Engine::initialise(TCOD_renderer_t new_renderer) {
     Engine::renderer = new_renderer;
     config::Config::activateFont();
     // initialise console
-    TCODConsole::setCustomFont(
-        config::Config::font->filename(),
-        config::Config::font->flags(),
-        config::Config::font->columns(),
-        config::Config::font->rows());
+    const bool baked = loadFontTileset();
     TCODConsole::initRoot(
         getRootWidth(), getRootHeight(), windowTitle.c_str(), config::Config::fullScreen, new_renderer);
-
-    registerCustomCharacters();
-    TCODSystem::setFps(25);
+    finishFontTileset(baked);
+    TCODSystem::setFps(FRAME_RATE);
     TCODMouse::showCursor(true);
     if (TCODConsole::root != NULL)
       logger::Log::closeBlock(logger::LOGRESULT_SUCCESS);
@@ -589,6 +747,11 @@ int Engine::run() {
     return 1;
   }
 
+  if (config::Config::hotReload) {
+    watchConfigurationFiles();
+    fileWatcher.start();
+  }
+
   while (!TCODConsole::isWindowClosed()) {
     // execute only when paused
     if (paused) {
@@ -601,16 +764,20 @@ int Engine::run() {
         TCODSystem::checkForEvent(TCOD_EVENT_KEY_RELEASE | TCOD_EVENT_MOUSE_PRESS, &key, &mouse);
         keyboard(key);
       }
-      TCODConsole::root->flush();
+      flush();
       continue;  // don't update or render anything anew
     }
 
+    // apply the configuration files that changed on disk
+    fileWatcher.applyPending();
+
     // deactivate modules
     for (auto& mod : toDeactivate) {
       mod->setActive(false);
       auto found = std::find(activeModules.begin(), activeModules.end(), mod);
       if (found != activeModules.end()) {
         activeModules.erase(found);
+        if (mod->getTransition().type != module::TRANSITION_NONE) startTransition(mod->getTransition());
       } else {
         logger::Log::notice("Tried to deactive non active module: %s", mod->getName());
       }
@@ -627,32 +794,37 @@ int Engine::run() {
     if (activeModules.size() == 0) break;  // exit game
 
     // update all active modules
-    switch (keyboardMode) {
-      case KEYBOARD_WAIT:
-        TCODSystem::waitForEvent(TCOD_EVENT_KEY_PRESS | TCOD_EVENT_MOUSE, &key, &mouse, true);
-        break;
-      case KEYBOARD_WAIT_NOFLUSH:
-        TCODSystem::waitForEvent(TCOD_EVENT_KEY_PRESS | TCOD_EVENT_MOUSE, &key, &mouse, false);
-        break;
-      case KEYBOARD_PRESSED:
-        TCODSystem::checkForEvent(TCOD_EVENT_KEY_PRESS | TCOD_EVENT_MOUSE, &key, &mouse);
-        break;
-      case KEYBOARD_PRESSED_RELEASED:
-        TCODSystem::checkForEvent(TCOD_EVENT_KEY | TCOD_EVENT_MOUSE, &key, &mouse);
-        break;
-      case KEYBOARD_RELEASED:
-      default:
-        TCODSystem::checkForEvent(TCOD_EVENT_KEY_RELEASE | TCOD_EVENT_MOUSE, &key, &mouse);
-        break;
-      case KEYBOARD_SDL:
-        while (TCOD_event_t event_type = TCODSystem::checkForEvent(TCOD_EVENT_KEY | TCOD_EVENT_MOUSE, &key, &mouse)) {
-          for (auto& module : activeModules) {
-            if (module->getPause()) continue;
-            if (event_type & TCOD_EVENT_KEY) module->keyboard(key);
-            if (event_type & TCOD_EVENT_MOUSE) module->mouse(mouse);
+    if (terminal) {
+      mouse = TCOD_mouse_t{};
+      readTerminalKeys(key);
+    } else {
+      switch (keyboardMode) {
+        case KEYBOARD_WAIT:
+          TCODSystem::waitForEvent(TCOD_EVENT_KEY_PRESS | TCOD_EVENT_MOUSE, &key, &mouse, true);
+          break;
+        case KEYBOARD_WAIT_NOFLUSH:
+          TCODSystem::waitForEvent(TCOD_EVENT_KEY_PRESS | TCOD_EVENT_MOUSE, &key, &mouse, false);
+          break;
+        case KEYBOARD_PRESSED:
+          TCODSystem::checkForEvent(TCOD_EVENT_KEY_PRESS | TCOD_EVENT_MOUSE, &key, &mouse);
+          break;
+        case KEYBOARD_PRESSED_RELEASED:
+          TCODSystem::checkForEvent(TCOD_EVENT_KEY | TCOD_EVENT_MOUSE, &key, &mouse);
+          break;
+        case KEYBOARD_RELEASED:
+        default:
+          TCODSystem::checkForEvent(TCOD_EVENT_KEY_RELEASE | TCOD_EVENT_MOUSE, &key, &mouse);
+          break;
+        case KEYBOARD_SDL:
+          while (TCOD_event_t event_type = TCODSystem::checkForEvent(TCOD_EVENT_KEY | TCOD_EVENT_MOUSE, &key, &mouse)) {
+            for (auto& module : activeModules) {
+              if (module->getPause()) continue;
+              if (event_type & TCOD_EVENT_KEY) module->keyboard(key);
+              if (event_type & TCOD_EVENT_MOUSE) module->mouse(mouse);
+            }
           }
-        }
-        break;
+          break;
+      }
     }
     keyboard(key);
     uint32_t startTime = SDL_GetTicks();
@@ -675,6 +847,10 @@ int Engine::run() {
                   // deactivate module
                   module->setActive(false);
                   remove_this = true;
+                  // blend the last frame the module was in into the next ones
+                  if (module->getTransition().type != module::TRANSITION_NONE) {
+                    startTransition(module->getTransition());
+                  }
                   if (fallback != -1) {
                     // register fallback for activation
                     module::Module* fallbackModule = modules.at(fallback);
@@ -688,17 +864,29 @@ int Engine::run() {
     uint32_t updateTime = SDL_GetTicks() - startTime;
     TCODConsole::root->setDefaultBackground(TCODColor::black);
     TCODConsole::root->clear();
-    // render active modules by inverted priority order
-    for (auto module = activeModules.rbegin(); module != activeModules.rend(); ++module) {
-      (*module)->render();
-    }
+    // render active modules by inverted priority order, skipping the hidden ones
+    compositor.render(activeModules, jobPool);
+    effects.apply(*TCOD_sys_get_internal_console(), jobPool);
+    transition.apply(*TCOD_sys_get_internal_console(), jobPool);
     uint32_t renderTime = SDL_GetTicks() - startTime - updateTime;
     if (internalModules[INTERNAL_SPEEDOMETER]->getActive()) {
       ((imod::ModSpeed*)internalModules[INTERNAL_SPEEDOMETER])->setTimes(updateTime, renderTime);
+      ((imod::ModSpeed*)internalModules[INTERNAL_SPEEDOMETER])->setEffectTimes(effects.getTimings());
     }
+    // rasterise the glyphs that are about to be displayed for the first time
+    if (trueTypeFont) trueTypeFont->prepare(*TCOD_sys_get_internal_console(), jobPool);
     // flush the screen
-    TCODConsole::root->flush();
+    flush();
+    if (frameCapture.nextSequenceFrame()) {
+      render::Framebuffer frame = frameCapture.acquireFrame();
+      if (grabFrame(frame)) frameCapture.submitSequenceFrame(std::move(frame));
+    }
+    frameCapture.reportErrors();
+    if (streamServer.isRunning()) streamServer.submitFrame(*TCOD_sys_get_internal_console());
   }
+  stopCapture();
+  streamServer.stop();
+  fileWatcher.stop();
   config::Config::save();
   logger::Log::closeBlock(logger::LOGRESULT_SUCCESS);
   logger::Log::save();
@@ -728,21 +916,188 @@ void Engine::keyboard(TCOD_key_t& key) {
 void Engine::reinitialise(TCOD_renderer_t new_renderer) {
   logger::Log::openBlock("Engine::reinitialise | Reinitialising the root console.");
   TCOD_console_delete(nullptr);
-  TCODConsole::setCustomFont(
-      config::Config::font->filename(),
-      config::Config::font->flags(),
-      config::Config::font->columns(),
-      config::Config::font->rows());
+  const bool baked = loadFontTileset();
   Engine::renderer = new_renderer;
   TCODConsole::initRoot(
       getRootWidth(), getRootHeight(), windowTitle.c_str(), config::Config::fullScreen, this->renderer);
-  registerCustomCharacters();
+  finishFontTileset(baked);
   if (TCODConsole::root != NULL)
     logger::Log::closeBlock(logger::LOGRESULT_SUCCESS);
   else
     logger::Log::closeBlock(logger::LOGRESULT_FAILURE);
 }
 
+bool Engine::activateFont(int shift) {
+  if (!trueTypeFont) return config::Config::activateFont(shift);
+  if (shift == 0) return false;
+  return trueTypeFont->setPixelHeight(trueTypeFont->getPixelHeight() + (shift > 0 ? 2 : -2));
+}
+
+bool Engine::setTrueTypeFont(std::unique_ptr<base::TrueTypeFont> font) {
+  if (font && !font->isLoaded()) return false;
+  trueTypeFont = std::move(font);
+  if (TCODConsole::root != NULL) reconfigureRoot();
+  return true;
+}
+
+void Engine::setSoftwareRendering(bool enabled) {
+  if (enabled == (softwareRenderer != nullptr)) return;
+  softwareRenderer = enabled ? std::make_unique<render::SoftwareRenderer>() : nullptr;
+  logger::Log::info("Engine::setSoftwareRendering | Software rendering %s.", enabled ? "enabled" : "disabled");
+}
+
+void Engine::startTransition(const module::TransitionSettings& settings) {
+  transition.start(*TCOD_sys_get_internal_console(), settings);
+}
+
+void Engine::flush() {
+  if (terminal) {
+    terminal->render(*TCOD_sys_get_internal_console());
+    waitNextFrame();
+    return;
+  }
+  TCOD_Context* context = TCOD_sys_get_internal_context();
+  SDL_Renderer* sdlRenderer = context ? TCOD_context_get_sdl_renderer(context) : nullptr;
+  if (!softwareRenderer || !sdlRenderer) {
+    TCODConsole::root->flush();
+    return;
+  }
+  softwareRenderer->setTileset(TCOD_get_default_tileset());
+  softwareRenderer->render(*TCOD_sys_get_internal_console(), jobPool);
+  softwareRenderer->present(sdlRenderer);
+  waitNextFrame();
+}
+
+void Engine::waitNextFrame() {
+  // limit the frame rate the way libtcod's flush does
+  const uint32_t now = SDL_GetTicks();
+  if (now < nextFrameTicks) SDL_Delay(nextFrameTicks - now);
+  nextFrameTicks = std::max(now, nextFrameTicks) + 1000 / FRAME_RATE;
+}
+
+bool Engine::setTerminalOutput(bool enabled) {
+  if (enabled == (terminal != nullptr)) return true;
+  if (!enabled) {
+    terminal.reset();
+    logger::Log::info("Engine::setTerminalOutput | Drawing in the window.");
+    return true;
+  }
+  auto newTerminal = std::make_unique<render::Terminal>();
+  if (!newTerminal->open()) return false;
+  terminal = std::move(newTerminal);
+  logger::Log::info("Engine::setTerminalOutput | Drawing on the terminal.");
+  return true;
+}
+
+void Engine::readTerminalKeys(TCOD_key_t& key) {
+  const bool wait = keyboardMode == KEYBOARD_WAIT || keyboardMode == KEYBOARD_WAIT_NOFLUSH;
+  key = TCOD_key_t{};
+  TCOD_key_t event{};
+  for (;;) {
+    while (terminal->pollKey(event)) {
+      // terminals only report presses, each one is followed by a release
+      if (keyboardMode == KEYBOARD_SDL) {
+        for (auto& module : activeModules) {
+          if (!module->getPause()) module->keyboard(event);
+        }
+        key = event;
+      } else if (keyboardMode == KEYBOARD_PRESSED_RELEASED || event.pressed == (keyboardMode != KEYBOARD_RELEASED)) {
+        key = event;
+        return;
+      }
+    }
+    if (!wait || key.vk != TCODK_NONE) return;
+    SDL_Delay(1000 / FRAME_RATE);
+  }
+}
+
+bool Engine::grabFrame(render::Framebuffer& frame) {
+  if (softwareRenderer && !softwareRenderer->getFramebuffer().pixels.empty()) {
+    const render::Framebuffer& source = softwareRenderer->getFramebuffer();
+    frame.width = source.width;
+    frame.height = source.height;
+    frame.pixels.assign(source.pixels.begin(), source.pixels.end());
+    return true;
+  }
+  TCOD_Context* context = TCOD_sys_get_internal_context();
+  if (!context) return false;
+  int width = 0;
+  int height = 0;
+  if (TCOD_context_screen_capture(context, nullptr, &width, &height) < 0 || width <= 0 || height <= 0) return false;
+  frame.pixels.resize(static_cast<size_t>(width) * height);
+  if (TCOD_context_screen_capture(context, frame.pixels.data(), &width, &height) < 0) return false;
+  frame.width = width;
+  frame.height = height;
+  return true;
+}
+
+void Engine::saveScreenshot(std::filesystem::path filename) {
+  if (filename.empty()) {
+    // names are reserved here, as the files only appear once the encoder wrote them
+    for (; nextScreenshot < 1000; ++nextScreenshot) {
+      filename = fmt::format("screenshot{:03}.png", nextScreenshot);
+      if (!std::filesystem::exists(filename)) break;
+    }
+    ++nextScreenshot;
+  }
+  render::Framebuffer frame = frameCapture.acquireFrame();
+  if (!grabFrame(frame)) {
+    logger::Log::error("Engine::saveScreenshot | Could not capture the screen: %s", TCOD_get_error());
+    return;
+  }
+  logger::Log::info("Engine::saveScreenshot | Saving a screenshot to \"%s\".", filename.string());
+  frameCapture.saveScreenshot(std::move(frame), std::move(filename));
+}
+
+void Engine::startCapture(const std::filesystem::path& directory, int interval, render::CaptureFormat format) {
+  frameCapture.startSequence(directory, interval, format);
+}
+
+void Engine::reconfigureRoot() {
+  TCOD_Context* context = TCOD_sys_get_internal_context();
+  TCOD_Console* root = TCOD_sys_get_internal_console();
+  if (!context || !root) {
+    reinitialise(renderer);
+    return;
+  }
+  logger::Log::openBlock("Engine::reconfigureRoot | Reconfiguring the root console.");
+  // swap the tileset of the live context
+  const bool baked = loadFontTileset();
+  TCOD_Tileset* tileset = TCOD_get_default_tileset();
+  if (!tileset || TCOD_context_change_tileset(context, tileset) < 0) {
+    logger::Log::error("Engine::reconfigureRoot | Could not change the tileset: %s", TCOD_get_error());
+    logger::Log::closeBlock(logger::LOGRESULT_FAILURE);
+    return;
+  }
+  finishFontTileset(baked);
+  // resize the root console by swapping in the tiles of a console of the new size, so that libtcod keeps owning them
+  const bool resized = root->w != getRootWidth() || root->h != getRootHeight();
+  if (resized) {
+    TCOD_Console* replacement = TCOD_console_new(getRootWidth(), getRootHeight());
+    if (!replacement) {
+      logger::Log::error("Engine::reconfigureRoot | Could not resize the root console: %s", TCOD_get_error());
+      logger::Log::closeBlock(logger::LOGRESULT_FAILURE);
+      return;
+    }
+    std::swap(root->w, replacement->w);
+    std::swap(root->h, replacement->h);
+    std::swap(root->elements, replacement->elements);
+    std::swap(root->tiles, replacement->tiles);
+    TCOD_console_delete(replacement);
+    TCODConsole::root->clear();
+  }
+  // fit the window around the console, unless the screen size is imposed by full screen mode
+  SDL_Window* window = TCOD_context_get_sdl_window(context);
+  if (window && !TCODConsole::isFullscreen()) {
+    SDL_SetWindowSize(window, getRootWidth() * tileset->tile_width, getRootHeight() * tileset->tile_height);
+  }
+  if (resized) {
+    for (module::Module* mod : modules) mod->onResize(getRootWidth(), getRootHeight());
+    for (module::Module* mod : internalModules) mod->onResize(getRootWidth(), getRootHeight());
+  }
+  logger::Log::closeBlock(logger::LOGRESULT_SUCCESS);
+}
+
 void Engine::registerInternalModule(InternalModuleID id, module::Module* module) {
   logger::Log::info("Engine::registerInternalModule | Registering an internal module.");
   internalModules[id] = module;
@@ -770,4 +1125,183 @@ void Engine::registerCustomCharacters() {
 
   logger::Log::info("Engine::registerCustomCharacters | Custom character mappings registered.");
 }
+
+// hash of the custom character mappings, part of the baked tileset's key
+static uint64_t hashCustomCharacters(const std::vector<CustomCharMap>& customChars) {
+  uint64_t hash = 14695981039346656037ull;  // FNV-1a
+  for (const CustomCharMap& map : customChars) {
+    for (int value : {map.x, map.y, map.code}) {
+      hash = (hash ^ static_cast<uint32_t>(value)) * 1099511628211ull;
+    }
+  }
+  return hash;
+}
+
+bool Engine::loadFontTileset() {
+  if (trueTypeFont) {
+    // glyphs are looked up by code point: there are no custom character mappings to apply
+    TCOD_set_default_tileset(trueTypeFont->getTileset());
+    return true;
+  }
+  if (tilesetCache.load(*config::Config::font, hashCustomCharacters(customChars))) return true;
+  TCODConsole::setCustomFont(
+      config::Config::font->filename(),
+      config::Config::font->flags(),
+      config::Config::font->columns(),
+      config::Config::font->rows());
+  return false;
+}
+
+void Engine::finishFontTileset(bool baked) {
+  if (baked || TCODConsole::root == NULL) return;
+  registerCustomCharacters();
+  tilesetCache.store(*config::Config::font, hashCustomCharacters(customChars));
+}
+}  // namespace engine
+
+namespace engine {
+void Engine::watchFile(const std::filesystem::path& path, config::FileWatcher::ParseFunc parse) {
+  logger::Log::info("Engine::watchFile | Watching \"%s\" for changes.", path.string());
+  fileWatcher.watch(path, std::move(parse));
+}
+
+void Engine::watchConfigurationFiles() {
+  watchFile(config::Config::fileName, [this](const std::filesystem::path& path) -> config::FileWatcher::ApplyFunc {
+    auto values = std::make_shared<config::ConfigValues>();
+    std::string error;
+    if (!config::Config::read(path, *values, error)) {
+      return [error] { logger::Log::error("Engine::watchConfigurationFiles | %s", error); };
+    }
+    return [this, values] { applyConfiguration(*values); };
+  });
+  if (moduleConfigFile.empty()) return;
+  watchFile(moduleConfigFile, [this, chainName = moduleChainName](const std::filesystem::path& path) {
+    auto chain = std::make_shared<ModuleChainSpec>();
+    TCODParser parser;
+    declareModuleConfigStructure(parser);
+    ModuleChainReader reader{*chain, chainName};
+    {
+      std::lock_guard lock{config::Config::parserMutex};
+      parser.run(path.string().c_str(), &reader);
+    }
+    return [this, chain] { applyModuleChain(*chain); };
+  });
+}
+
+bool Engine::loadStyleSheet(const std::filesystem::path& path) {
+  logger::Log::openBlock("Engine::loadStyleSheet | Loading style sheet \"%s\".", path.string());
+  std::vector<widget::StyleRule> rules;
+  std::string error;
+  if (!widget::StyleRules::compile(path, rules, error)) {
+    logger::Log::error("Engine::loadStyleSheet | %s", error);
+    logger::Log::closeBlock(logger::LOGRESULT_FAILURE);
+    return false;
+  }
+  logger::Log::info("Engine::loadStyleSheet | Compiled %d rules.", static_cast<int>(rules.size()));
+  styleRules.setRules(std::move(rules));
+  if (styleSheetFile != path) {
+    styleSheetFile = path;
+    watchFile(path, [this](const std::filesystem::path& changed) -> config::FileWatcher::ApplyFunc {
+      auto rules = std::make_shared<std::vector<widget::StyleRule>>();
+      std::string error;
+      if (!widget::StyleRules::compile(changed, *rules, error)) {
+        return [error] { logger::Log::error("Engine::loadStyleSheet | %s", error); };
+      }
+      return [this, rules, changed] {
+        if (changed != styleSheetFile) return;  // another style sheet has been loaded since
+        styleRules.setRules(std::move(*rules));
+      };
+    });
+  }
+  logger::Log::closeBlock(logger::LOGRESULT_SUCCESS);
+  return true;
+}
+
+void Engine::applyConfiguration(const config::ConfigValues& values) {
+  logger::Log::openBlock(
+      "Engine::applyConfiguration | Applying changes to \"%s\".", config::Config::fileName.string());
+  config::Config::logLevel = values.logLevel;
+  config::Config::hotReload = values.hotReload;
+  if (values.fullScreen != TCODConsole::isFullscreen()) TCODConsole::setFullscreen(values.fullScreen);
+  config::Config::fullScreen = values.fullScreen;
+  bool reinitialiseRoot = false;
+  if (values.fontID != getFontID()) {
+    if (config::Config::activateFontID(values.fontID))
+      reinitialiseRoot = true;
+    else
+      logger::Log::warning("Engine::applyConfiguration | There is no font with the ID %d.", values.fontID);
+  }
+  if (values.rootWidth != getRootWidth() || values.rootHeight != getRootHeight()) {
+    config::Config::rootWidth = values.rootWidth;
+    config::Config::rootHeight = values.rootHeight;
+    reinitialiseRoot = true;
+  }
+  if (reinitialiseRoot) reconfigureRoot();
+  if (values.fontDir != config::Config::fontDir) {
+    logger::Log::notice("Engine::applyConfiguration | The font directory change will take effect on restart.");
+  }
+  if (values.moduleChain != (config::Config::moduleChain ? config::Config::moduleChain : "")) {
+    logger::Log::notice("Engine::applyConfiguration | The module chain change will take effect on restart.");
+  }
+  logger::Log::closeBlock(logger::LOGRESULT_SUCCESS);
+}
+
+void Engine::applyModuleChain(const ModuleChainSpec& chain) {
+  logger::Log::openBlock("Engine::applyModuleChain | Applying changes to \"%s\".", moduleConfigFile);
+  if (!chain.error.empty()) {
+    logger::Log::error("Engine::applyModuleChain | %s", chain.error);
+    logger::Log::closeBlock(logger::LOGRESULT_FAILURE);
+    return;
+  }
+  if (!chain.found) {
+    logger::Log::error("Engine::applyModuleChain | The module chain \"%s\" was not found.", moduleChainName);
+    logger::Log::closeBlock(logger::LOGRESULT_FAILURE);
+    return;
+  }
+  // find a module by name, getting it from the factory if it was added to the file
+  const auto findModule = [this](const std::string& name) -> module::Module* {
+    for (auto& it : modules) {
+      if (it->name_ == name) return it;
+    }
+    module::Module* mod = moduleFactory ? moduleFactory->createModule(name.c_str()) : nullptr;
+    if (mod)
+      registerModule(mod, name.c_str());
+    else
+      logger::Log::error("Engine::applyModuleChain | Unknown module \"%s\".", name);
+    return mod;
+  };
+  const auto applyParameter = [](module::Module* mod, const ModuleParameterSpec& spec) {
+    if (isSameParameter(spec, mod)) return;
+    setParameter(mod, spec);
+    logger::Log::info("Engine::applyModuleChain | Updated parameter \"%s\" of \"%s\".", spec.name, mod->getName());
+  };
+  bool resort = false;
+  for (const ModuleSpec& spec : chain.modules) {
+    module::Module* mod = findModule(spec.name);
+    if (!mod) continue;
+    if (spec.priority && *spec.priority != mod->getPriority()) {
+      mod->setPriority(*spec.priority);
+      resort = true;
+    }
+    if (spec.timeout && static_cast<uint32_t>(*spec.timeout) != mod->timeout_) mod->setTimeout(*spec.timeout);
+    if (!spec.fallback.empty()) {
+      module::Module* fallback = findModule(spec.fallback);
+      if (fallback && fallback->getID() != mod->getFallback()) mod->setFallback(fallback->getID());
+    }
+    // module level parameters overload the chain level ones
+    for (const auto& chainParam : chain.parameters) {
+      const bool overloaded = std::any_of(spec.parameters.begin(), spec.parameters.end(), [&](const auto& param) {
+        return param.name == chainParam.name;
+      });
+      if (!overloaded) applyParameter(mod, chainParam);
+    }
+    for (const auto& param : spec.parameters) applyParameter(mod, param);
+  }
+  if (resort) {
+    std::stable_sort(activeModules.begin(), activeModules.end(), [](module::Module* a, module::Module* b) {
+      return a->getPriority() < b->getPriority();
+    });
+  }
+  logger::Log::closeBlock(logger::LOGRESULT_SUCCESS);
+}
 }  // namespace engine
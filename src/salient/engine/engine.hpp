@@ -36,15 +36,29 @@
 #include <fmt/printf.h>
 #include <libtcod/console_types.h>
 
+#include <filesystem>
 #include <iostream>
 #include <libtcod/list.hpp>
+#include <memory>
 #include <string>
 
 #include "base/key.hpp"
+#include "base/tileset_cache.hpp"
+#include "base/truetype_font.hpp"
 #include "config/config.hpp"
+#include "config/watcher.hpp"
 #include "events/callback_fwd.hpp"
+#include "jobs/pool.hpp"
 #include "module/factory.hpp"
 #include "module/module.hpp"
+#include "net/stream_server.hpp"
+#include "render/capture.hpp"
+#include "render/compositor.hpp"
+#include "render/effects.hpp"
+#include "render/software_renderer.hpp"
+#include "render/terminal.hpp"
+#include "render/transition.hpp"
+#include "widget/style_rules.hpp"
 
 namespace engine {
 /**
@@ -80,6 +94,8 @@ struct CustomCharMap {
   int code;
 };
 
+struct ModuleChainSpec;
+
 // the main engine
 class Engine {
  public:
@@ -163,6 +179,13 @@ class Engine {
    * @param renderer the renderer to be used (defaults to SDL)
    */
   void reinitialise(TCOD_renderer_t renderer = TCOD_RENDERER_SDL2);
+  /**
+   * Applies the current font and root console dimensions in place: the tileset is swapped and the root console and the
+   * window are resized, while the window, its renderer and the root console's settings stay alive. Modules are
+   * notified through <code>Module::onResize()</code> if the root console's size changed. Falls back to
+   * <code>reinitialise()</code> if the root console hasn't been created yet.
+   */
+  void reconfigureRoot();
   /**
    * Runs the engine.
    * @return the result of running the application: <i>0</i> if no errors have occurred, different value otherwise.
@@ -316,7 +339,98 @@ class Engine {
    * value of 0 results in doing nothing.
    * @return <code>true</code> if the font has been successfully changed, <code>false</code> otherwise
    */
-  inline bool activateFont(int shift = 0) { return config::Config::activateFont(shift); }
+  bool activateFont(int shift = 0);
+  /**
+   * Uses a TrueType font instead of the registered bitmap fonts. While it is in use, <code>activateFont()</code>
+   * changes its pixel height instead of switching between bitmap fonts.
+   * @param font the TrueType font, or <code>nullptr</code> to go back to the bitmap fonts
+   * @return <code>true</code> if the font is in use, <code>false</code> if it couldn't be loaded
+   */
+  bool setTrueTypeFont(std::unique_ptr<base::TrueTypeFont> font);
+  /**
+   * Fetches the TrueType font in use.
+   * @return a pointer to the TrueType font, or <code>nullptr</code> if bitmap fonts are used
+   */
+  base::TrueTypeFont* getTrueTypeFont() { return trueTypeFont.get(); }
+  /**
+   * Switches between libtcod's renderer and the software renderer, which draws the root console on the CPU and
+   * presents it through the window's SDL renderer. libtcod's frame rate limit and statistics don't apply to the
+   * software renderer: frames are limited to <code>FRAME_RATE</code> per second instead. Has no visible effect with
+   * the OpenGL renderers, which don't use an SDL renderer.
+   * @param enabled <code>true</code> to use the software renderer, <code>false</code> to use libtcod's renderer
+   */
+  void setSoftwareRendering(bool enabled);
+  /**
+   * Fetches the software renderer, for instance to read the last frame it drew.
+   * @return a pointer to the software renderer, or <code>nullptr</code> if it isn't in use
+   */
+  render::SoftwareRenderer* getSoftwareRenderer() { return softwareRenderer.get(); }
+  /**
+   * Draws the root console on the terminal the game was started from instead of the window, and reads the keyboard
+   * from it, for instance to play over SSH. Frames are limited to <code>FRAME_RATE</code> per second. The window still
+   * exists: on a headless server, set the <code>SDL_VIDEODRIVER</code> environment variable to <code>dummy</code>.
+   * Mouse input isn't available on the terminal.
+   * @param enabled <code>true</code> to draw on the terminal, <code>false</code> to go back to the window
+   * @return <code>true</code> if the requested output is in use, <code>false</code> if the terminal couldn't be set up
+   */
+  bool setTerminalOutput(bool enabled);
+  /**
+   * Fetches the terminal the root console is drawn on.
+   * @return a pointer to the terminal, or <code>nullptr</code> if the window is used
+   */
+  render::Terminal* getTerminal() { return terminal.get(); }
+  /**
+   * Fetches the compositor rendering the active modules, for instance to read how many modules were culled.
+   * @return the compositor
+   */
+  const render::Compositor& getCompositor() const { return compositor; }
+  /**
+   * Fetches the post-processing effects run on the root console once the modules have rendered, before it is flushed.
+   * Their timings are shown by the speedometer.
+   * @return the effect pipeline
+   */
+  render::EffectPipeline& getEffects() { return effects; }
+  /**
+   * Starts a transition from the frame currently on the root console to the following ones. Until the next frame is
+   * rendered, the root console holds the last presented frame, so this is best called while updating the modules of
+   * the outgoing screen. Modules ending with a transition set through <code>Module::setTransition()</code> call it
+   * automatically.
+   * @param settings the transition settings
+   */
+  void startTransition(const module::TransitionSettings& settings);
+  /**
+   * Fetches the transition being played, for instance to start one from a plain colour.
+   * @return the transition
+   */
+  render::Transition& getTransition() { return transition; }
+  /**
+   * Saves a screenshot of the last presented frame. The frame is copied right away and encoded on a background thread.
+   * @param filename the PNG file to be written, or an empty path to use the next free screenshot<i>NNN</i>.png name
+   */
+  void saveScreenshot(std::filesystem::path filename = {});
+  /**
+   * Starts capturing presented frames to disk, for offline analysis. Frames are encoded on a background thread; those
+   * presented while the encoder is behind are dropped.
+   * @param directory the directory the frames are written to
+   * @param interval capture one frame out of <code>interval</code>
+   * @param format the file format of the frames
+   */
+  void startCapture(
+      const std::filesystem::path& directory, int interval = 1, render::CaptureFormat format = render::CAPTURE_PNG);
+  /**
+   * Stops capturing frames.
+   */
+  void stopCapture() { frameCapture.stopSequence(); }
+  /**
+   * Gets the server streaming the root console to spectators. It is idle until told to listen; once it is, every
+   * presented frame is handed over to it.
+   * @return the console stream server
+   */
+  net::ConsoleStreamServer& getStreamServer() { return streamServer; }
+  /**
+   * The default frame rate limit.
+   */
+  static constexpr int FRAME_RATE = 25;
   /**
    * Retrieves the width of the console in cells.
    * @return the console's width
@@ -350,7 +464,7 @@ class Engine {
   static void setRootDimensions(int w, int h) {
     config::Config::rootWidth = w;
     config::Config::rootHeight = h;
-    getInstance()->reinitialise(renderer);
+    getInstance()->reconfigureRoot();
   }
   /**
    * Displays a credits line.
@@ -359,12 +473,68 @@ class Engine {
    * @param duration the total duration of the display (half of which is the fade out)
    */
   void printCredits(int x, int y, uint32_t duration = 10000);
+  /**
+   * Watches a file (for instance a style sheet) and re-parses it whenever it changes on disk. Only effective if hot
+   * reloading is enabled in the configuration file.
+   * @param path the file to be watched
+   * @param parse the function re-parsing the file. It is called on a background thread and must not touch the engine
+   * or any module; the function it returns is applied on the main thread between two frames.
+   */
+  void watchFile(const std::filesystem::path& path, config::FileWatcher::ParseFunc parse);
+  /**
+   * Fetches the engine's job pool, used to spread work such as asset loading across worker threads.
+   * @return a reference to the job pool
+   */
+  jobs::JobPool& getJobPool() { return jobPool; }
+  /**
+   * Loads a style sheet, replacing the rules of the previous one. Widgets pick up the new styles on their next frame.
+   * The file is reloaded whenever it changes if hot reloading is enabled.
+   * @param path the style sheet file
+   * @return <code>true</code> if the style sheet has been loaded, <code>false</code> otherwise
+   */
+  bool loadStyleSheet(const std::filesystem::path& path);
+  /**
+   * Fetches the style rules the widgets resolve their styles from.
+   * @return a reference to the style rules
+   */
+  widget::StyleRules& getStyleRules() { return styleRules; }
 
  private:
   /**
    * Register custom characters
    */
   void registerCustomCharacters();
+  /**
+   * Makes the current font libtcod's default tileset, using its baked tileset if there is an up to date one.
+   * @return <code>true</code> if the baked tileset has been used, <code>false</code> if the font has been loaded from
+   * its image file
+   */
+  bool loadFontTileset();
+  /**
+   * Registers the custom characters and bakes the tileset, unless it was loaded from the tileset cache in which case
+   * both have already been done. Called after the root console has been initialised.
+   * @param baked the value returned by <code>loadFontTileset()</code>
+   */
+  void finishFontTileset(bool baked);
+  /**
+   * Presents the root console, through libtcod, through the software renderer or on the terminal.
+   */
+  void flush();
+  /**
+   * Waits until the next frame is due when the frame rate isn't limited by libtcod.
+   */
+  void waitNextFrame();
+  /**
+   * Reads the keyboard from the terminal, filtering the events the way the keyboard mode does.
+   * @param key the last key event, or an empty one
+   */
+  void readTerminalKeys(TCOD_key_t& key);
+  /**
+   * Copies the last presented frame.
+   * @param frame the frame buffer receiving the pixels
+   * @return <code>true</code> if the frame has been copied, <code>false</code> otherwise
+   */
+  bool grabFrame(render::Framebuffer& frame);
 
   static Engine* engineInstance;
   static TCOD_renderer_t renderer;
@@ -378,6 +548,24 @@ class Engine {
   module::Module* internalModules[INTERNAL_MAX]{};
   KeyboardMode keyboardMode{KEYBOARD_RELEASED};
   std::vector<events::Callback*> callbacks{};  // the keybinding callbacks
+  base::TilesetCache tilesetCache{"data/cache"};  // baked fonts
+  std::unique_ptr<base::TrueTypeFont> trueTypeFont{};  // replaces the bitmap fonts if set
+  render::Compositor compositor{};  // renders the active modules' layers
+  render::EffectPipeline effects{};  // post-processing of the root console
+  render::Transition transition{};  // blends the previous screen into the current one
+  std::unique_ptr<render::SoftwareRenderer> softwareRenderer{};  // replaces libtcod's renderer if set
+  std::unique_ptr<render::Terminal> terminal{};  // replaces the window if set
+  uint32_t nextFrameTicks{};  // frame rate limit of the software renderer and the terminal
+  render::FrameCapture frameCapture{};  // screenshot and frame sequence encoder
+  int nextScreenshot{0};  // the next screenshot file number to try
+  net::ConsoleStreamServer streamServer{};  // spectator stream of the root console
+  jobs::JobPool jobPool{};  // worker threads shared by the engine and the modules
+  config::FileWatcher fileWatcher{};  // reloads configuration files when they change
+  widget::StyleRules styleRules{};  // the rules of the loaded style sheet
+  std::filesystem::path styleSheetFile{};  // the loaded style sheet, empty if none
+  module::ModuleFactory* moduleFactory{};  // the factory used by the module configuration, if any
+  std::string moduleConfigFile{};  // the loaded module configuration file
+  std::string moduleChainName{};  // the loaded module chain (empty for the first chain in the file)
   /**
    * Parses the keyboard input and passes it to the registered callbacks.
    * @param key a reference to the keyboard event object
@@ -401,6 +589,21 @@ class Engine {
   void registerInternalModule(InternalModuleID id, module::Module* module);
   /// @brief SDL event watcher.
   static int onSDLEvent(void* userdata, SDL_Event* event);
+  /**
+   * Adds the configuration file and the module configuration file to the hot reloading watch list.
+   */
+  void watchConfigurationFiles();
+  /**
+   * Applies the configuration variables that changed since the configuration file was loaded.
+   * @param values the configuration variables read from the configuration file
+   */
+  void applyConfiguration(const config::ConfigValues& values);
+  /**
+   * Applies the module parameters, priorities, timeouts and fallbacks that changed in the module configuration file.
+   * Module state is left untouched and modules are neither activated nor deactivated.
+   * @param chain the module chain read from the module configuration file
+   */
+  void applyModuleChain(const ModuleChainSpec& chain);
 };
 }  // namespace engine
 #endif
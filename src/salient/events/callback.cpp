@@ -50,20 +50,20 @@ void CallbackFullscreen::action() { TCODConsole::setFullscreen(!TCODConsole::isF
 // save screenshot
 CallbackScreenshot::CallbackScreenshot() { key = {TCODK_PRINTSCREEN, 0, false, false, false}; }
 
-void CallbackScreenshot::action() { TCODSystem::saveScreenshot(NULL); }
+void CallbackScreenshot::action() { getEngine()->saveScreenshot(); }
 
 // switch font up
 CallbackFontUp::CallbackFontUp() { key = {TCODK_PAGEUP, 0, false, false, false}; }
 
 void CallbackFontUp::action() {
-  if (getEngine()->activateFont(1)) getEngine()->reinitialise();
+  if (getEngine()->activateFont(1)) getEngine()->reconfigureRoot();
 }
 
 // switch font down
 CallbackFontDown::CallbackFontDown() { key = {TCODK_PAGEDOWN, 0, false, false, false}; }
 
 void CallbackFontDown::action() {
-  if (getEngine()->activateFont(-1)) getEngine()->reinitialise();
+  if (getEngine()->activateFont(-1)) getEngine()->reconfigureRoot();
 }
 
 // pause the program
@@ -0,0 +1,141 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "fov/fov_cache.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "fov/shadowcast.hpp"
+
+namespace fov {
+namespace {
+// the changes kept one by one before they are merged into a single bounding box
+constexpr size_t MAX_CHANGES = 64;
+
+bool intersects(const base::Rect& a, const base::Rect& b) noexcept {
+  return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+}
+}  // namespace
+
+FovCache::FovCache(base::BitPlane transparent) : transparent{std::move(transparent)} {}
+
+int FovCache::addViewer(int x, int y, int radius) {
+  int viewer;
+  if (freeViewers.empty()) {
+    viewer = static_cast<int>(viewers.size());
+    viewers.emplace_back();
+  } else {
+    viewer = freeViewers.back();
+    freeViewers.pop_back();
+  }
+  Viewer& entry = viewers[viewer];
+  entry.x = x;
+  entry.y = y;
+  entry.radius = std::max(radius, 0);
+  entry.viewRadius = -1;  // never computed: no clamped radius matches
+  entry.alive = true;
+  return viewer;
+}
+
+void FovCache::removeViewer(int viewer) {
+  viewers[viewer].alive = false;
+  viewers[viewer].visible = base::BitPlane{};
+  freeViewers.push_back(viewer);
+}
+
+void FovCache::moveViewer(int viewer, int x, int y) {
+  viewers[viewer].x = x;
+  viewers[viewer].y = y;
+}
+
+void FovCache::setRadius(int viewer, int radius) { viewers[viewer].radius = std::max(radius, 0); }
+
+void FovCache::setTransparent(int x, int y, bool value) {
+  if (!transparent.contains(x, y) || transparent.get(x, y) == value) return;
+  transparent.set(x, y, value);
+  if (changes.size() < MAX_CHANGES) {
+    changes.push_back(base::Rect{x, y, 1, 1});
+    return;
+  }
+  // too many scattered changes to test one by one: merge them into their bounding box
+  base::Rect& bounds = changes.front();
+  for (const base::Rect& change : changes) {
+    const int right = std::max(bounds.x + bounds.w, change.x + change.w);
+    const int bottom = std::max(bounds.y + bounds.h, change.y + change.h);
+    bounds.x = std::min(bounds.x, change.x);
+    bounds.y = std::min(bounds.y, change.y);
+    bounds.w = right - bounds.x;
+    bounds.h = bottom - bounds.y;
+  }
+  changes.resize(1);
+  changes.push_back(base::Rect{x, y, 1, 1});
+}
+
+void FovCache::setTransparency(base::BitPlane value) {
+  transparent = std::move(value);
+  changes.clear();
+  changedAll = true;
+}
+
+bool FovCache::isStale(const Viewer& viewer) const noexcept {
+  if (viewer.x != viewer.viewX || viewer.y != viewer.viewY || viewer.radius != viewer.viewRadius) return true;
+  if (changedAll) return true;
+  const base::Rect area{viewer.x - viewer.radius, viewer.y - viewer.radius, 2 * viewer.radius + 1,
+                        2 * viewer.radius + 1};
+  for (const base::Rect& change : changes) {
+    if (intersects(area, change)) return true;
+  }
+  return false;
+}
+
+size_t FovCache::update(jobs::JobPool& pool) {
+  if (changedAll || !changes.empty()) ++version;
+  std::vector<Viewer*> stale{};
+  for (Viewer& viewer : viewers) {
+    if (viewer.alive && isStale(viewer)) stale.push_back(&viewer);
+  }
+  pool.parallelFor(stale.size(), [&](size_t i) {
+    Viewer& viewer = *stale[i];
+    computeFov(transparent, viewer.x, viewer.y, viewer.radius, viewer.visible);
+    viewer.viewX = viewer.x;
+    viewer.viewY = viewer.y;
+    viewer.viewRadius = viewer.radius;
+  });
+  // the views that weren't recomputed are up to date with this version too
+  for (Viewer& viewer : viewers) {
+    if (viewer.alive) viewer.version = version;
+  }
+  changes.clear();
+  changedAll = false;
+  return stale.size();
+}
+}  // namespace fov
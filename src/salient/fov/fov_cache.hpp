@@ -0,0 +1,151 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "base/bit_plane.hpp"
+#include "base/rect.hpp"
+#include "jobs/pool.hpp"
+
+namespace fov {
+/**
+ * The fields of view of many viewers over one map. Each viewer's view is cached with the position, radius and map
+ * version it was computed for, and <code>update()</code> only recomputes, in parallel, the views of the viewers that
+ * moved or whose view area holds a cell whose transparency changed.
+ */
+class FovCache {
+ public:
+  /**
+   * Creates a cache without viewers.
+   * @param transparent the cells that don't block the view
+   */
+  explicit FovCache(base::BitPlane transparent);
+  /**
+   * Adds a viewer. Its view is computed by the next <code>update()</code>.
+   * @param x the viewer's <i>x</i> coordinate
+   * @param y the viewer's <i>y</i> coordinate
+   * @param radius the view's radius, in cells. Negative radii count as 0
+   * @return the viewer's ID
+   */
+  int addViewer(int x, int y, int radius);
+  /**
+   * Removes a viewer. Its ID may be given to a viewer added later.
+   * @param viewer the viewer's ID
+   */
+  void removeViewer(int viewer);
+  /**
+   * Moves a viewer. Moving it where it already is doesn't invalidate its view.
+   * @param viewer the viewer's ID
+   * @param x the viewer's new <i>x</i> coordinate
+   * @param y the viewer's new <i>y</i> coordinate
+   */
+  void moveViewer(int viewer, int x, int y);
+  /**
+   * Changes the radius of a viewer's view.
+   * @param viewer the viewer's ID
+   * @param radius the view's new radius, in cells. Negative radii count as 0
+   */
+  void setRadius(int viewer, int radius);
+  /**
+   * Changes the transparency of a cell. Only the views whose area holds the cell are invalidated, and only if its
+   * transparency actually changes.
+   * @param x the cell's <i>x</i> coordinate
+   * @param y the cell's <i>y</i> coordinate
+   * @param transparent whether the cell lets the view through
+   */
+  void setTransparent(int x, int y, bool transparent);
+  /**
+   * Replaces the transparency of the whole map, invalidating every view.
+   * @param transparent the cells that don't block the view
+   */
+  void setTransparency(base::BitPlane transparent);
+  const base::BitPlane& getTransparency() const noexcept { return transparent; }
+  /**
+   * Recomputes the out of date views, spreading them across the job pool. The cache must not be modified meanwhile.
+   * @param pool the job pool
+   * @return the number of views recomputed
+   */
+  size_t update(jobs::JobPool& pool);
+  /**
+   * Checks whether a viewer sees a cell, as of the last <code>update()</code>.
+   * @param viewer the viewer's ID
+   * @param x the cell's <i>x</i> coordinate
+   * @param y the cell's <i>y</i> coordinate
+   * @return <code>true</code> if the cell is in view, <code>false</code> otherwise
+   */
+  bool isVisible(int viewer, int x, int y) const noexcept {
+    const Viewer& entry = viewers[viewer];
+    return entry.visible.get(x - entry.viewX + entry.viewRadius, y - entry.viewY + entry.viewRadius);
+  }
+  /**
+   * Gets the cells a viewer sees, as of the last <code>update()</code>. See <code>computeFov()</code> for the layout.
+   * @param viewer the viewer's ID
+   * @return the visible cells, centred on the viewer's position when its view was computed
+   */
+  const base::BitPlane& getVisible(int viewer) const noexcept { return viewers[viewer].visible; }
+  /**
+   * Gets the map version a viewer's view was computed for.
+   * @param viewer the viewer's ID
+   * @return the version
+   */
+  uint64_t getViewVersion(int viewer) const noexcept { return viewers[viewer].version; }
+  /**
+   * Gets the map version, bumped by every <code>update()</code> following a transparency change.
+   * @return the version
+   */
+  uint64_t getVersion() const noexcept { return version; }
+  size_t getViewerCount() const noexcept { return viewers.size() - freeViewers.size(); }
+
+ private:
+  struct Viewer {
+    int x{}, y{}, radius{};  // the viewer as it is now
+    int viewX{}, viewY{}, viewRadius{-1};  // the viewer as it was when its view was computed
+    uint64_t version{};  // the map version the view was computed for
+    bool alive{};
+    base::BitPlane visible{};
+  };
+  /**
+   * Checks whether a viewer's view must be recomputed.
+   * @param viewer the viewer
+   * @return <code>true</code> if the view is out of date, <code>false</code> otherwise
+   */
+  bool isStale(const Viewer& viewer) const noexcept;
+  base::BitPlane transparent;
+  std::vector<Viewer> viewers{};
+  std::vector<int> freeViewers{};
+  std::vector<base::Rect> changes{};  // the areas changed since the last update
+  bool changedAll{};
+  uint64_t version{1};
+};
+}  // namespace fov
@@ -0,0 +1,116 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "fov/shadowcast.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace fov {
+namespace {
+// slopes are kept as exact fractions, with a positive denominator
+struct Slope {
+  int numerator;
+  int denominator;
+};
+
+// a row of a quadrant, between two slopes
+struct Row {
+  int depth;
+  Slope start;
+  Slope end;
+};
+
+int floorDivide(int numerator, int denominator) {
+  const int quotient = numerator / denominator;
+  return (numerator % denominator != 0 && (numerator < 0) != (denominator < 0)) ? quotient - 1 : quotient;
+}
+
+// the first column of a row, depth * start rounded with ties going up
+int firstColumn(const Row& row) {
+  return floorDivide(2 * row.depth * row.start.numerator + row.start.denominator, 2 * row.start.denominator);
+}
+
+// the last column of a row, depth * end rounded with ties going down
+int lastColumn(const Row& row) {
+  return -floorDivide(-(2 * row.depth * row.end.numerator - row.end.denominator), 2 * row.end.denominator);
+}
+
+// the slope of the left edge of a cell
+Slope slopeOf(int depth, int column) { return Slope{2 * column - 1, 2 * depth}; }
+
+// whether the centre of a cell lies between the row's slopes, which makes the view symmetric
+bool isSymmetric(const Row& row, int column) {
+  return column * row.start.denominator >= row.depth * row.start.numerator &&
+         column * row.end.denominator <= row.depth * row.end.numerator;
+}
+}  // namespace
+
+void computeFov(const base::BitPlane& transparent, int x, int y, int radius, base::BitPlane& visible) {
+  radius = std::max(radius, 0);
+  const int size = 2 * radius + 1;
+  if (visible.getWidth() != size || visible.getHeight() != size) {
+    visible = base::BitPlane{size, size};
+  } else {
+    visible.fill(false);
+  }
+  if (!transparent.contains(x, y)) return;
+  visible.set(radius, radius);
+  const int limit = radius * radius + radius;  // rounds the disc's edge
+  thread_local std::vector<Row> rows{};  // reused across calls
+  rows.clear();
+  // the quadrants facing north, east, south and west, as the cell offsets of a step along the row and a step deeper
+  static constexpr int QUADRANTS[4][4] = {{1, 0, 0, -1}, {0, 1, 1, 0}, {1, 0, 0, 1}, {0, 1, -1, 0}};
+  for (const auto& quadrant : QUADRANTS) {
+    const auto cellX = [&](int depth, int column) { return x + column * quadrant[0] + depth * quadrant[2]; };
+    const auto cellY = [&](int depth, int column) { return y + column * quadrant[1] + depth * quadrant[3]; };
+    rows.push_back(Row{1, Slope{-1, 1}, Slope{1, 1}});
+    while (!rows.empty()) {
+      Row row = rows.back();
+      rows.pop_back();
+      if (row.depth > radius) continue;
+      int previous = -1;  // whether the previous cell of the row was a wall (1), a floor (0) or doesn't exist (-1)
+      for (int column = firstColumn(row); column <= lastColumn(row); ++column) {
+        const int cx = cellX(row.depth, column);
+        const int cy = cellY(row.depth, column);
+        const bool wall = !transparent.get(cx, cy);
+        if ((wall || isSymmetric(row, column)) && row.depth * row.depth + column * column <= limit) {
+          visible.set(cx - x + radius, cy - y + radius);
+        }
+        if (previous == 1 && !wall) row.start = slopeOf(row.depth, column);
+        if (previous == 0 && wall) rows.push_back(Row{row.depth + 1, row.start, slopeOf(row.depth, column)});
+        previous = wall ? 1 : 0;
+      }
+      if (previous == 0) rows.push_back(Row{row.depth + 1, row.start, row.end});
+    }
+  }
+}
+}  // namespace fov
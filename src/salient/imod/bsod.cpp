@@ -40,7 +40,6 @@
 
 namespace imod {
 ModBSOD::ModBSOD() {
-  bsod = new TCODConsole(30, 8);
   closeButton.set(28, 0);
   rect.set(getEngine()->getRootWidth() - 31, getEngine()->getRootHeight() - 9, 30, 8);
   setDragZone(0, 0, 28, 1);
@@ -60,18 +59,25 @@ bool ModBSOD::update() {
     return true;
 }
 
-void ModBSOD::render() {
-  bsod->setDefaultBackground(TCODColor::blue);
-  bsod->clear();
-  bsod->setDefaultForeground(TCODColor::white);
-  bsod->printFrame(0, 0, 30, 8, true, TCOD_BKGND_NONE, "Umbra BSOD");
-  bsod->printRectEx(15, 2, 28, 5, TCOD_BKGND_NONE, TCOD_CENTER, logger::Log::get().c_str());
-  if (closeButton.mouseHover) bsod->setDefaultForeground(TCODColor::red);
-  bsod->putChar(closeButton.x, closeButton.y, 'X', TCOD_BKGND_NONE);
+void ModBSOD::hashState(widget::RenderState& state) { state.add(logger::Log::size()); }
+
+void ModBSOD::renderSurface(TCODConsole& bsod) {
+  bsod.setDefaultBackground(TCODColor::blue);
+  bsod.clear();
+  bsod.setDefaultForeground(TCODColor::white);
+  bsod.printFrame(0, 0, 30, 8, true, TCOD_BKGND_NONE, "Umbra BSOD");
+  if (logger::Log::size() != messageCount) {
+    message.setText(logger::Log::get());
+    messageCount = logger::Log::size();
+  }
+  message.draw(bsod, 15, 2, 28, 5, TCOD_CENTER);
+  if (closeButton.mouseHover) bsod.setDefaultForeground(TCODColor::red);
+  bsod.putChar(closeButton.x, closeButton.y, 'X', TCOD_BKGND_NONE);
   if (dragZone.mouseHover || isDragging) {
-    bsod->setDefaultBackground(TCODColor::lightRed);
-    bsod->rect(9, 0, 12, 1, false, TCOD_BKGND_SET);
+    bsod.setDefaultBackground(TCODColor::lightRed);
+    bsod.rect(9, 0, 12, 1, false, TCOD_BKGND_SET);
   }
-  TCODConsole::blit(bsod, 0, 0, rect.w, rect.h, TCODConsole::root, rect.x, rect.y, 1.0f, 0.5f);
 }
+
+void ModBSOD::render() { renderCached(1.0f, 0.5f); }
 }  // namespace imod
@@ -33,6 +33,7 @@
 #include <libtcod/console.hpp>
 #include <string>
 
+#include "render/text_layout.hpp"
 #include "widget/widget.hpp"
 namespace imod {
 class ModBSOD : public widget::Widget {
@@ -48,17 +49,24 @@ class ModBSOD : public widget::Widget {
    * Renders the BSOD on the screen.
    */
   void render() override;
+  void hashState(widget::RenderState& state) override;
   void onEvent(const SDL_Event&) override {}
 
  private:
-  TCODConsole* bsod;
   uint32_t startTime{0};
   uint32_t duration{5000};
   std::string msgString{""};
+  render::TextLayout message{};  // the last logged message, laid out
+  int messageCount{-1};  // the number of logged messages when the message was laid out
 
   /**
    * Initialises the time count for a new timeout.
    */
   void activate();
+  /**
+   * Draws the frame and the last logged message.
+   * @param bsod the widget's offscreen console
+   */
+  void renderSurface(TCODConsole& bsod) override;
 };
 }  // namespace imod
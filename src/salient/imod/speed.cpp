@@ -26,9 +26,11 @@
  */
 #include "imod/speed.hpp"
 
+#include <algorithm>
 #include <libtcod/libtcod.hpp>
 
 #include "engine/engine.hpp"
+#include "render/print.hpp"
 
 namespace imod {
 #define MAXIMISED_MODE_WIDTH 30
@@ -36,7 +38,6 @@ namespace imod {
 #define TIMEBAR_LENGTH (MAXIMISED_MODE_WIDTH - 4) * 2
 
 ModSpeed::ModSpeed() {
-  speed = new TCODConsole(MAXIMISED_MODE_WIDTH, MAXIMISED_MODE_HEIGHT);
   rect.set((getEngine()->getRootWidth() / 2) - 15, (getEngine()->getRootHeight() / 2) - 3, 30, MAXIMISED_MODE_HEIGHT);
   // the title bar is drag-sensible
   setDragZone(0, 0, MAXIMISED_MODE_WIDTH - 3, 1);
@@ -46,6 +47,7 @@ ModSpeed::ModSpeed() {
   setPriority(-2000000000);  // high priority for internal modules
   timeBar = new TCODImage(TIMEBAR_LENGTH, 2);
   setName("umbraSpeedometer");
+  updateSummary();
 }
 
 void ModSpeed::onEvent(const SDL_Event& ev) {
@@ -66,7 +68,7 @@ void ModSpeed::onEvent(const SDL_Event& ev) {
             dragZone.w = 7;
             rect.x = rect.x + MAXIMISED_MODE_WIDTH - 10;
           } else {
-            rect.setSize(MAXIMISED_MODE_WIDTH, MAXIMISED_MODE_HEIGHT);
+            rect.setSize(MAXIMISED_MODE_WIDTH, getMaximisedHeight());
             minimiseButton.set(MAXIMISED_MODE_WIDTH - 3, 0);
             closeButton.set(MAXIMISED_MODE_WIDTH - 2, 0);
             dragZone.w = MAXIMISED_MODE_WIDTH - 3;
@@ -94,7 +96,17 @@ bool ModSpeed::update() {
     updatePer = (int)(updateTime * 100.0f / (cumulatedElapsed));
     renderPer = (int)(renderTime * 100.0f / (cumulatedElapsed));
     sysPer = 100 - updatePer - renderPer;
+    updateSummary();
     cumulatedElapsed = updateTime = renderTime = 0.0f;
+    // average the effect timings over the frames
+    effectAverages = effectTimes;
+    for (auto& average : effectAverages) average.milliseconds /= MAX(1, effectFrames);
+    for (auto& time : effectTimes) time.milliseconds = 0.0f;
+    effectFrames = 0;
+    if (!isMinimized && rect.h != getMaximisedHeight()) {
+      rect.h = getMaximisedHeight();
+      rect.y = MAX(0, MIN(getEngine()->getRootHeight() - rect.h, rect.y));
+    }
     // compute time bar picture
     for (int px = 0; px < TIMEBAR_LENGTH; px++) {
       TCODColor col;
@@ -114,73 +126,99 @@ bool ModSpeed::update() {
     return false;
 }
 
+void ModSpeed::updateSummary() {
+  // green, yellow and red labels, in libtcod colour controls
+  summary.setText(fmt::format(
+      "\x06\x01\xff\x01Upd\x08 {:2d}% \x06\xff\xff\x01Render\x08 {:2d}% \x06\xff\x01\x01Sys\x08 {:2d}%",
+      updatePer,
+      renderPer,
+      sysPer));
+}
+
 void ModSpeed::setTimes(long new_update_time, long new_render_time) {
   updateTime += new_update_time * 0.001f;
   renderTime += new_render_time * 0.001f;
 }
 
-void ModSpeed::render() {
-  speed->setDefaultBackground(TCODColor::black);
-  speed->setDefaultForeground(TCODColor::white);
+void ModSpeed::setEffectTimes(const std::vector<render::EffectTiming>& timings) {
+  const bool sameEffects = std::equal(
+      timings.begin(),
+      timings.end(),
+      effectTimes.begin(),
+      effectTimes.end(),
+      [](const render::EffectTiming& a, const render::EffectTiming& b) { return a.name == b.name; });
+  if (!sameEffects) {
+    // the pipeline changed: start over
+    effectTimes = timings;
+    effectFrames = 1;
+    return;
+  }
+  for (size_t i = 0; i < timings.size(); ++i) effectTimes[i].milliseconds += timings[i].milliseconds;
+  ++effectFrames;
+}
+
+int ModSpeed::getMaximisedHeight() const { return MAXIMISED_MODE_HEIGHT + static_cast<int>(effectAverages.size()); }
+
+void ModSpeed::hashState(widget::RenderState& state) {
+  state.add(isMinimized).add(TCODSystem::getFps());
+  if (!isMinimized) {
+    state.add(static_cast<int>(TCODSystem::getLastFrameLength() * 1000)).add(updatePer).add(renderPer).add(sysPer);
+    for (const auto& average : effectAverages) {
+      state.add(std::string_view{average.name}).add(static_cast<int>(average.milliseconds * 100));
+    }
+  }
+}
+
+void ModSpeed::renderSurface(TCODConsole& speed) {
+  speed.setDefaultBackground(TCODColor::black);
+  speed.setDefaultForeground(TCODColor::white);
   if (isMinimized) {
-    speed->printEx(0, 0, TCOD_BKGND_SET, TCOD_LEFT, "%4dfps ", TCODSystem::getFps());
-    TCODConsole::blit(speed, 0, 0, 8, 1, TCODConsole::root, rect.x, rect.y, 1.0f, 0.5f);
+    render::print(speed, 0, 0, TCOD_LEFT, TCOD_BKGND_SET, "{:4d}fps ", TCODSystem::getFps());
   } else {
-    speed->printFrame(0, 0, MAXIMISED_MODE_WIDTH, MAXIMISED_MODE_HEIGHT, true, TCOD_BKGND_SET, "Speed-o-meter");
-    speed->printEx(
+    speed.printFrame(0, 0, MAXIMISED_MODE_WIDTH, rect.h, true, TCOD_BKGND_SET, "Speed-o-meter");
+    render::print(
+        speed,
         MAXIMISED_MODE_WIDTH / 2,
         2,
-        TCOD_BKGND_NONE,
         TCOD_CENTER,
-        "last frame: %3d ms",
-        (int)(TCODSystem::getLastFrameLength() * 1000));
-    speed->printEx(
-        MAXIMISED_MODE_WIDTH / 2, 3, TCOD_BKGND_NONE, TCOD_CENTER, "frames per second: %3d", TCODSystem::getFps());
+        "last frame: {:3d} ms",
+        static_cast<int>(TCODSystem::getLastFrameLength() * 1000));
+    render::print(speed, MAXIMISED_MODE_WIDTH / 2, 3, TCOD_CENTER, "frames per second: {:3d}", TCODSystem::getFps());
     // summary
-    speed->printEx(
-        MAXIMISED_MODE_WIDTH / 2,
-        5,
-        TCOD_BKGND_NONE,
-        TCOD_CENTER,
-        "%c%c%c%cUpd%c %2d%% %c%c%c%cRender%c %2d%% %c%c%c%cSys%c %2d%%",
-        TCOD_COLCTRL_FORE_RGB,
-        1,
-        255,
-        1,
-        TCOD_COLCTRL_STOP,
-        updatePer,
-        TCOD_COLCTRL_FORE_RGB,
-        255,
-        255,
-        1,
-        TCOD_COLCTRL_STOP,
-        renderPer,
-        TCOD_COLCTRL_FORE_RGB,
-        255,
-        1,
-        1,
-        TCOD_COLCTRL_STOP,
-        sysPer);
+    summary.draw(speed, MAXIMISED_MODE_WIDTH / 2, 5, 0, 1, TCOD_CENTER);
+    // post-processing effects, included in the render time
+    for (size_t i = 0; i < effectAverages.size(); ++i) {
+      render::print(
+          speed,
+          2,
+          6 + static_cast<int>(i),
+          TCOD_LEFT,
+          "{:<12} {:6.2f} ms",
+          effectAverages[i].name,
+          effectAverages[i].milliseconds);
+    }
     if (dragZone.mouseHover || isDragging) {
-      speed->setDefaultBackground(TCODColor::lightRed);
-      speed->rect(7, 0, 15, 1, false, TCOD_BKGND_SET);
+      speed.setDefaultBackground(TCODColor::lightRed);
+      speed.rect(7, 0, 15, 1, false, TCOD_BKGND_SET);
     }
   }
-  speed->setDefaultBackground(TCODColor::black);
+  speed.setDefaultBackground(TCODColor::black);
   // draw minimize button
   if (minimiseButton.mouseHover)
-    speed->setDefaultForeground(TCODColor::white);  // button is active
+    speed.setDefaultForeground(TCODColor::white);  // button is active
   else
-    speed->setDefaultForeground(TCODColor::lightGrey);  // button is not active
-  speed->putChar(minimiseButton.x, minimiseButton.y, isMinimized ? '+' : '-', TCOD_BKGND_SET);
+    speed.setDefaultForeground(TCODColor::lightGrey);  // button is not active
+  speed.putChar(minimiseButton.x, minimiseButton.y, isMinimized ? '+' : '-', TCOD_BKGND_SET);
   // draw close button
   if (closeButton.mouseHover)
-    speed->setDefaultForeground(TCODColor::red);  // button is active
+    speed.setDefaultForeground(TCODColor::red);  // button is active
   else
-    speed->setDefaultForeground(TCODColor::lightGrey);  // button is not active
-  speed->putChar(closeButton.x, closeButton.y, 'X', TCOD_BKGND_SET);
-  // blit the console
-  TCODConsole::blit(speed, 0, 0, rect.w, rect.h, TCODConsole::root, rect.x, rect.y, 1.0f, 0.52f);
+    speed.setDefaultForeground(TCODColor::lightGrey);  // button is not active
+  speed.putChar(closeButton.x, closeButton.y, 'X', TCOD_BKGND_SET);
+}
+
+void ModSpeed::render() {
+  renderCached(1.0f, 0.52f);
   // render non transparent timebar (until libtcod subcell over subcell blitting is fixed...)
   if (!isMinimized) timeBar->blit2x(TCODConsole::root, rect.x + 2, rect.y + 4);
 }
@@ -30,6 +30,10 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 #pragma once
+#include <vector>
+
+#include "render/effects.hpp"
+#include "render/text_layout.hpp"
 #include "widget/widget.hpp"
 
 namespace imod {
@@ -47,6 +51,7 @@ class ModSpeed : public widget::Widget {
    * Displays the Speedo widget.
    */
   void render() override;
+  void hashState(widget::RenderState& state) override;
   /**
    * Parses mouse input.
    */
@@ -63,11 +68,20 @@ class ModSpeed : public widget::Widget {
   float updateTime{0.0f};
   float renderTime{0.0f};
   int updatePer{0}, renderPer{0}, sysPer{0};
+  std::vector<render::EffectTiming> effectTimes{};  // time spent in each effect since the last statistics update
+  std::vector<render::EffectTiming> effectAverages{};  // average time per frame of each effect, as displayed
+  int effectFrames{0};
+  render::TextLayout summary{};  // the coloured update, render and system percentages
   TCODImage* timeBar{};
-  TCODConsole* speed{};
   int fps{};
   bool isMinimized{false};
 
+  /**
+   * Draws the frame, the statistics and the buttons. The time bar is drawn directly on the root console.
+   * @param speed the widget's offscreen console
+   */
+  void renderSurface(TCODConsole& speed) override;
+
   /**
    * Removes the frames per second limit in order to attempt to enforce a 100% load on the CPU.
    */
@@ -82,5 +96,19 @@ class ModSpeed : public widget::Widget {
    * @param renderTime the time spend on <code>render()</code> methods
    */
   void setTimes(long updateTime, long renderTime);  // this is called by engine each frame
+  /**
+   * Lays the update, render and system percentages out again.
+   */
+  void updateSummary();
+  /**
+   * Adds the time spent in each post-processing effect during the frame.
+   * @param timings the timings of the enabled effects, in pipeline order
+   */
+  void setEffectTimes(const std::vector<render::EffectTiming>& timings);  // this is called by engine each frame
+  /**
+   * Gets the height of the maximised widget, which has a row per post-processing effect.
+   * @return the height
+   */
+  int getMaximisedHeight() const;
 };
 }  // namespace imod
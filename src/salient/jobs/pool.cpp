@@ -0,0 +1,106 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "jobs/pool.hpp"
+
+#include <algorithm>
+
+namespace jobs {
+JobPool::JobPool(unsigned threadCount) {
+  if (threadCount == 0) {
+    const unsigned hardwareThreads = std::thread::hardware_concurrency();
+    threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+  }
+  workers.reserve(threadCount);
+  for (unsigned i = 0; i < threadCount; ++i) workers.emplace_back([this] { workerMain(); });
+}
+
+JobPool::~JobPool() {
+  {
+    std::lock_guard lock{queueMutex};
+    stopping = true;
+  }
+  queueCondition.notify_all();
+  for (auto& worker : workers) worker.join();
+}
+
+void JobPool::enqueue(std::function<void()> job) {
+  {
+    std::lock_guard lock{queueMutex};
+    queue.emplace_back(std::move(job));
+  }
+  queueCondition.notify_one();
+}
+
+void JobPool::workerMain() {
+  for (;;) {
+    std::function<void()> job;
+    {
+      std::unique_lock lock{queueMutex};
+      queueCondition.wait(lock, [this] { return stopping || !queue.empty(); });
+      if (queue.empty()) return;  // stopping, and nothing left to do
+      job = std::move(queue.front());
+      queue.pop_front();
+    }
+    job();
+  }
+}
+
+void JobPool::parallelFor(size_t count, const std::function<void(size_t)>& body) {
+  if (count == 0) return;
+  // shared with the helper jobs, some of which may only start after this call has returned
+  struct Loop {
+    const std::function<void(size_t)>* body;
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> done{0};
+    size_t count;
+    std::mutex mutex{};
+    std::condition_variable finished{};
+  };
+  auto loop = std::make_shared<Loop>();
+  loop->body = &body;
+  loop->count = count;
+  const auto work = [](Loop& state) {
+    for (size_t i = state.next++; i < state.count; i = state.next++) {
+      (*state.body)(i);
+      if (++state.done == state.count) {
+        std::lock_guard lock{state.mutex};
+        state.finished.notify_all();
+      }
+    }
+  };
+  const size_t helpers = std::min(workers.size(), count - 1);
+  for (size_t i = 0; i < helpers; ++i) enqueue([loop, work] { work(*loop); });
+  work(*loop);
+  std::unique_lock lock{loop->mutex};
+  loop->finished.wait(lock, [&] { return loop->done == count; });
+}
+}  // namespace jobs
@@ -0,0 +1,100 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace jobs {
+/**
+ * A fixed size pool of worker threads executing jobs in submission order. Jobs must not touch the console, the logger
+ * or any other engine state that isn't thread safe: compute the result in the job and apply it on the main thread.
+ */
+class JobPool {
+ public:
+  /**
+   * Starts the worker threads.
+   * @param threadCount number of worker threads, 0 to use one less than the number of hardware threads
+   */
+  explicit JobPool(unsigned threadCount = 0);
+  /**
+   * Finishes the queued jobs and joins the worker threads.
+   */
+  ~JobPool();
+  JobPool(const JobPool&) = delete;
+  JobPool& operator=(const JobPool&) = delete;
+  /**
+   * Queues a job.
+   * @param job the callable to execute on a worker thread
+   * @return a future holding the job's result, or the exception it threw
+   */
+  template <typename F>
+  auto submit(F&& job) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+    using Result = std::invoke_result_t<std::decay_t<F>>;
+    auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(job));
+    std::future<Result> result = task->get_future();
+    enqueue([task] { (*task)(); });
+    return result;
+  }
+  /**
+   * Calls <code>body(i)</code> for every <code>i</code> in <code>[0, count)</code>, spreading the calls across the
+   * workers. The calling thread takes part in the work, so this can safely be called from within a job. Returns once
+   * every call has finished.
+   * @param count number of iterations
+   * @param body the loop body
+   */
+  void parallelFor(size_t count, const std::function<void(size_t)>& body);
+  /**
+   * Gets the number of worker threads.
+   * @return the number of worker threads
+   */
+  size_t getThreadCount() const { return workers.size(); }
+
+ private:
+  void enqueue(std::function<void()> job);
+  void workerMain();
+  std::vector<std::thread> workers{};
+  std::deque<std::function<void()>> queue{};
+  std::mutex queueMutex{};
+  std::condition_variable queueCondition{};
+  bool stopping{false};
+};
+}  // namespace jobs
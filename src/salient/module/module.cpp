@@ -84,25 +84,44 @@ void Module::setFallback(const char* module_name) {
   }
 }
 
-void Module::setParameter(std::string_view param_name, TCOD_value_t value) {
-  for (ModuleParameter& it : params_) {
-    if (it.name == param_name) {
-      // already exists. update value
-      // this happens when value is overriden in module.cfg
-      it.value = value;
-      return;
-    }
+size_t Module::resolveParameter(ParamKey key) {
+  for (size_t slot = 0; slot < paramKeys_.size(); ++slot) {
+    if (paramKeys_[slot] == key) return slot;
   }
-  params_.emplace_back(ModuleParameter{std::string{param_name}, value});
+  paramKeys_.emplace_back(key);
+  paramTypes_.emplace_back(TCOD_TYPE_NONE);
+  paramValues_.emplace_back(TCOD_value_t{});
+  return paramKeys_.size() - 1;
 }
 
-Module::ModuleParameter& Module::getParameter(std::string_view param_name) {
-  static ModuleParameter def = {"", {0}};
-  for (ModuleParameter& it : params_) {
-    if (it.name == param_name) return it;
+void Module::setParameter(std::string_view param_name, TCOD_value_type_t type, TCOD_value_t value) {
+  // already existing values are overriden, this happens when a value is overriden in module.cfg
+  const size_t slot = resolveParameter(ParamRegistry::intern(param_name));
+  // the parser's strings don't outlive it
+  if (type == TCOD_TYPE_STRING && value.s) value.s = const_cast<char*>(ParamRegistry::internString(value.s));
+  paramTypes_[slot] = type;
+  paramValues_[slot] = value;
+}
+
+const TCOD_value_t& Module::getParameter(std::string_view param_name) {
+  static const TCOD_value_t def{};
+  ParamKey key = 0;
+  // a name that was never interned can't be one of the module's parameters
+  if (!ParamRegistry::find(param_name, key)) return def;
+  for (size_t slot = 0; slot < paramKeys_.size(); ++slot) {
+    if (paramKeys_[slot] == key) return paramValues_[slot];
   }
   return def;
 }
 
+bool Module::hasParameter(std::string_view param_name) {
+  ParamKey key = 0;
+  if (!ParamRegistry::find(param_name, key)) return false;
+  for (size_t slot = 0; slot < paramKeys_.size(); ++slot) {
+    if (paramKeys_[slot] == key) return paramTypes_[slot] != TCOD_TYPE_NONE;
+  }
+  return false;
+}
+
 auto Module::getEngine() -> engine::Engine* { return engine::Engine::getInstance(); }
 }  // namespace module
@@ -38,11 +38,82 @@
 #include <string>
 #include <vector>
 
+#include "base/rect.hpp"
 #include "engine/engine_fwd.hpp"
+#include "module/param.hpp"
+
+namespace render {
+class DrawList;
+}
 
 namespace module {
 enum ModuleStatus { UNINITIALISED, INACTIVE, ACTIVE, PAUSED };
 
+/**
+ * How a module is drawn and composited with the modules under it.
+ */
+struct LayerSettings {
+  /**
+   * Whether the module draws into its own layer with <code>renderLayer()</code> instead of drawing on the root console
+   * with <code>render()</code>.
+   */
+  bool layered{false};
+  /**
+   * Whether <code>renderLayer()</code> may run on the job pool, alongside the other parallel layers. It must then not
+   * touch the root console or any state shared with other modules.
+   */
+  bool parallel{false};
+  /**
+   * Whether the module records draw commands with <code>recordDraw()</code> instead of drawing on the root console with
+   * <code>render()</code>. The commands of consecutive recording modules are rasterised together, in parallel screen
+   * tiles. Ignored for layered modules.
+   */
+  bool recorded{false};
+  /**
+   * Opacity of the layer's foreground colours when it is blended over the modules under it.
+   */
+  float foregroundAlpha{1.0f};
+  /**
+   * Opacity of the layer's background colours when it is blended over the modules under it.
+   */
+  float backgroundAlpha{1.0f};
+  /**
+   * The part of the root console the module draws on. An empty rectangle stands for the whole console.
+   */
+  base::Rect bounds{};
+  /**
+   * The part of the root console the module covers completely, hiding the modules under it. Modules hidden by opaque
+   * regions aren't rendered at all. Only taken into account for fully opaque layers.
+   */
+  base::Rect opaqueRegion{};
+};
+
+/**
+ * The ways of going from one screen to the next.
+ */
+enum TransitionType {
+  TRANSITION_NONE,  // cut straight to the next screen
+  TRANSITION_CROSSFADE,  // blend the screens
+  TRANSITION_FADE,  // fade the first screen to a colour, then the colour to the next screen
+  TRANSITION_WIPE,  // uncover the next screen from left to right
+  TRANSITION_DISSOLVE,  // replace the cells of the first screen by those of the next one in random order
+};
+
+/**
+ * A transition from one screen to the next.
+ */
+struct TransitionSettings {
+  TransitionType type{TRANSITION_NONE};
+  /**
+   * The length of the transition, in milliseconds.
+   */
+  uint32_t duration{500};
+  /**
+   * The colour faded through by <code>TRANSITION_FADE</code>.
+   */
+  TCODColor colour{TCODColor::black};
+};
+
 /**
  * A module. The engine will operate on this data type exclusively, thus all logical chunks of an application need to
  * inherit this.
@@ -70,6 +141,20 @@ class Module {
    * Custom code controlling what and how is displayed on the console. Called automatically after <code>update()</code>.
    */
   virtual void render() {}  // render the module on the root console
+  /**
+   * Custom code drawing the module into its own layer, called instead of <code>render()</code> when the module's layer
+   * settings say it is layered. The layer has the size of the root console and is cleared to
+   * <code>render::Compositor::KEY_COLOUR</code> beforehand: the cells whose background keeps that colour are
+   * transparent.
+   * @param layer the module's layer console
+   */
+  virtual void renderLayer(TCODConsole&) {}
+  /**
+   * Custom code recording the module's draw commands, called instead of <code>render()</code> when the module's layer
+   * settings say it is recorded. The commands are executed once the modules above and under it have been recorded too.
+   * @param commands the module's draw list, empty
+   */
+  virtual void recordDraw(render::DrawList&) {}
   /**
    * Custom code used for updating the module's internal logic. Called automatically before <code>render()</code>.
    * @return <code>true</code> if the module should remain active, <code>false</code> if it should be deactivated.
@@ -138,43 +223,54 @@ class Module {
    * @param param_name the parameter name
    * @return the boolean value (default false)
    */
-  inline bool getBoolParam(const char* param_name) { return getParameter(param_name).value.b; }
+  inline bool getBoolParam(const char* param_name) { return getParameter(param_name).b; }
   /**
    * Get a char parameter from the module configuration file
    * @param param_name the parameter name
    * @return the char value (default '\0')
    */
-  inline int getCharParam(const char* param_name) { return getParameter(param_name).value.c; }
+  inline int getCharParam(const char* param_name) { return getParameter(param_name).c; }
   /**
    * Get an integer parameter from the module configuration file
    * @param param_name the parameter name
    * @return the integer value (default 0)
    */
-  inline int getIntParam(const char* param_name) { return getParameter(param_name).value.i; }
+  inline int getIntParam(const char* param_name) { return getParameter(param_name).i; }
   /**
    * Get a float parameter from the module configuration file
    * @param param_name the parameter name
    * @return the float value (default 0.0f)
    */
-  inline float getFloatParam(const char* param_name) { return getParameter(param_name).value.f; }
+  inline float getFloatParam(const char* param_name) { return getParameter(param_name).f; }
   /**
    * Get a string parameter from the module configuration file
    * @param param_name the parameter name
    * @return the string value (default NULL)
    */
-  inline const char* getStringParam(const char* param_name) { return getParameter(param_name).value.s; }
+  inline const char* getStringParam(const char* param_name) { return getParameter(param_name).s; }
   /**
    * Get a color parameter from the module configuration file
    * @param param_name the parameter name
    * @return the color value (default TCODColor::black)
    */
-  inline TCODColor getColourParam(const char* param_name) { return getParameter(param_name).value.col; }
+  inline TCODColor getColourParam(const char* param_name) { return getParameter(param_name).col; }
   /**
    * Get a dice parameter from the module configuration file
    * @param param_name the parameter name
    * @return the dice value (default filled with 0)
    */
-  inline TCOD_dice_t getDiceParam(const char* param_name) { return getParameter(param_name).value.dice; }
+  inline TCOD_dice_t getDiceParam(const char* param_name) { return getParameter(param_name).dice; }
+  /**
+   * Resolves a parameter once and returns a typed handle to it. Reading the handle costs a single indexed load, so
+   * modules should resolve the parameters they read every frame up front rather than using the get*Param() functions.
+   * The parameter doesn't need to be set yet: the handle reads the type's default until it is.
+   * @param name the parameter name
+   * @return a handle to the parameter
+   */
+  template <typename T>
+  ParamHandle<T> param(std::string_view name) {
+    return ParamHandle<T>{&paramValues_, resolveParameter(ParamRegistry::intern(name))};
+  }
 
   // protected:
   /**
@@ -198,6 +294,13 @@ class Module {
    * Custom code that is executed each time the module is resumed (unpaused)
    */
   virtual void onResume() {}
+  /**
+   * Custom code that is executed each time the root console changes size, for instance to reallocate offscreen
+   * consoles matching the root console. Called for all registered modules, active or not.
+   * @param width the root console's new width, in cells
+   * @param height the root console's new height, in cells
+   */
+  virtual void onResize([[maybe_unused]] int width, [[maybe_unused]] int height) {}
   /**
    * Sets the fallback module. Please refer to Umbra documentation for detailed information about fallbacks.
    * @param fback the ID of the fallback module.
@@ -220,6 +323,27 @@ class Module {
    * @param priority the module's priority
    */
   inline void setPriority(int new_priority) { priority_ = new_priority; }
+  /**
+   * Sets how the module is drawn and composited.
+   * @param settings the layer settings
+   */
+  inline void setLayer(const LayerSettings& settings) { layer_ = settings; }
+  /**
+   * Gets how the module is drawn and composited.
+   * @return the layer settings
+   */
+  inline const LayerSettings& getLayer() const { return layer_; }
+  /**
+   * Sets the transition played when the module ends: the last frame it was part of is blended into the frames of the
+   * modules that remain and of its fallback.
+   * @param settings the transition settings
+   */
+  inline void setTransition(const TransitionSettings& settings) { transition_ = settings; }
+  /**
+   * Gets the transition played when the module ends.
+   * @return the transition settings
+   */
+  inline const TransitionSettings& getTransition() const { return transition_; }
   /**
    * Set the module's name
    * @param name the module's name
@@ -238,20 +362,30 @@ class Module {
   engine::Engine* getEngine();
 
   // protected:
-  struct ModuleParameter {
-    std::string name;
-    TCOD_value_t value;
-  };
   /**
    * get a parametre (internal helper function)
+   * @return the parametre's value, zero filled if it hasn't been set
+   */
+  const TCOD_value_t& getParameter(std::string_view name);
+  /**
+   * Checks whether a parameter has been set (only used by module.txt file parser)
+   * @param name the parametre's name
+   * @return <code>true</code> if the parametre has been set, <code>false</code> otherwise
    */
-  ModuleParameter& getParameter(std::string_view name);
+  bool hasParameter(std::string_view name);
   /**
-   * Sets a parameter (only used by module.txt file parser)
+   * Sets a parameter (only used by module.txt file parser). String values are copied.
    * @param name the parametre's name
+   * @param type the parametre's type
    * @param value the parametre's value
    */
-  void setParameter(std::string_view name, TCOD_value_t value);
+  void setParameter(std::string_view name, TCOD_value_type_t type, TCOD_value_t value);
+  /**
+   * Finds the slot of a parameter in the parameter table, adding an unset one if needed (internal helper function)
+   * @param key the parametre's interned name
+   * @return the index of the parametre in the parameter table
+   */
+  size_t resolveParameter(ParamKey key);
   /**
    * Initialises the timeout by calculating the exact time when the module will time out.
    */
@@ -261,7 +395,10 @@ class Module {
    * @param currentTime the program execution elapsed time, in milliseconds
    */
   inline bool isTimedOut(uint32_t currentTime) { return (timeout_end_ > currentTime) ? false : true; }
-  std::vector<ModuleParameter> params_{};
+  // parameter table: the slot of a parameter is the same index in all three arrays
+  std::vector<ParamKey> paramKeys_{};
+  std::vector<TCOD_value_type_t> paramTypes_{};  // TCOD_TYPE_NONE if resolved but not set yet
+  std::vector<TCOD_value_t> paramValues_{};
   ModuleStatus status_{UNINITIALISED};
   int priority_{1};  // update order (inverse of render order)
   int fallback_{-1};  // fallback module's index
@@ -269,5 +406,7 @@ class Module {
   uint32_t timeout_{0};
   uint32_t timeout_end_{0xffffffff};
   std::string name_{};
+  LayerSettings layer_{};
+  TransitionSettings transition_{};
 };
 }  // namespace module
@@ -0,0 +1,92 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "module/param.hpp"
+
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+namespace module {
+namespace {
+// the strings live in deques so that their addresses never change
+struct InternTable {
+  std::shared_mutex mutex{};
+  std::deque<std::string> names{};
+  std::unordered_map<std::string_view, ParamKey> keys{};
+  std::deque<std::string> strings{};
+  std::unordered_map<std::string_view, const char*> stringLookup{};
+};
+
+InternTable& internTable() {
+  static InternTable table{};
+  return table;
+}
+}  // namespace
+
+ParamKey ParamRegistry::intern(std::string_view name) {
+  ParamKey key = 0;
+  if (find(name, key)) return key;
+  InternTable& table = internTable();
+  std::lock_guard lock{table.mutex};
+  // another thread may have interned the name between the two locks
+  if (auto it = table.keys.find(name); it != table.keys.end()) return it->second;
+  key = static_cast<ParamKey>(table.names.size());
+  table.keys.emplace(table.names.emplace_back(name), key);
+  return key;
+}
+
+bool ParamRegistry::find(std::string_view name, ParamKey& key) {
+  InternTable& table = internTable();
+  std::shared_lock lock{table.mutex};
+  const auto it = table.keys.find(name);
+  if (it == table.keys.end()) return false;
+  key = it->second;
+  return true;
+}
+
+std::string_view ParamRegistry::name(ParamKey key) {
+  InternTable& table = internTable();
+  std::shared_lock lock{table.mutex};
+  return key < table.names.size() ? std::string_view{table.names[key]} : std::string_view{};
+}
+
+const char* ParamRegistry::internString(std::string_view text) {
+  InternTable& table = internTable();
+  std::lock_guard lock{table.mutex};
+  if (auto it = table.stringLookup.find(text); it != table.stringLookup.end()) return it->second;
+  const std::string& copy = table.strings.emplace_back(text);
+  table.stringLookup.emplace(copy, copy.c_str());
+  return copy.c_str();
+}
+}  // namespace module
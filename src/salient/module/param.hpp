@@ -0,0 +1,122 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <cstdint>
+#include <libtcod/libtcod.hpp>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace module {
+/// @brief Interned identifier of a module parameter name.
+using ParamKey = uint32_t;
+
+/**
+ * Process wide table of interned parameter names and string values. Interned strings are never freed, so the pointers
+ * handed out stay valid until the program exits. Lookups share the table; only adding a string locks it exclusively.
+ */
+class ParamRegistry {
+ public:
+  /**
+   * Interns a parameter name.
+   * @param name the parameter name
+   * @return the key identifying the name
+   */
+  static ParamKey intern(std::string_view name);
+  /**
+   * Looks a parameter name up without interning it.
+   * @param name the parameter name
+   * @param key set to the key identifying the name, if it has been interned
+   * @return <code>true</code> if the name has been interned, <code>false</code> otherwise
+   */
+  static bool find(std::string_view name, ParamKey& key);
+  /**
+   * Gets the name behind an interned key.
+   * @param key a key returned by <code>intern()</code>
+   * @return the parameter name
+   */
+  static std::string_view name(ParamKey key);
+  /**
+   * Interns a string parameter value.
+   * @param text the string value
+   * @return a pointer to a copy of the string that lives until the program exits
+   */
+  static const char* internString(std::string_view text);
+};
+
+/**
+ * A typed reference to a module parameter, resolved once by <code>Module::param()</code>. Reading it is a single
+ * indexed load into the module's parameter table, with no name lookup. A handle stays valid for the lifetime of the
+ * module and always sees the current value, including values changed by a configuration reload.
+ */
+template <typename T>
+class ParamHandle {
+ public:
+  ParamHandle() = default;
+  /**
+   * Gets the current value of the parameter.
+   * @return the parameter value, or the type's default if the parameter has not been set
+   */
+  T get() const {
+    const TCOD_value_t& value = (*values_)[slot_];
+    if constexpr (std::is_same_v<T, bool>) {
+      return value.b;
+    } else if constexpr (std::is_same_v<T, char>) {
+      return value.c;
+    } else if constexpr (std::is_same_v<T, int>) {
+      return value.i;
+    } else if constexpr (std::is_same_v<T, float>) {
+      return value.f;
+    } else if constexpr (std::is_same_v<T, const char*>) {
+      return value.s;
+    } else if constexpr (std::is_same_v<T, TCODColor>) {
+      return value.col;
+    } else {
+      static_assert(std::is_same_v<T, TCOD_dice_t>, "Unsupported module parameter type.");
+      return value.dice;
+    }
+  }
+  operator T() const { return get(); }
+  /**
+   * Checks whether the handle has been resolved.
+   * @return <code>true</code> if the handle refers to a parameter, <code>false</code> if it was default constructed
+   */
+  bool isValid() const { return values_ != nullptr; }
+
+ private:
+  friend class Module;
+  ParamHandle(const std::vector<TCOD_value_t>* values, size_t slot) : values_{values}, slot_{slot} {}
+  const std::vector<TCOD_value_t>* values_{};
+  size_t slot_{};
+};
+}  // namespace module
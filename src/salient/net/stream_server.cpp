@@ -0,0 +1,524 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "net/stream_server.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+
+#include "logger/log.hpp"
+
+// the vendored zlib is built with prefixed symbols so that it cannot clash with the zlib libtcod links to
+#define Z_PREFIX
+#include "vendor/zlib/zlib.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace net {
+namespace {
+#ifdef _WIN32
+using NativeSocket = SOCKET;
+const intptr_t INVALID = static_cast<intptr_t>(INVALID_SOCKET);
+void closeSocket(intptr_t socket) { closesocket(static_cast<SOCKET>(socket)); }
+bool setNonBlocking(intptr_t socket) {
+  u_long enabled = 1;
+  return ioctlsocket(static_cast<SOCKET>(socket), FIONBIO, &enabled) == 0;
+}
+int pollSockets(pollfd* fds, size_t count, int timeout) { return WSAPoll(fds, static_cast<ULONG>(count), timeout); }
+bool wouldBlock() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+constexpr int SEND_FLAGS = 0;
+#else
+using NativeSocket = int;
+constexpr intptr_t INVALID = -1;
+void closeSocket(intptr_t socket) { close(static_cast<int>(socket)); }
+bool setNonBlocking(intptr_t socket) {
+  const int flags = fcntl(static_cast<int>(socket), F_GETFL, 0);
+  return flags >= 0 && fcntl(static_cast<int>(socket), F_SETFL, flags | O_NONBLOCK) == 0;
+}
+int pollSockets(pollfd* fds, size_t count, int timeout) { return poll(fds, count, timeout); }
+bool wouldBlock() { return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR; }
+#ifdef MSG_NOSIGNAL
+constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+constexpr int SEND_FLAGS = 0;
+#endif
+#endif
+
+// how long the server thread sleeps waiting for sockets before looking for a new frame
+constexpr int POLL_TIMEOUT_MS = 5;
+constexpr size_t MESSAGE_HEADER_SIZE = 13;
+constexpr size_t CELL_SIZE = 10;
+
+void putU16(std::vector<uint8_t>& out, uint32_t value) {
+  out.push_back(static_cast<uint8_t>(value));
+  out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void putU32(uint8_t* out, uint32_t value) {
+  for (int i = 0; i < 4; ++i) out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+void putVarint(std::vector<uint8_t>& out, uint32_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(value));
+}
+
+void putCell(std::vector<uint8_t>& out, const TCOD_ConsoleTile& tile) {
+  const size_t offset = out.size();
+  out.resize(offset + CELL_SIZE);
+  uint8_t* cell = out.data() + offset;
+  putU32(cell, static_cast<uint32_t>(tile.ch));
+  cell[4] = tile.fg.r;
+  cell[5] = tile.fg.g;
+  cell[6] = tile.fg.b;
+  cell[7] = tile.bg.r;
+  cell[8] = tile.bg.g;
+  cell[9] = tile.bg.b;
+}
+
+bool sameCell(const TCOD_ConsoleTile& a, const TCOD_ConsoleTile& b) {
+  return a.ch == b.ch && a.fg.r == b.fg.r && a.fg.g == b.fg.g && a.fg.b == b.fg.b && a.bg.r == b.bg.r &&
+         a.bg.g == b.bg.g && a.bg.b == b.bg.b;
+}
+
+uint32_t getU32(const uint8_t* in) {
+  return static_cast<uint32_t>(in[0]) | static_cast<uint32_t>(in[1]) << 8 | static_cast<uint32_t>(in[2]) << 16 |
+         static_cast<uint32_t>(in[3]) << 24;
+}
+
+// compresses a payload and prepends the message header
+std::shared_ptr<const std::vector<uint8_t>> makeMessage(
+    uint8_t type, uint32_t frameNumber, const std::vector<uint8_t>& payload) {
+  auto message = std::make_shared<std::vector<uint8_t>>(MESSAGE_HEADER_SIZE + compressBound(payload.size()));
+  uLongf compressedSize = static_cast<uLongf>(message->size() - MESSAGE_HEADER_SIZE);
+  if (compress2(message->data() + MESSAGE_HEADER_SIZE, &compressedSize, payload.data(), payload.size(), Z_BEST_SPEED) !=
+      Z_OK) {
+    return nullptr;
+  }
+  message->resize(MESSAGE_HEADER_SIZE + compressedSize);
+  (*message)[0] = type;
+  putU32(message->data() + 1, frameNumber);
+  putU32(message->data() + 5, static_cast<uint32_t>(compressedSize));
+  putU32(message->data() + 9, static_cast<uint32_t>(payload.size()));
+  return message;
+}
+}  // namespace
+
+struct ConsoleStreamServer::Client {
+  intptr_t socket{INVALID};
+  std::deque<Message> queue{};  // messages waiting to be sent, the first one possibly in part
+  size_t sentBytes{0};  // part of the first message already sent
+  size_t queuedBytes{0};
+  bool needsKeyframe{true};
+};
+
+ConsoleStreamServer::ConsoleStreamServer(size_t maxQueuedBytes) : maxQueuedBytes{maxQueuedBytes} {}
+
+ConsoleStreamServer::~ConsoleStreamServer() { stop(); }
+
+bool ConsoleStreamServer::addListener(const Listener& listener, const std::string& description) {
+  if (!setNonBlocking(listener.socket) || listen(static_cast<NativeSocket>(listener.socket), SOMAXCONN) != 0) {
+    std::vector<Listener> failed{listener};
+    closeListeners(failed);
+    logger::Log::error("ConsoleStreamServer::addListener | Could not listen on %s.", description);
+    return false;
+  }
+  {
+    // the server thread owns the listeners while it runs: it picks this one up on its next poll
+    std::lock_guard lock{listenerMutex};
+    newListeners.push_back(listener);
+  }
+  logger::Log::info("ConsoleStreamServer::addListener | Streaming the console on %s.", description);
+  if (!running) start();
+  return true;
+}
+
+void ConsoleStreamServer::adoptListeners() {
+  std::lock_guard lock{listenerMutex};
+  listeners.insert(listeners.end(), newListeners.begin(), newListeners.end());
+  newListeners.clear();
+}
+
+void ConsoleStreamServer::closeListeners(std::vector<Listener>& closing) {
+  for (const Listener& listener : closing) {
+    closeSocket(listener.socket);
+#ifndef _WIN32
+    if (!listener.unixPath.empty()) unlink(listener.unixPath.c_str());
+#endif
+  }
+  closing.clear();
+}
+
+bool ConsoleStreamServer::listenTcp(uint16_t port, bool loopbackOnly) {
+#ifdef _WIN32
+  static const bool winsockReady = [] {
+    WSADATA data;
+    return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+  }();
+  if (!winsockReady) return false;
+#endif
+  const intptr_t socket = static_cast<intptr_t>(::socket(AF_INET, SOCK_STREAM, 0));
+  const std::string description = fmt::format("TCP port {}", port);
+  if (socket == INVALID) {
+    logger::Log::error("ConsoleStreamServer::listenTcp | Could not create a socket.");
+    return false;
+  }
+  int reuse = 1;
+  setsockopt(
+      static_cast<NativeSocket>(socket),
+      SOL_SOCKET,
+      SO_REUSEADDR,
+      reinterpret_cast<const char*>(&reuse),
+      sizeof(reuse));
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = htonl(loopbackOnly ? INADDR_LOOPBACK : INADDR_ANY);
+  if (bind(static_cast<NativeSocket>(socket), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+    closeSocket(socket);
+    logger::Log::error("ConsoleStreamServer::listenTcp | Could not bind %s.", description);
+    return false;
+  }
+  return addListener(Listener{socket, {}}, description);
+}
+
+bool ConsoleStreamServer::listenUnix(const std::filesystem::path& path) {
+#ifdef _WIN32
+  logger::Log::error("ConsoleStreamServer::listenUnix | Unix domain sockets are not supported on this platform.");
+  return false;
+#else
+  sockaddr_un address{};
+  const std::string pathString = path.string();
+  if (pathString.size() >= sizeof(address.sun_path)) {
+    logger::Log::error("ConsoleStreamServer::listenUnix | The socket path \"%s\" is too long.", pathString);
+    return false;
+  }
+  const intptr_t socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (socket == INVALID) {
+    logger::Log::error("ConsoleStreamServer::listenUnix | Could not create a socket.");
+    return false;
+  }
+  address.sun_family = AF_UNIX;
+  std::memcpy(address.sun_path, pathString.c_str(), pathString.size() + 1);
+  unlink(pathString.c_str());
+  if (bind(static_cast<int>(socket), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+    closeSocket(socket);
+    logger::Log::error("ConsoleStreamServer::listenUnix | Could not bind \"%s\".", pathString);
+    return false;
+  }
+  return addListener(Listener{socket, path}, fmt::format("\"{}\"", pathString));
+#endif
+}
+
+void ConsoleStreamServer::start() {
+  running = true;
+  thread = std::thread{[this] { serverMain(); }};
+}
+
+void ConsoleStreamServer::stop() {
+  if (!running) return;
+  running = false;
+  thread.join();
+  // listeners added after the thread's last poll
+  std::lock_guard lock{listenerMutex};
+  closeListeners(newListeners);
+}
+
+void ConsoleStreamServer::submitFrame(const TCOD_Console& console) {
+  if (!running) return;
+  std::lock_guard lock{frameMutex};
+  pending.width = console.w;
+  pending.height = console.h;
+  pending.tiles.assign(console.tiles, console.tiles + console.elements);
+  hasPending = true;
+}
+
+void ConsoleStreamServer::serverMain() {
+  std::vector<pollfd> fds{};
+  while (running) {
+    adoptListeners();
+    fds.clear();
+    for (const Listener& listener : listeners) {
+      fds.push_back(pollfd{static_cast<NativeSocket>(listener.socket), POLLIN, 0});
+    }
+    for (const auto& client : clients) {
+      const short events = client->queue.empty() ? POLLIN : POLLIN | POLLOUT;
+      fds.push_back(pollfd{static_cast<NativeSocket>(client->socket), events, 0});
+    }
+    pollSockets(fds.data(), fds.size(), POLL_TIMEOUT_MS);
+    for (size_t i = 0; i < listeners.size(); ++i) {
+      if (fds[i].revents & POLLIN) acceptClients(listeners[i].socket);
+    }
+    processFrame();
+    // send what the sockets accept, drop the clients that left. Spectators aren't expected to send anything
+    const size_t polledClients = fds.size() - listeners.size();
+    for (size_t i = 0; i < clients.size(); ++i) {
+      Client& client = *clients[i];
+      bool connected = true;
+      if (i < polledClients && (fds[listeners.size() + i].revents & (POLLIN | POLLERR | POLLHUP))) {
+        char discard[256];
+        const auto received = recv(static_cast<NativeSocket>(client.socket), discard, sizeof(discard), 0);
+        connected = received > 0 || (received < 0 && wouldBlock());
+      }
+      if (connected) connected = flushClient(client);
+      if (!connected) {
+        closeSocket(client.socket);
+        client.socket = INVALID;
+      }
+    }
+    clients.erase(
+        std::remove_if(clients.begin(), clients.end(), [](const auto& client) { return client->socket == INVALID; }),
+        clients.end());
+    clientCount = clients.size();
+  }
+  for (const auto& client : clients) closeSocket(client->socket);
+  clients.clear();
+  clientCount = 0;
+  closeListeners(listeners);
+}
+
+void ConsoleStreamServer::acceptClients(intptr_t listener) {
+  for (;;) {
+    const intptr_t socket = static_cast<intptr_t>(accept(static_cast<NativeSocket>(listener), nullptr, nullptr));
+    if (socket == INVALID) return;
+    if (!setNonBlocking(socket)) {
+      closeSocket(socket);
+      continue;
+    }
+    int enabled = 1;
+    setsockopt(
+        static_cast<NativeSocket>(socket),
+        IPPROTO_TCP,
+        TCP_NODELAY,
+        reinterpret_cast<const char*>(&enabled),
+        sizeof(enabled));
+#ifdef SO_NOSIGPIPE
+    setsockopt(static_cast<NativeSocket>(socket), SOL_SOCKET, SO_NOSIGPIPE, &enabled, sizeof(enabled));
+#endif
+    auto client = std::make_unique<Client>();
+    client->socket = socket;
+    clients.emplace_back(std::move(client));
+  }
+}
+
+void ConsoleStreamServer::processFrame() {
+  Frame frame{};
+  {
+    std::lock_guard lock{frameMutex};
+    if (!hasPending) return;
+    std::swap(frame, pending);
+    hasPending = false;
+  }
+  const bool resized = frame.width != current.width || frame.height != current.height;
+  Message delta{};
+  if (!resized && !clients.empty()) {
+    std::vector<uint8_t> payload{};
+    putU16(payload, static_cast<uint32_t>(frame.width));
+    putU16(payload, static_cast<uint32_t>(frame.height));
+    uint32_t skipped = 0;
+    for (size_t i = 0; i < frame.tiles.size();) {
+      if (sameCell(frame.tiles[i], current.tiles[i])) {
+        ++skipped;
+        ++i;
+        continue;
+      }
+      size_t end = i;
+      while (end < frame.tiles.size() && !sameCell(frame.tiles[end], current.tiles[end])) ++end;
+      putVarint(payload, skipped);
+      putVarint(payload, static_cast<uint32_t>(end - i));
+      for (; i < end; ++i) putCell(payload, frame.tiles[i]);
+      skipped = 0;
+    }
+    delta = makeMessage('D', frameNumber + 1, payload);
+  }
+  // keep the old buffer around as the next pending one, to save an allocation
+  std::swap(current, frame);
+  {
+    std::lock_guard lock{frameMutex};
+    if (!hasPending) std::swap(pending, frame);
+  }
+  ++frameNumber;
+  currentKeyframe.reset();
+  for (const auto& client : clients) {
+    if (resized || !delta) client->needsKeyframe = true;
+    if (client->needsKeyframe) {
+      // wait until the client has caught up before sending a full frame
+      if (client->queuedBytes == 0 || (client->queue.size() == 1 && client->sentBytes > 0)) {
+        const Message message = keyframe();
+        if (message) {
+          queueMessage(*client, message);
+          client->needsKeyframe = false;
+        }
+      }
+    } else {
+      queueMessage(*client, delta);
+    }
+  }
+}
+
+ConsoleStreamServer::Message ConsoleStreamServer::keyframe() {
+  if (currentKeyframe) return currentKeyframe;
+  std::vector<uint8_t> payload{};
+  payload.reserve(4 + current.tiles.size() * CELL_SIZE);
+  putU16(payload, static_cast<uint32_t>(current.width));
+  putU16(payload, static_cast<uint32_t>(current.height));
+  for (const auto& tile : current.tiles) putCell(payload, tile);
+  currentKeyframe = makeMessage('K', frameNumber, payload);
+  return currentKeyframe;
+}
+
+void ConsoleStreamServer::queueMessage(Client& client, const Message& message) {
+  if (client.queuedBytes + message->size() > maxQueuedBytes && !client.queue.empty()) {
+    // the client is behind: drop what it hasn't started receiving and resynchronise it with a keyframe later on
+    const bool inFlight = client.sentBytes > 0;
+    while (client.queue.size() > (inFlight ? 1u : 0u)) {
+      client.queuedBytes -= client.queue.back()->size();
+      client.queue.pop_back();
+    }
+    client.needsKeyframe = true;
+    return;
+  }
+  client.queue.push_back(message);
+  client.queuedBytes += message->size();
+}
+
+bool ConsoleStreamServer::flushClient(Client& client) {
+  while (!client.queue.empty()) {
+    const std::vector<uint8_t>& message = *client.queue.front();
+    const auto sent = send(
+        static_cast<NativeSocket>(client.socket),
+        reinterpret_cast<const char*>(message.data() + client.sentBytes),
+        static_cast<int>(message.size() - client.sentBytes),
+        SEND_FLAGS);
+    if (sent < 0) return wouldBlock();
+    client.sentBytes += static_cast<size_t>(sent);
+    if (client.sentBytes < message.size()) return true;
+    client.queuedBytes -= message.size();
+    client.sentBytes = 0;
+    client.queue.pop_front();
+  }
+  return true;
+}
+
+bool ConsoleStreamDecoder::feed(const uint8_t* data, size_t size) {
+  buffer.insert(buffer.end(), data, data + size);
+  size_t offset = 0;
+  bool valid = true;
+  while (valid && buffer.size() - offset >= MESSAGE_HEADER_SIZE) {
+    const uint8_t* header = buffer.data() + offset;
+    const uint32_t compressedSize = getU32(header + 5);
+    const uint32_t rawSize = getU32(header + 9);
+    if (buffer.size() - offset - MESSAGE_HEADER_SIZE < compressedSize) break;  // wait for the rest of the message
+    std::vector<uint8_t> payload(rawSize);
+    uLongf payloadSize = rawSize;
+    valid = uncompress(payload.data(), &payloadSize, header + MESSAGE_HEADER_SIZE, compressedSize) == Z_OK &&
+            payloadSize == rawSize;
+    if (valid) {
+      frameNumber = getU32(header + 1);
+      valid = decodeMessage(header[0], payload);
+    }
+    offset += MESSAGE_HEADER_SIZE + compressedSize;
+  }
+  buffer.erase(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(std::min(offset, buffer.size())));
+  return valid;
+}
+
+bool ConsoleStreamDecoder::decodeMessage(uint8_t type, const std::vector<uint8_t>& payload) {
+  if (payload.size() < 4) return false;
+  const int width = payload[0] | payload[1] << 8;
+  const int height = payload[2] | payload[3] << 8;
+  size_t offset = 4;
+  const auto readCell = [&](TCOD_ConsoleTile& tile) {
+    if (payload.size() - offset < CELL_SIZE) return false;
+    const uint8_t* cell = payload.data() + offset;
+    tile.ch = static_cast<int>(getU32(cell));
+    tile.fg = TCOD_ColorRGBA{cell[4], cell[5], cell[6], 255};
+    tile.bg = TCOD_ColorRGBA{cell[7], cell[8], cell[9], 255};
+    offset += CELL_SIZE;
+    return true;
+  };
+  const auto readVarint = [&](uint32_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 35 && offset < payload.size(); shift += 7) {
+      const uint8_t byte = payload[offset++];
+      value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) return true;
+    }
+    return false;
+  };
+  if (type == 'K') {
+    if (width <= 0 || height <= 0) return false;
+    if (console.get_width() != width || console.get_height() != height) console = tcod::Console{width, height};
+    for (auto& tile : console) {
+      if (!readCell(tile)) return false;
+    }
+    synced = true;
+    return true;
+  }
+  if (type != 'D') return false;
+  if (!synced) return true;  // joined in the middle of a resynchronisation, wait for the keyframe
+  if (console.get_width() != width || console.get_height() != height) return false;
+  TCOD_ConsoleTile* tiles = console.begin();
+  const size_t count = static_cast<size_t>(width) * height;
+  size_t index = 0;
+  while (offset < payload.size()) {
+    uint32_t skip = 0;
+    uint32_t changed = 0;
+    if (!readVarint(skip) || !readVarint(changed) || index + skip + changed > count) return false;
+    index += skip;
+    for (uint32_t i = 0; i < changed; ++i) {
+      if (!readCell(tiles[index++])) return false;
+    }
+  }
+  return true;
+}
+}  // namespace net
@@ -0,0 +1,187 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <libtcod/libtcod.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace net {
+/**
+ * Streams the root console to spectators over TCP or Unix domain sockets.
+ *
+ * The stream is a sequence of messages, all integers being little endian:
+ * <ul>
+ * <li>u8 type: 'K' for a keyframe, 'D' for a delta</li>
+ * <li>u32 frame number</li>
+ * <li>u32 size of the compressed payload</li>
+ * <li>u32 size of the payload once uncompressed</li>
+ * <li>the zlib compressed payload</li>
+ * </ul>
+ * Both payloads start with the console's width and height as u16. A keyframe then holds every cell, row by row; a
+ * delta holds runs of changed cells, each one being a varint count of unchanged cells to skip, a varint count of
+ * changed cells and the changed cells themselves. A cell is the u32 code point followed by the foreground and the
+ * background colours as three bytes each.
+ *
+ * Clients receive a keyframe when they join, then deltas. Frames are diffed, serialised and compressed on the server's
+ * thread, once for all the clients. A client that falls too far behind has its queued deltas dropped and receives a
+ * keyframe once it has caught up, so a slow spectator never holds up the others or the game.
+ */
+class ConsoleStreamServer {
+ public:
+  /**
+   * Creates a server. It doesn't accept connections until one of the listen functions is called.
+   * @param maxQueuedBytes the amount of data queued for a client past which it is considered to be behind
+   */
+  explicit ConsoleStreamServer(size_t maxQueuedBytes = 1 << 20);
+  ~ConsoleStreamServer();
+  ConsoleStreamServer(const ConsoleStreamServer&) = delete;
+  ConsoleStreamServer& operator=(const ConsoleStreamServer&) = delete;
+  /**
+   * Accepts spectators on a TCP port. Can be combined with <code>listenUnix()</code> and called while the server
+   * runs: the clients already connected are kept.
+   * @param port the port to listen on
+   * @param loopbackOnly <code>true</code> to only accept connections from the local machine
+   * @return <code>true</code> if the server is listening, <code>false</code> otherwise
+   */
+  bool listenTcp(uint16_t port, bool loopbackOnly = true);
+  /**
+   * Accepts spectators on a Unix domain socket. Not available on Windows. Can be combined with
+   * <code>listenTcp()</code> and called while the server runs.
+   * @param path the path of the socket, replaced if it exists and removed when the server stops
+   * @return <code>true</code> if the server is listening, <code>false</code> otherwise
+   */
+  bool listenUnix(const std::filesystem::path& path);
+  /**
+   * Disconnects every client and stops listening.
+   */
+  void stop();
+  /**
+   * Checks whether the server is listening.
+   * @return <code>true</code> if the server is listening, <code>false</code> otherwise
+   */
+  bool isRunning() const { return running; }
+  /**
+   * Gets the number of connected clients.
+   * @return the number of connected clients
+   */
+  size_t getClientCount() const { return clientCount; }
+  /**
+   * Hands a frame over to the server thread. Only the cells are copied on the calling thread. If the server hasn't
+   * processed the previous frame yet, it is replaced.
+   * @param console the console to be streamed
+   */
+  void submitFrame(const TCOD_Console& console);
+
+ private:
+  struct Client;
+  struct Frame {
+    int width{};
+    int height{};
+    std::vector<TCOD_ConsoleTile> tiles{};
+  };
+  using Message = std::shared_ptr<const std::vector<uint8_t>>;
+  struct Listener {
+    intptr_t socket{};
+    std::filesystem::path unixPath{};  // the socket file bound by this server, removed when it stops
+  };
+  bool addListener(const Listener& listener, const std::string& description);
+  /**
+   * Hands the listeners added by the listen functions over to the server thread.
+   */
+  void adoptListeners();
+  /**
+   * Closes listeners and removes the socket files they bound.
+   * @param closing the listeners
+   */
+  static void closeListeners(std::vector<Listener>& closing);
+  void start();
+  void serverMain();
+  void acceptClients(intptr_t listener);
+  void processFrame();
+  Message keyframe();
+  void queueMessage(Client& client, const Message& message);
+  bool flushClient(Client& client);
+
+  const size_t maxQueuedBytes;
+  std::vector<Listener> listeners{};  // only touched by the server thread
+  std::mutex listenerMutex{};
+  std::vector<Listener> newListeners{};  // added while the server runs, adopted by the server thread
+  std::vector<std::unique_ptr<Client>> clients{};  // only touched by the server thread
+  std::atomic<size_t> clientCount{0};
+  std::atomic<bool> running{false};
+  std::thread thread{};
+  std::mutex frameMutex{};
+  Frame pending{};  // latest frame submitted by the main thread
+  bool hasPending{false};
+  Frame current{};  // the last frame processed by the server thread
+  uint32_t frameNumber{0};
+  Message currentKeyframe{};  // keyframe of the current frame, built when a client needs it
+};
+
+/**
+ * Applies the messages of a console stream to a console, for spectator programs and tests.
+ */
+class ConsoleStreamDecoder {
+ public:
+  /**
+   * Decodes received bytes. Messages may be split across calls.
+   * @param data the received bytes
+   * @param size the number of received bytes
+   * @return <code>false</code> if the stream is corrupted, <code>true</code> otherwise
+   */
+  bool feed(const uint8_t* data, size_t size);
+  /**
+   * Gets the console as of the last decoded message.
+   * @return the console, empty until a keyframe has been decoded
+   */
+  const tcod::Console& getConsole() const { return console; }
+  /**
+   * Gets the number of the last decoded frame.
+   * @return the frame number
+   */
+  uint32_t getFrameNumber() const { return frameNumber; }
+
+ private:
+  bool decodeMessage(uint8_t type, const std::vector<uint8_t>& payload);
+  std::vector<uint8_t> buffer{};
+  tcod::Console console{};
+  uint32_t frameNumber{0};
+  bool synced{false};
+};
+}  // namespace net
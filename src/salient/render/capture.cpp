@@ -0,0 +1,201 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "render/capture.hpp"
+
+#include <fmt/format.h>
+
+#include <cstdlib>
+#include <cstring>
+
+#include "logger/log.hpp"
+
+// lodepng is compiled as C, without its C++ wrapper
+#define LODEPNG_NO_COMPILE_CPP
+extern "C" {
+#include "vendor/lodepng.h"
+}
+
+namespace render {
+FrameCapture::FrameCapture(size_t maxPendingFrames)
+    : maxPendingFrames{maxPendingFrames > 0 ? maxPendingFrames : 1}, encoder{[this] { encoderMain(); }} {}
+
+FrameCapture::~FrameCapture() {
+  {
+    std::lock_guard lock{mutex};
+    stopping = true;
+  }
+  queueCondition.notify_all();
+  encoder.join();
+}
+
+Framebuffer FrameCapture::acquireFrame() {
+  std::lock_guard lock{mutex};
+  if (freeFrames.empty()) return {};
+  Framebuffer frame = std::move(freeFrames.back());
+  freeFrames.pop_back();
+  return frame;
+}
+
+void FrameCapture::saveScreenshot(Framebuffer frame, std::filesystem::path filename) {
+  std::unique_lock lock{mutex};
+  roomCondition.wait(lock, [this] { return queue.size() < maxPendingFrames; });
+  queue.emplace_back(Job{std::move(frame), std::move(filename), CAPTURE_PNG, 0});
+  lock.unlock();
+  queueCondition.notify_one();
+}
+
+void FrameCapture::startSequence(std::filesystem::path directory, int interval, CaptureFormat format) {
+  std::error_code error;
+  std::filesystem::create_directories(directory, error);
+  sequenceDirectory = std::move(directory);
+  sequenceInterval = interval > 0 ? interval : 1;
+  sequenceFormat = format;
+  sequenceFrames = 0;
+  capturedFrames = 0;
+  droppedFrames = 0;
+  logger::Log::info(
+      "FrameCapture::startSequence | Capturing one frame out of %d to \"%s\".",
+      sequenceInterval,
+      sequenceDirectory.string());
+}
+
+void FrameCapture::stopSequence() {
+  if (!isCapturingSequence()) return;
+  sequenceInterval = 0;
+  {
+    std::lock_guard lock{mutex};
+    queue.emplace_back(Job{Framebuffer{}, {}, sequenceFormat, capturedFrames, true});
+  }
+  queueCondition.notify_one();
+  logger::Log::info(
+      "FrameCapture::stopSequence | Captured %d frames, dropped %d.",
+      static_cast<int>(capturedFrames),
+      static_cast<int>(droppedFrames));
+}
+
+bool FrameCapture::nextSequenceFrame() {
+  return isCapturingSequence() && sequenceFrames++ % static_cast<uint32_t>(sequenceInterval) == 0;
+}
+
+bool FrameCapture::submitSequenceFrame(Framebuffer frame) {
+  std::unique_lock lock{mutex};
+  if (queue.size() >= maxPendingFrames) {
+    // the encoder is behind: drop the frame rather than stalling the game
+    ++droppedFrames;
+    freeFrames.emplace_back(std::move(frame));
+    return false;
+  }
+  const std::filesystem::path filename = sequenceFormat == CAPTURE_RAW
+                                             ? sequenceDirectory / "capture.raw"
+                                             : sequenceDirectory / fmt::format("frame{:06}.png", capturedFrames);
+  queue.emplace_back(Job{std::move(frame), filename, sequenceFormat, capturedFrames++});
+  lock.unlock();
+  queueCondition.notify_one();
+  return true;
+}
+
+void FrameCapture::reportErrors() {
+  std::vector<std::string> reported;
+  {
+    std::lock_guard lock{mutex};
+    if (errors.empty()) return;
+    reported.swap(errors);
+  }
+  for (const auto& error : reported) logger::Log::error("FrameCapture::reportErrors | %s", error);
+}
+
+void FrameCapture::encoderMain() {
+  for (;;) {
+    Job job;
+    {
+      std::unique_lock lock{mutex};
+      queueCondition.wait(lock, [this] { return stopping || !queue.empty(); });
+      if (queue.empty()) break;  // stopping, and nothing left to encode
+      job = std::move(queue.front());
+      queue.pop_front();
+    }
+    roomCondition.notify_one();
+    if (job.endsSequence) {
+      rawFile.close();
+      continue;
+    }
+    encode(job);
+    std::lock_guard lock{mutex};
+    job.frame.pixels.clear();  // keeps the memory for the next frame
+    freeFrames.emplace_back(std::move(job.frame));
+  }
+  rawFile.close();
+}
+
+void FrameCapture::encode(Job& job) {
+  const Framebuffer& frame = job.frame;
+  if (frame.width <= 0 || frame.height <= 0) return;
+  std::string error{};
+  if (job.format == CAPTURE_PNG) {
+    unsigned char* png = nullptr;
+    size_t pngSize = 0;
+    const unsigned result = lodepng_encode32(
+        &png,
+        &pngSize,
+        reinterpret_cast<const unsigned char*>(frame.pixels.data()),
+        static_cast<unsigned>(frame.width),
+        static_cast<unsigned>(frame.height));
+    if (result == 0) {
+      std::ofstream out{job.filename, std::ios::binary | std::ios::trunc};
+      out.write(reinterpret_cast<const char*>(png), static_cast<std::streamsize>(pngSize));
+      if (!out) error = fmt::format("Could not write \"{}\".", job.filename.string());
+    } else {
+      error = fmt::format("Could not encode \"{}\": {}", job.filename.string(), lodepng_error_text(result));
+    }
+    free(png);
+  } else {
+    // the first frame of a sequence starts a new file, even if the previous sequence used the same one
+    if (job.frameNumber == 0 || job.filename != rawFilename || !rawFile.is_open()) {
+      rawFile.close();
+      rawFile.open(job.filename, std::ios::binary | std::ios::trunc);
+      rawFilename = job.filename;
+    }
+    const uint32_t header[3] = {
+        job.frameNumber, static_cast<uint32_t>(frame.width), static_cast<uint32_t>(frame.height)};
+    rawFile.write("SRAW", 4);
+    rawFile.write(reinterpret_cast<const char*>(header), sizeof(header));
+    rawFile.write(
+        reinterpret_cast<const char*>(frame.pixels.data()),
+        static_cast<std::streamsize>(frame.pixels.size() * sizeof(TCOD_ColorRGBA)));
+    if (!rawFile) error = fmt::format("Could not write \"{}\".", job.filename.string());
+  }
+  if (!error.empty()) {
+    std::lock_guard lock{mutex};
+    errors.emplace_back(std::move(error));
+  }
+}
+}  // namespace render
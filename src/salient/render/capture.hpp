@@ -0,0 +1,159 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "render/software_renderer.hpp"
+
+namespace render {
+/**
+ * File formats of captured frames.
+ */
+enum CaptureFormat {
+  /**
+   * One PNG file per frame.
+   */
+  CAPTURE_PNG,
+  /**
+   * A single file of uncompressed frames, each preceded by a 16 byte header: the characters "SRAW", then the frame
+   * number, width and height as native 32 bit unsigned integers. Cheap enough to keep up with every frame.
+   */
+  CAPTURE_RAW
+};
+
+/**
+ * Encodes screenshots and captured frame sequences on a background thread, so that the main thread only pays for
+ * copying the frame. Frame buffers are recycled once encoded. At most a fixed number of frames wait for the encoder:
+ * past that, sequence frames are dropped and counted while screenshots wait for room, as they must not be lost.
+ */
+class FrameCapture {
+ public:
+  /**
+   * Starts the encoder thread.
+   * @param maxPendingFrames the number of frames that may wait for the encoder
+   */
+  explicit FrameCapture(size_t maxPendingFrames = 4);
+  /**
+   * Encodes the frames still waiting and stops the encoder thread.
+   */
+  ~FrameCapture();
+  FrameCapture(const FrameCapture&) = delete;
+  FrameCapture& operator=(const FrameCapture&) = delete;
+  /**
+   * Gets a frame buffer to copy a frame into, recycled from an already encoded frame when possible.
+   * @return an empty frame buffer, possibly with memory already reserved
+   */
+  Framebuffer acquireFrame();
+  /**
+   * Queues a screenshot, waiting for room if the encoder is behind.
+   * @param frame the frame to be saved
+   * @param filename the PNG file to be written
+   */
+  void saveScreenshot(Framebuffer frame, std::filesystem::path filename);
+  /**
+   * Starts capturing a sequence of frames.
+   * @param directory the directory the frames are written to
+   * @param interval capture one frame out of <code>interval</code>
+   * @param format the file format of the frames
+   */
+  void startSequence(std::filesystem::path directory, int interval, CaptureFormat format);
+  /**
+   * Stops capturing the sequence of frames. The frames already queued are still written, then the sequence's files
+   * are closed.
+   */
+  void stopSequence();
+  /**
+   * Checks whether a sequence of frames is being captured.
+   * @return <code>true</code> if a sequence is being captured, <code>false</code> otherwise
+   */
+  bool isCapturingSequence() const { return sequenceInterval > 0; }
+  /**
+   * Counts a frame of the sequence. Call once per frame while a sequence is being captured.
+   * @return <code>true</code> if this frame is to be captured and passed to <code>submitSequenceFrame()</code>
+   */
+  bool nextSequenceFrame();
+  /**
+   * Queues a frame of the sequence, or drops it if the encoder is behind.
+   * @param frame the captured frame
+   * @return <code>true</code> if the frame has been queued, <code>false</code> if it has been dropped
+   */
+  bool submitSequenceFrame(Framebuffer frame);
+  /**
+   * Gets the number of sequence frames dropped because the encoder was behind.
+   * @return the number of dropped frames since the sequence started
+   */
+  size_t getDroppedFrames() const { return droppedFrames; }
+  /**
+   * Logs the errors the encoder ran into since the last call. Call from the main thread.
+   */
+  void reportErrors();
+
+ private:
+  struct Job {
+    Framebuffer frame;
+    std::filesystem::path filename;
+    CaptureFormat format;
+    uint32_t frameNumber;
+    bool endsSequence{false};  // a marker without a frame, closing the sequence's files
+  };
+  void encoderMain();
+  void encode(Job& job);
+
+  const size_t maxPendingFrames;
+  std::deque<Job> queue{};
+  std::vector<Framebuffer> freeFrames{};
+  std::vector<std::string> errors{};
+  std::mutex mutex{};
+  std::condition_variable queueCondition{};  // a job has been queued
+  std::condition_variable roomCondition{};  // a job has been taken
+  bool stopping{false};
+  std::thread encoder{};
+  std::ofstream rawFile{};  // only touched by the encoder thread
+  std::filesystem::path rawFilename{};
+  std::filesystem::path sequenceDirectory{};
+  int sequenceInterval{0};
+  CaptureFormat sequenceFormat{CAPTURE_PNG};
+  uint32_t sequenceFrames{0};
+  uint32_t capturedFrames{0};
+  size_t droppedFrames{0};
+};
+}  // namespace render
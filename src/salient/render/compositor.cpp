@@ -0,0 +1,162 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "render/compositor.hpp"
+
+#include <algorithm>
+
+namespace render {
+namespace {
+// the module's bounds, clipped to the root console
+base::Rect clip(const base::Rect& rect, int width, int height) {
+  if (rect.w <= 0 || rect.h <= 0) return base::Rect{0, 0, width, height};
+  const int x = std::clamp(rect.x, 0, width);
+  const int y = std::clamp(rect.y, 0, height);
+  return base::Rect{
+      x, y, std::clamp(rect.x + rect.w, 0, width) - x, std::clamp(rect.y + rect.h, 0, height) - y};
+}
+}  // namespace
+
+void Compositor::cull(const std::vector<module::Module*>& modules, int width, int height) {
+  visible.clear();
+  covered.assign(static_cast<size_t>(width) * height, 0);
+  size_t coveredCount = 0;
+  const size_t cellCount = covered.size();
+  for (module::Module* module : modules) {
+    if (coveredCount == cellCount) break;  // everything below is hidden
+    const module::LayerSettings& settings = module->getLayer();
+    const base::Rect bounds = clip(settings.bounds, width, height);
+    bool hidden = true;
+    for (int y = bounds.y; y < bounds.y + bounds.h && hidden; ++y) {
+      const uint8_t* row = covered.data() + static_cast<size_t>(y) * width;
+      hidden = std::all_of(row + bounds.x, row + bounds.x + bounds.w, [](uint8_t cell) { return cell != 0; });
+    }
+    if (hidden) continue;
+    visible.push_back(module);
+    const bool opaque = !settings.layered || (settings.foregroundAlpha >= 1.0f && settings.backgroundAlpha >= 1.0f);
+    if (!opaque || settings.opaqueRegion.w <= 0 || settings.opaqueRegion.h <= 0) continue;
+    const base::Rect region = clip(settings.opaqueRegion, width, height);
+    for (int y = region.y; y < region.y + region.h; ++y) {
+      uint8_t* row = covered.data() + static_cast<size_t>(y) * width;
+      for (int x = region.x; x < region.x + region.w; ++x) {
+        coveredCount += row[x] == 0;
+        row[x] = 1;
+      }
+    }
+  }
+  renderedCount = visible.size();
+  culledCount = modules.size() - visible.size();
+}
+
+TCODConsole& Compositor::prepareLayer(module::Module* module, int width, int height) {
+  Layer& layer = layers[module];
+  if (!layer.console || layer.console->getWidth() != width || layer.console->getHeight() != height) {
+    layer.console = std::make_unique<TCODConsole>(width, height);
+    layer.console->setKeyColor(KEY_COLOUR);
+  }
+  layer.console->setDefaultBackground(KEY_COLOUR);
+  layer.console->setDefaultForeground(TCODColor::white);
+  layer.console->clear();
+  return *layer.console;
+}
+
+void Compositor::render(const std::vector<module::Module*>& modules, jobs::JobPool& pool) {
+  TCODConsole& root = *TCODConsole::root;
+  const int width = root.getWidth();
+  const int height = root.getHeight();
+  ++frame;
+  for (module::Module* module : modules) {
+    const module::LayerSettings& settings = module->getLayer();
+    if (settings.layered || settings.recorded) layers[module].lastFrame = frame;
+  }
+  // forget the layers of the modules which aren't active anymore
+  for (auto layer = layers.begin(); layer != layers.end();) {
+    layer = layer->second.lastFrame == frame ? std::next(layer) : layers.erase(layer);
+  }
+  cull(modules, width, height);
+  // draw the layers, the parallel ones on the job pool
+  parallelLayers.clear();
+  parallelModules.clear();
+  for (module::Module* module : visible) {
+    const module::LayerSettings& settings = module->getLayer();
+    if (!settings.layered) continue;
+    TCODConsole& layer = prepareLayer(module, width, height);
+    if (settings.parallel) {
+      parallelLayers.push_back(&layer);
+      parallelModules.push_back(module);
+    } else {
+      module->renderLayer(layer);
+    }
+  }
+  if (parallelModules.size() == 1) {
+    parallelModules.front()->renderLayer(*parallelLayers.front());
+  } else if (!parallelModules.empty()) {
+    pool.parallelFor(parallelModules.size(), [this](size_t i) { parallelModules[i]->renderLayer(*parallelLayers[i]); });
+  }
+  // composite from the bottom up
+  rasterizer.resetStats();
+  for (auto module = visible.rbegin(); module != visible.rend(); ++module) {
+    const module::LayerSettings& settings = (*module)->getLayer();
+    if (!settings.layered && settings.recorded) {
+      DrawList& commands = layers[*module].commands;
+      commands.clear();
+      (*module)->recordDraw(commands);
+      pendingCommands.push_back(&commands);
+      continue;
+    }
+    flushCommands(pool);
+    if (!settings.layered) {
+      (*module)->render();
+      continue;
+    }
+    const base::Rect bounds = clip(settings.bounds, width, height);
+    if (bounds.w <= 0 || bounds.h <= 0) continue;  // libtcod would blit the whole console
+    TCODConsole::blit(
+        layers[*module].console.get(),
+        bounds.x,
+        bounds.y,
+        bounds.w,
+        bounds.h,
+        &root,
+        bounds.x,
+        bounds.y,
+        settings.foregroundAlpha,
+        settings.backgroundAlpha);
+  }
+  flushCommands(pool);
+}
+
+void Compositor::flushCommands(jobs::JobPool& pool) {
+  if (pendingCommands.empty()) return;
+  rasterizer.execute(pendingCommands, *TCOD_sys_get_internal_console(), pool);
+  pendingCommands.clear();
+}
+}  // namespace render
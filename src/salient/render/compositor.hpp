@@ -0,0 +1,115 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <cstdint>
+#include <libtcod/libtcod.hpp>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "jobs/pool.hpp"
+#include "module/module.hpp"
+#include "render/draw_list.hpp"
+
+namespace render {
+/**
+ * Renders the active modules onto the root console according to their layer settings.
+ *
+ * Modules are first culled from the top down: a module whose bounds are entirely covered by the opaque regions of the
+ * modules above it isn't rendered at all. The remaining layered modules then draw into their own layer consoles, the
+ * parallel ones on the job pool, and everything is composited from the bottom up: plain modules draw on the root
+ * console directly, layers are blended onto it with their opacity, their key coloured cells left out, and the draw
+ * commands of consecutive recording modules are rasterised together by a <code>TileRasterizer</code>.
+ */
+class Compositor {
+ public:
+  /**
+   * The background colour marking the transparent cells of a layer.
+   */
+  static inline const TCODColor KEY_COLOUR{255, 0, 255};
+  /**
+   * Renders modules onto the root console.
+   * @param modules the active modules, from the top one to the bottom one
+   * @param pool the job pool the parallel layers are drawn on
+   */
+  void render(const std::vector<module::Module*>& modules, jobs::JobPool& pool);
+  /**
+   * Gets the number of modules rendered in the last frame.
+   * @return the number of rendered modules
+   */
+  size_t getRenderedCount() const { return renderedCount; }
+  /**
+   * Gets the number of modules culled in the last frame because they were hidden.
+   * @return the number of culled modules
+   */
+  size_t getCulledCount() const { return culledCount; }
+  /**
+   * Gets the draw command counters of the last frame.
+   * @return the counters
+   */
+  const DrawStats& getDrawStats() const { return rasterizer.getStats(); }
+
+ private:
+  struct Layer {
+    std::unique_ptr<TCODConsole> console{};
+    DrawList commands{};
+    uint32_t lastFrame{};  // the last frame the module was active in
+  };
+  /**
+   * Marks the modules hidden by opaque modules above them.
+   * @param modules the active modules, from the top one to the bottom one
+   * @param width the root console's width
+   * @param height the root console's height
+   */
+  void cull(const std::vector<module::Module*>& modules, int width, int height);
+  /**
+   * Gets the layer of a module, sized like the root console and cleared.
+   */
+  TCODConsole& prepareLayer(module::Module* module, int width, int height);
+  /**
+   * Rasterises the draw commands recorded since the previous call onto the root console.
+   */
+  void flushCommands(jobs::JobPool& pool);
+
+  std::unordered_map<module::Module*, Layer> layers{};
+  std::vector<module::Module*> visible{};  // modules to be rendered, from the top one to the bottom one
+  std::vector<uint8_t> covered{};  // cells of the root console hidden by an opaque region
+  std::vector<TCODConsole*> parallelLayers{};
+  std::vector<module::Module*> parallelModules{};
+  std::vector<const DrawList*> pendingCommands{};  // draw lists waiting to be rasterised, from the bottom up
+  TileRasterizer rasterizer{};
+  uint32_t frame{};
+  size_t renderedCount{};
+  size_t culledCount{};
+};
+}  // namespace render
@@ -0,0 +1,325 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "render/draw_list.hpp"
+
+#include <algorithm>
+#include <array>
+
+namespace render {
+namespace {
+// decodes one code point, replacing invalid sequences with U+FFFD
+int decodeUtf8(std::string_view text, size_t& offset) {
+  const auto byte = static_cast<uint8_t>(text[offset++]);
+  if (byte < 0x80) return byte;
+  const int length = byte >= 0xf0 ? 3 : byte >= 0xe0 ? 2 : byte >= 0xc0 ? 1 : -1;
+  if (length < 0 || offset + length > text.size()) return 0xfffd;
+  int codepoint = byte & (0x3f >> length);
+  for (int i = 0; i < length; ++i) {
+    const auto next = static_cast<uint8_t>(text[offset]);
+    if ((next & 0xc0) != 0x80) return 0xfffd;
+    codepoint = codepoint << 6 | (next & 0x3f);
+    ++offset;
+  }
+  return codepoint;
+}
+
+TCOD_ColorRGB lerp(const TCOD_ColorRGB& from, const TCOD_ColorRGB& to, float alpha) {
+  return TCOD_ColorRGB{
+      static_cast<uint8_t>(from.r + (to.r - from.r) * alpha),
+      static_cast<uint8_t>(from.g + (to.g - from.g) * alpha),
+      static_cast<uint8_t>(from.b + (to.b - from.b) * alpha)};
+}
+
+TCOD_ColorRGB rgb(const TCOD_ColorRGBA& color) { return TCOD_ColorRGB{color.r, color.g, color.b}; }
+
+TCOD_ColorRGBA rgba(const TCOD_ColorRGB& color) { return TCOD_ColorRGBA{color.r, color.g, color.b, 255}; }
+
+base::Rect intersect(const base::Rect& a, const base::Rect& b) {
+  const int x = std::max(a.x, b.x);
+  const int y = std::max(a.y, b.y);
+  const int right = std::min(a.x + a.w, b.x + b.w);
+  const int bottom = std::min(a.y + a.h, b.y + b.h);
+  return base::Rect{x, y, std::max(0, right - x), std::max(0, bottom - y)};
+}
+
+constexpr uint8_t SET_ALL = DrawList::SET_CHAR | DrawList::SET_FOREGROUND | DrawList::SET_BACKGROUND;
+}  // namespace
+
+void DrawList::clear() {
+  commands.clear();
+  codepoints.clear();
+}
+
+void DrawList::fill(const base::Rect& rect, const TCOD_ColorRGB& bg) {
+  Command& command = commands.emplace_back();
+  command.rect = rect;
+  command.type = COMMAND_FILL;
+  command.flags = SET_BACKGROUND;
+  command.bg = bg;
+}
+
+void DrawList::fill(const base::Rect& rect, int ch, const TCOD_ColorRGB& fg, const TCOD_ColorRGB& bg) {
+  Command& command = commands.emplace_back();
+  command.rect = rect;
+  command.type = COMMAND_FILL;
+  command.flags = SET_ALL;
+  command.ch = ch;
+  command.fg = fg;
+  command.bg = bg;
+}
+
+void DrawList::print(int x, int y, std::string_view text, const TCOD_ColorRGB& fg, TCOD_alignment_t alignment) {
+  for (size_t start = 0; start <= text.size(); ++y) {
+    const size_t end = std::min(text.find('\n', start), text.size());
+    printLine(x, y, text.substr(start, end - start), fg, nullptr, alignment);
+    start = end + 1;
+  }
+}
+
+void DrawList::print(
+    int x,
+    int y,
+    std::string_view text,
+    const TCOD_ColorRGB& fg,
+    const TCOD_ColorRGB& bg,
+    TCOD_alignment_t alignment) {
+  for (size_t start = 0; start <= text.size(); ++y) {
+    const size_t end = std::min(text.find('\n', start), text.size());
+    printLine(x, y, text.substr(start, end - start), fg, &bg, alignment);
+    start = end + 1;
+  }
+}
+
+void DrawList::printLine(
+    int x, int y, std::string_view line, const TCOD_ColorRGB& fg, const TCOD_ColorRGB* bg, TCOD_alignment_t alignment) {
+  const size_t first = codepoints.size();
+  for (size_t offset = 0; offset < line.size();) codepoints.push_back(decodeUtf8(line, offset));
+  addText(x, y, first, fg, bg, alignment);
+}
+
+void DrawList::printNumber(int x, int y, int64_t value, const TCOD_ColorRGB& fg, TCOD_alignment_t alignment) {
+  int glyphs[NUMBER_GLYPHS];
+  const size_t first = codepoints.size();
+  codepoints.insert(codepoints.end(), glyphs, glyphs + formatNumber(value, glyphs));
+  addText(x, y, first, fg, nullptr, alignment);
+}
+
+void DrawList::addText(
+    int x, int y, size_t first, const TCOD_ColorRGB& fg, const TCOD_ColorRGB* bg, TCOD_alignment_t alignment) {
+  const int length = static_cast<int>(codepoints.size() - first);
+  if (length == 0) return;
+  if (alignment == TCOD_CENTER) x -= length / 2;
+  if (alignment == TCOD_RIGHT) x -= length - 1;
+  Command& command = commands.emplace_back();
+  command.rect = base::Rect{x, y, length, 1};
+  command.type = COMMAND_TEXT;
+  command.flags = SET_CHAR | SET_FOREGROUND | (bg ? SET_BACKGROUND : 0);
+  command.ch = static_cast<int>(first);
+  command.length = length;
+  command.fg = fg;
+  if (bg) command.bg = *bg;
+}
+
+void DrawList::frame(
+    const base::Rect& rect, const TCOD_ColorRGB& fg, const TCOD_ColorRGB& bg, std::string_view title, bool clear) {
+  if (rect.w <= 0 || rect.h <= 0) return;
+  const int right = rect.x + rect.w - 1;
+  const int bottom = rect.y + rect.h - 1;
+  if (clear && rect.w > 2 && rect.h > 2) fill(base::Rect{rect.x + 1, rect.y + 1, rect.w - 2, rect.h - 2}, ' ', fg, bg);
+  fill(base::Rect{rect.x + 1, rect.y, rect.w - 2, 1}, 0x2500, fg, bg);
+  fill(base::Rect{rect.x + 1, bottom, rect.w - 2, 1}, 0x2500, fg, bg);
+  fill(base::Rect{rect.x, rect.y + 1, 1, rect.h - 2}, 0x2502, fg, bg);
+  fill(base::Rect{right, rect.y + 1, 1, rect.h - 2}, 0x2502, fg, bg);
+  fill(base::Rect{rect.x, rect.y, 1, 1}, 0x250c, fg, bg);
+  fill(base::Rect{right, rect.y, 1, 1}, 0x2510, fg, bg);
+  fill(base::Rect{rect.x, bottom, 1, 1}, 0x2514, fg, bg);
+  fill(base::Rect{right, bottom, 1, 1}, 0x2518, fg, bg);
+  if (!title.empty() && rect.w > 2) {
+    const size_t before = commands.size();
+    printLine(rect.x + rect.w / 2, rect.y, title, bg, &fg, TCOD_CENTER);
+    // keep the title on the top edge, between the corners
+    if (commands.size() > before) {
+      Command& command = commands.back();
+      const base::Rect clipped = intersect(command.rect, base::Rect{rect.x + 1, rect.y, rect.w - 2, 1});
+      command.ch += clipped.x - command.rect.x;
+      command.length = clipped.w;
+      command.rect = clipped;
+    }
+  }
+}
+
+void DrawList::blit(const TCODImage& image, const base::Rect& rect) {
+  Command& command = commands.emplace_back();
+  command.rect = rect;
+  command.type = COMMAND_IMAGE;
+  command.flags = SET_BACKGROUND;
+  command.source = &image;
+}
+
+void DrawList::blit(
+    const TCOD_Console& console, const base::Rect& source, int x, int y, float foregroundAlpha, float backgroundAlpha) {
+  base::Rect area = source.w > 0 && source.h > 0 ? source : base::Rect{0, 0, console.w, console.h};
+  area = intersect(area, base::Rect{0, 0, console.w, console.h});
+  Command& command = commands.emplace_back();
+  command.rect = base::Rect{x, y, area.w, area.h};
+  command.type = COMMAND_CONSOLE;
+  command.flags = SET_ALL;
+  command.ch = area.x;
+  command.length = area.y;
+  command.foregroundAlpha = foregroundAlpha;
+  command.backgroundAlpha = backgroundAlpha;
+  command.source = &console;
+}
+
+void TileRasterizer::execute(const std::vector<const DrawList*>& lists, TCOD_Console& target, jobs::JobPool& pool) {
+  tilesX = (target.w + TILE_SIZE - 1) / TILE_SIZE;
+  tilesY = (target.h + TILE_SIZE - 1) / TILE_SIZE;
+  const size_t tileCount = static_cast<size_t>(tilesX) * tilesY;
+  bins.resize(tileCount);
+  for (auto& bin : bins) bin.clear();
+  tileCellsWritten.assign(tileCount, 0);
+  tileCulled.assign(tileCount, 0);
+  stats.cells = static_cast<size_t>(target.w) * target.h;
+  // bin the commands, in layer and recording order
+  const base::Rect screen{0, 0, target.w, target.h};
+  for (size_t list = 0; list < lists.size(); ++list) {
+    const auto& commands = lists[list]->getCommands();
+    stats.commands += commands.size();
+    for (size_t i = 0; i < commands.size(); ++i) {
+      const base::Rect area = intersect(commands[i].rect, screen);
+      if (area.w == 0 || area.h == 0) {
+        ++stats.culled;
+        continue;
+      }
+      for (int ty = area.y / TILE_SIZE; ty <= (area.y + area.h - 1) / TILE_SIZE; ++ty) {
+        for (int tx = area.x / TILE_SIZE; tx <= (area.x + area.w - 1) / TILE_SIZE; ++tx) {
+          bins[static_cast<size_t>(ty) * tilesX + tx].push_back(
+              BinEntry{static_cast<uint32_t>(list), static_cast<uint32_t>(i)});
+          ++stats.binned;
+        }
+      }
+    }
+  }
+  pool.parallelFor(tileCount, [&](size_t tile) { executeTile(tile, lists, target); });
+  for (size_t tile = 0; tile < tileCount; ++tile) {
+    stats.cellsWritten += tileCellsWritten[tile];
+    stats.culled += tileCulled[tile];
+  }
+}
+
+void TileRasterizer::executeTile(size_t tile, const std::vector<const DrawList*>& lists, TCOD_Console& target) {
+  const std::vector<BinEntry>& bin = bins[tile];
+  if (bin.empty()) return;
+  const int tileX = static_cast<int>(tile % tilesX) * TILE_SIZE;
+  const int tileY = static_cast<int>(tile / tilesX) * TILE_SIZE;
+  const base::Rect tileRect =
+      intersect(base::Rect{tileX, tileY, TILE_SIZE, TILE_SIZE}, base::Rect{0, 0, target.w, target.h});
+  // whatever comes before the last opaque fill covering the whole tile is hidden
+  size_t first = 0;
+  for (size_t entry = bin.size(); entry-- > 0;) {
+    const DrawList::Command& command = lists[bin[entry].list]->getCommands()[bin[entry].command];
+    const base::Rect covered = intersect(command.rect, tileRect);
+    if (command.type == DrawList::COMMAND_FILL && command.flags == SET_ALL && covered.w == tileRect.w &&
+        covered.h == tileRect.h) {
+      first = entry;
+      break;
+    }
+  }
+  tileCulled[tile] = first;
+  size_t written = 0;
+  for (size_t entry = first; entry < bin.size(); ++entry) {
+    const DrawList& list = *lists[bin[entry].list];
+    const DrawList::Command& command = list.getCommands()[bin[entry].command];
+    const base::Rect area = intersect(command.rect, tileRect);
+    written += static_cast<size_t>(area.w) * area.h;
+    for (int y = area.y; y < area.y + area.h; ++y) {
+      TCOD_ConsoleTile* row = target.tiles + static_cast<size_t>(y) * target.w;
+      for (int x = area.x; x < area.x + area.w; ++x) {
+        TCOD_ConsoleTile& cell = row[x];
+        switch (command.type) {
+          case DrawList::COMMAND_FILL:
+          case DrawList::COMMAND_TEXT:
+            if (command.flags & DrawList::SET_CHAR) {
+              cell.ch = command.type == DrawList::COMMAND_FILL
+                            ? command.ch
+                            : list.getCodepoints()[command.ch + x - command.rect.x];
+            }
+            if (command.flags & DrawList::SET_FOREGROUND) cell.fg = rgba(command.fg);
+            if (command.flags & DrawList::SET_BACKGROUND) cell.bg = rgba(command.bg);
+            break;
+          case DrawList::COMMAND_IMAGE: {
+            const auto& image = *static_cast<const TCODImage*>(command.source);
+            int width = 0;
+            int height = 0;
+            image.getSize(&width, &height);
+            const int px = (x - command.rect.x) * width / command.rect.w;
+            const int py = (y - command.rect.y) * height / command.rect.h;
+            const TCODColor pixel = image.getPixel(px, py);
+            cell.bg = TCOD_ColorRGBA{pixel.r, pixel.g, pixel.b, 255};
+          } break;
+          case DrawList::COMMAND_CONSOLE: {
+            const auto& console = *static_cast<const TCOD_Console*>(command.source);
+            const TCOD_ConsoleTile& source =
+                console.tiles[(command.length + y - command.rect.y) * console.w + command.ch + x - command.rect.x];
+            if (console.has_key_color && source.bg.r == console.key_color.r && source.bg.g == console.key_color.g &&
+                source.bg.b == console.key_color.b) {
+              break;
+            }
+            // the blending rules of TCODConsole::blit
+            const float fgAlpha = command.foregroundAlpha;
+            const float bgAlpha = command.backgroundAlpha;
+            if (fgAlpha >= 1.0f && bgAlpha >= 1.0f) {
+              cell = source;
+              break;
+            }
+            cell.bg = rgba(lerp(rgb(cell.bg), rgb(source.bg), bgAlpha));
+            if (source.ch == ' ') {
+              cell.fg = rgba(lerp(rgb(cell.fg), rgb(source.bg), bgAlpha));
+            } else if (cell.ch == ' ' || cell.ch == 0) {
+              cell.ch = source.ch;
+              cell.fg = rgba(lerp(rgb(cell.bg), rgb(source.fg), fgAlpha));
+            } else if (cell.ch == source.ch) {
+              cell.fg = rgba(lerp(rgb(cell.fg), rgb(source.fg), fgAlpha));
+            } else if (fgAlpha < 0.5f) {
+              cell.fg = rgba(lerp(rgb(cell.fg), rgb(cell.bg), fgAlpha * 2.0f));
+            } else {
+              cell.ch = source.ch;
+              cell.fg = rgba(lerp(rgb(cell.bg), rgb(source.fg), (fgAlpha - 0.5f) * 2.0f));
+            }
+          } break;
+        }
+      }
+    }
+  }
+  tileCellsWritten[tile] = written;
+}
+}  // namespace render
@@ -0,0 +1,270 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <cstdint>
+#include <libtcod/libtcod.hpp>
+#include <string_view>
+#include <vector>
+
+#include "base/rect.hpp"
+#include "jobs/pool.hpp"
+#include "render/print.hpp"
+
+namespace render {
+/**
+ * A buffer of draw commands recorded by a module instead of drawing on the root console directly. Commands are kept in
+ * a compact form and executed later by a <code>TileRasterizer</code>, in recording order. Text is decoded when it is
+ * recorded. The images and consoles that are blitted must stay alive until the frame has been rendered.
+ */
+class DrawList {
+ public:
+  /**
+   * The kinds of commands.
+   */
+  enum CommandType : uint8_t { COMMAND_FILL, COMMAND_TEXT, COMMAND_IMAGE, COMMAND_CONSOLE };
+  /**
+   * What a fill or text command changes in the cells it covers.
+   */
+  enum CommandFlags : uint8_t { SET_CHAR = 1, SET_FOREGROUND = 2, SET_BACKGROUND = 4 };
+  /**
+   * A recorded command. The rectangle is the area of the root console it may change.
+   */
+  struct Command {
+    base::Rect rect{};
+    CommandType type{};
+    uint8_t flags{};
+    int ch{};  // fills: the character; text: offset of the code points; console blits: source x
+    int length{};  // text: number of code points; console blits: source y
+    TCOD_ColorRGB fg{};
+    TCOD_ColorRGB bg{};
+    float foregroundAlpha{1.0f};
+    float backgroundAlpha{1.0f};
+    const void* source{};  // the TCODImage or TCOD_Console blitted
+  };
+  /**
+   * Removes all the commands, keeping the memory for the next frame.
+   */
+  void clear();
+  /**
+   * Sets the background colour of an area.
+   * @param rect the area
+   * @param bg the background colour
+   */
+  void fill(const base::Rect& rect, const TCOD_ColorRGB& bg);
+  /**
+   * Sets the character and the colours of an area.
+   * @param rect the area
+   * @param ch the character's code point
+   * @param fg the foreground colour
+   * @param bg the background colour
+   */
+  void fill(const base::Rect& rect, int ch, const TCOD_ColorRGB& fg, const TCOD_ColorRGB& bg);
+  /**
+   * Prints text, keeping the background colour. Each line of the text is printed on its own row.
+   * @param x the <i>x</i> coordinate of the anchor
+   * @param y the <i>y</i> coordinate of the first line
+   * @param text the UTF-8 text
+   * @param fg the foreground colour
+   * @param alignment how the lines are aligned on the anchor
+   */
+  void print(int x, int y, std::string_view text, const TCOD_ColorRGB& fg, TCOD_alignment_t alignment = TCOD_LEFT);
+  /**
+   * Prints text with a background colour. Each line of the text is printed on its own row.
+   * @param x the <i>x</i> coordinate of the anchor
+   * @param y the <i>y</i> coordinate of the first line
+   * @param text the UTF-8 text
+   * @param fg the foreground colour
+   * @param bg the background colour
+   * @param alignment how the lines are aligned on the anchor
+   */
+  void print(
+      int x,
+      int y,
+      std::string_view text,
+      const TCOD_ColorRGB& fg,
+      const TCOD_ColorRGB& bg,
+      TCOD_alignment_t alignment = TCOD_LEFT);
+  /**
+   * Formats text with fmt into a buffer on the stack and prints it, keeping the background colour. The code points go
+   * straight into the list's storage, which is kept from frame to frame: nothing is allocated once it has grown.
+   * @param x the <i>x</i> coordinate of the anchor
+   * @param y the <i>y</i> coordinate of the first line
+   * @param fg the foreground colour
+   * @param alignment how the lines are aligned on the anchor
+   * @param format the fmt format string
+   * @param args the formatted values
+   */
+  template <typename... Args>
+  void printFormatted(
+      int x,
+      int y,
+      const TCOD_ColorRGB& fg,
+      TCOD_alignment_t alignment,
+      fmt::format_string<Args...> format,
+      Args&&... args) {
+    char buffer[PRINT_BUFFER_SIZE];
+    const auto result = fmt::format_to_n(buffer, sizeof(buffer), format, std::forward<Args>(args)...);
+    print(x, y, std::string_view{buffer, std::min(result.size, sizeof(buffer))}, fg, alignment);
+  }
+  /**
+   * Prints an integer, keeping the background colour, through the glyph table of <code>render::formatNumber()</code>.
+   * @param x the <i>x</i> coordinate of the anchor
+   * @param y the <i>y</i> coordinate of the number
+   * @param value the integer
+   * @param fg the foreground colour
+   * @param alignment how the number is aligned on the anchor
+   */
+  void printNumber(int x, int y, int64_t value, const TCOD_ColorRGB& fg, TCOD_alignment_t alignment = TCOD_LEFT);
+  /**
+   * Draws a single line frame, optionally with a title centered on its top edge.
+   * @param rect the area of the frame, borders included
+   * @param fg the colour of the borders
+   * @param bg the background colour
+   * @param title the title, drawn in inverted colours
+   * @param clear <code>true</code> to fill the inside of the frame with the background colour
+   */
+  void frame(
+      const base::Rect& rect,
+      const TCOD_ColorRGB& fg,
+      const TCOD_ColorRGB& bg,
+      std::string_view title = {},
+      bool clear = true);
+  /**
+   * Stretches an image over an area, one pixel per cell background.
+   * @param image the image
+   * @param rect the area
+   */
+  void blit(const TCODImage& image, const base::Rect& rect);
+  /**
+   * Blends a part of a console over the root console, the way <code>TCODConsole::blit</code> does. Cells with the
+   * console's key colour as background are left out.
+   * @param console the source console
+   * @param source the part of the source console, an empty rectangle standing for all of it
+   * @param x the <i>x</i> coordinate of the destination
+   * @param y the <i>y</i> coordinate of the destination
+   * @param foregroundAlpha the opacity of the foreground colours
+   * @param backgroundAlpha the opacity of the background colours
+   */
+  void blit(
+      const TCOD_Console& console,
+      const base::Rect& source,
+      int x,
+      int y,
+      float foregroundAlpha = 1.0f,
+      float backgroundAlpha = 1.0f);
+  /**
+   * Gets the recorded commands.
+   * @return the commands, in recording order
+   */
+  const std::vector<Command>& getCommands() const { return commands; }
+  /**
+   * Gets the decoded text of the text commands.
+   * @return the code points
+   */
+  const std::vector<int>& getCodepoints() const { return codepoints; }
+
+ private:
+  void printLine(
+      int x,
+      int y,
+      std::string_view line,
+      const TCOD_ColorRGB& fg,
+      const TCOD_ColorRGB* bg,
+      TCOD_alignment_t alignment);
+  /**
+   * Adds a text command for the code points from <code>first</code> to the end of the storage.
+   */
+  void addText(
+      int x, int y, size_t first, const TCOD_ColorRGB& fg, const TCOD_ColorRGB* bg, TCOD_alignment_t alignment);
+  std::vector<Command> commands{};
+  std::vector<int> codepoints{};
+};
+
+/**
+ * Counters of the last rasterised frame, for profiling.
+ */
+struct DrawStats {
+  size_t commands{};  // recorded commands
+  size_t binned{};  // command and tile pairs after binning
+  size_t culled{};  // command and tile pairs skipped, outside the console or hidden by an opaque fill
+  size_t cellsWritten{};  // cells changed by the commands, counting overdraw
+  size_t cells{};  // cells of the target console
+  /**
+   * Gets the average number of times a cell was written.
+   * @return the overdraw ratio
+   */
+  float overdraw() const { return cells ? static_cast<float>(cellsWritten) / cells : 0.0f; }
+};
+
+/**
+ * Executes draw lists into a console. The console is cut into square tiles; each command is binned into the tiles it
+ * touches, and the tiles are executed in parallel on the job pool, each one applying its commands in order, clipped to
+ * the tile. Commands placed in a tile before an opaque fill covering all of it are skipped.
+ */
+class TileRasterizer {
+ public:
+  /**
+   * The width and height of the tiles, in cells.
+   */
+  static constexpr int TILE_SIZE = 16;
+  /**
+   * Executes draw lists into a console, the lists being layered in order.
+   * @param lists the draw lists, from the bottom one to the top one
+   * @param target the console to draw into
+   * @param pool the job pool the tiles are spread across
+   */
+  void execute(const std::vector<const DrawList*>& lists, TCOD_Console& target, jobs::JobPool& pool);
+  /**
+   * Gets the counters of the draw lists executed since the last call to <code>resetStats()</code>.
+   * @return the counters
+   */
+  const DrawStats& getStats() const { return stats; }
+  /**
+   * Resets the counters, once per frame.
+   */
+  void resetStats() { stats = DrawStats{}; }
+
+ private:
+  struct BinEntry {
+    uint32_t list;
+    uint32_t command;
+  };
+  void executeTile(size_t tile, const std::vector<const DrawList*>& lists, TCOD_Console& target);
+  int tilesX{};
+  int tilesY{};
+  std::vector<std::vector<BinEntry>> bins{};
+  std::vector<size_t> tileCellsWritten{};
+  std::vector<size_t> tileCulled{};
+  DrawStats stats{};
+};
+}  // namespace render
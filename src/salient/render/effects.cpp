@@ -0,0 +1,262 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "render/effects.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "render/pixels.hpp"
+
+namespace render {
+namespace {
+constexpr PlanarConsole::Plane PLANES[] = {PlanarConsole::PLANE_FOREGROUND, PlanarConsole::PLANE_BACKGROUND};
+constexpr int TRAIL_MIN_BRIGHTNESS = 16;  // trails darker than this are dropped
+
+int toAlpha(float amount) { return static_cast<int>(std::clamp(amount, 0.0f, 1.0f) * 256.0f); }
+
+uint8_t toFactor(float factor) { return static_cast<uint8_t>(std::clamp(factor, 0.0f, 1.0f) * 255.0f + 0.5f); }
+
+bool isBlank(int ch) { return ch == ' ' || ch == 0; }
+}  // namespace
+
+void FadeEffect::apply(PlanarConsole& console, int firstRow, int lastRow) {
+  const int alpha = toAlpha(level);
+  if (alpha == 0) return;
+  const size_t offset = static_cast<size_t>(firstRow) * console.getWidth();
+  const size_t count = static_cast<size_t>(lastRow - firstRow) * console.getWidth();
+  const TCOD_ColorRGBA target{colour.r, colour.g, colour.b, 255};
+  for (PlanarConsole::Plane plane : PLANES) pixels::blend(console.getColours(plane) + offset, count, target, alpha);
+}
+
+void DesaturateEffect::apply(PlanarConsole& console, int firstRow, int lastRow) {
+  const int alpha = toAlpha(amount);
+  if (alpha == 0) return;
+  const size_t offset = static_cast<size_t>(firstRow) * console.getWidth();
+  const size_t count = static_cast<size_t>(lastRow - firstRow) * console.getWidth();
+  for (PlanarConsole::Plane plane : PLANES) pixels::desaturate(console.getColours(plane) + offset, count, alpha);
+}
+
+GradeEffect::GradeEffect() {
+  setGrade([](const TCODColor& colour) { return colour; });
+}
+
+void GradeEffect::setGrade(const std::function<TCODColor(const TCODColor&)>& grade) {
+  table.resize(SIZE * SIZE * SIZE);
+  for (int b = 0; b < SIZE; ++b) {
+    for (int g = 0; g < SIZE; ++g) {
+      for (int r = 0; r < SIZE; ++r) {
+        const auto sample = [](int i) { return static_cast<uint8_t>((i * 255 + (SIZE - 1) / 2) / (SIZE - 1)); };
+        const TCODColor graded = grade(TCODColor{sample(r), sample(g), sample(b)});
+        table[r + SIZE * (g + SIZE * b)] = TCOD_ColorRGB{graded.r, graded.g, graded.b};
+      }
+    }
+  }
+}
+
+bool GradeEffect::load(const char* filename) {
+  const TCODImage image{filename};
+  int width = 0;
+  int height = 0;
+  image.getSize(&width, &height);
+  if (width != SIZE * SIZE || height != SIZE) return false;
+  table.resize(SIZE * SIZE * SIZE);
+  for (int b = 0; b < SIZE; ++b) {
+    for (int g = 0; g < SIZE; ++g) {
+      for (int r = 0; r < SIZE; ++r) {
+        const TCODColor pixel = image.getPixel(b * SIZE + r, g);
+        table[r + SIZE * (g + SIZE * b)] = TCOD_ColorRGB{pixel.r, pixel.g, pixel.b};
+      }
+    }
+  }
+  return true;
+}
+
+TCOD_ColorRGBA GradeEffect::lookup(const TCOD_ColorRGBA& colour) const {
+  // split each channel into a lattice index and the weight of the next sample, out of 255
+  int index[3];
+  int weight[3];
+  const uint8_t channels[3] = {colour.r, colour.g, colour.b};
+  for (int i = 0; i < 3; ++i) {
+    const int scaled = channels[i] * (SIZE - 1);
+    index[i] = std::min(scaled / 255, SIZE - 2);
+    weight[i] = scaled - index[i] * 255;
+  }
+  const TCOD_ColorRGB* base = &table[index[0] + SIZE * (index[1] + SIZE * index[2])];
+  float result[3] = {};
+  for (int corner = 0; corner < 8; ++corner) {
+    const int dr = corner & 1;
+    const int dg = (corner >> 1) & 1;
+    const int db = corner >> 2;
+    const float w = (dr ? weight[0] : 255 - weight[0]) * (dg ? weight[1] : 255 - weight[1]) *
+                    static_cast<float>(db ? weight[2] : 255 - weight[2]);
+    const TCOD_ColorRGB& sample = base[dr + SIZE * (dg + SIZE * db)];
+    result[0] += sample.r * w;
+    result[1] += sample.g * w;
+    result[2] += sample.b * w;
+  }
+  const float norm = 1.0f / (255.0f * 255.0f * 255.0f);
+  return TCOD_ColorRGBA{
+      static_cast<uint8_t>(result[0] * norm + 0.5f),
+      static_cast<uint8_t>(result[1] * norm + 0.5f),
+      static_cast<uint8_t>(result[2] * norm + 0.5f),
+      colour.a};
+}
+
+void GradeEffect::apply(PlanarConsole& console, int firstRow, int lastRow) {
+  const size_t offset = static_cast<size_t>(firstRow) * console.getWidth();
+  const size_t count = static_cast<size_t>(lastRow - firstRow) * console.getWidth();
+  for (PlanarConsole::Plane plane : PLANES) {
+    TCOD_ColorRGBA* colours = console.getColours(plane) + offset;
+    for (size_t i = 0; i < count; ++i) colours[i] = lookup(colours[i]);
+  }
+}
+
+void VignetteEffect::setStrength(float newStrength) {
+  strength = newStrength;
+  width = 0;
+}
+
+void VignetteEffect::setRadius(float newRadius) {
+  radius = newRadius;
+  width = 0;
+}
+
+void VignetteEffect::prepare(const PlanarConsole& console) {
+  if (console.getWidth() == width && console.getHeight() == height) return;
+  width = console.getWidth();
+  height = console.getHeight();
+  factors.resize(static_cast<size_t>(width) * height);
+  const float start = std::clamp(radius, 0.0f, 0.99f);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      // distance from the centre, 1 in the corners
+      const float dx = (x + 0.5f) / width * 2.0f - 1.0f;
+      const float dy = (y + 0.5f) / height * 2.0f - 1.0f;
+      const float distance = std::sqrt((dx * dx + dy * dy) * 0.5f);
+      float t = std::clamp((distance - start) / (1.0f - start), 0.0f, 1.0f);
+      t = t * t * (3.0f - 2.0f * t);
+      const uint8_t factor = toFactor(1.0f - strength * t);
+      factors[static_cast<size_t>(y) * width + x] = TCOD_ColorRGBA{factor, factor, factor, 255};
+    }
+  }
+}
+
+void VignetteEffect::apply(PlanarConsole& console, int firstRow, int lastRow) {
+  const size_t offset = static_cast<size_t>(firstRow) * width;
+  const size_t count = static_cast<size_t>(lastRow - firstRow) * width;
+  for (PlanarConsole::Plane plane : PLANES) {
+    pixels::multiply(console.getColours(plane) + offset, factors.data() + offset, count);
+  }
+}
+
+void ScanlineEffect::apply(PlanarConsole& console, int firstRow, int lastRow) {
+  if (period <= 0) return;
+  const uint8_t factor = toFactor(1.0f - darkness);
+  const TCOD_ColorRGBA dark{factor, factor, factor, 255};
+  const int width = console.getWidth();
+  for (int y = firstRow; y < lastRow; ++y) {
+    if (y % period != period - 1) continue;
+    for (PlanarConsole::Plane plane : PLANES) {
+      pixels::multiply(console.getColours(plane) + static_cast<size_t>(y) * width, width, dark);
+    }
+  }
+}
+
+void TrailEffect::prepare(const PlanarConsole& console) {
+  if (console.getWidth() != history.getWidth() || console.getHeight() != history.getHeight()) {
+    history.resize(console.getWidth(), console.getHeight());
+  }
+}
+
+void TrailEffect::apply(PlanarConsole& console, int firstRow, int lastRow) {
+  const int width = console.getWidth();
+  const uint8_t factor = toFactor(persistence);
+  const int blur = toAlpha(backgroundBlur);
+  for (int y = firstRow; y < lastRow; ++y) {
+    const size_t row = static_cast<size_t>(y) * width;
+    int* glyphs = console.getGlyphs() + row;
+    TCOD_ColorRGBA* foreground = console.getColours(PlanarConsole::PLANE_FOREGROUND) + row;
+    TCOD_ColorRGBA* background = console.getColours(PlanarConsole::PLANE_BACKGROUND) + row;
+    int* oldGlyphs = history.getGlyphs() + row;
+    TCOD_ColorRGBA* oldForeground = history.getColours(PlanarConsole::PLANE_FOREGROUND) + row;
+    TCOD_ColorRGBA* oldBackground = history.getColours(PlanarConsole::PLANE_BACKGROUND) + row;
+    // dim the previous frame, then let it show through the blank cells
+    pixels::multiply(oldForeground, width, {factor, factor, factor, 255});
+    for (int x = 0; x < width; ++x) {
+      if (!isBlank(glyphs[x]) || isBlank(oldGlyphs[x])) continue;
+      const TCOD_ColorRGBA& trail = oldForeground[x];
+      if (std::max({trail.r, trail.g, trail.b}) < TRAIL_MIN_BRIGHTNESS) continue;
+      glyphs[x] = oldGlyphs[x];
+      foreground[x] = trail;
+    }
+    if (blur > 0) pixels::blend(background, oldBackground, width, blur);
+    std::copy_n(glyphs, width, oldGlyphs);
+    std::copy_n(foreground, width, oldForeground);
+    std::copy_n(background, width, oldBackground);
+  }
+}
+
+void EffectPipeline::remove(const Effect& effect) {
+  effects.erase(
+      std::remove_if(
+          effects.begin(),
+          effects.end(),
+          [&](const std::unique_ptr<Effect>& candidate) { return candidate.get() == &effect; }),
+      effects.end());
+}
+
+bool EffectPipeline::isActive() const {
+  return std::any_of(
+      effects.begin(), effects.end(), [](const std::unique_ptr<Effect>& effect) { return effect->getEnabled(); });
+}
+
+void EffectPipeline::apply(TCOD_Console& console, jobs::JobPool& pool) {
+  timings.clear();
+  if (!isActive()) return;
+  planes.fromConsole(console);
+  const int height = planes.getHeight();
+  const size_t bands = static_cast<size_t>((height + BAND_HEIGHT - 1) / BAND_HEIGHT);
+  for (const std::unique_ptr<Effect>& effect : effects) {
+    if (!effect->getEnabled()) continue;
+    const auto start = std::chrono::steady_clock::now();
+    effect->prepare(planes);
+    pool.parallelFor(bands, [&](size_t band) {
+      const int firstRow = static_cast<int>(band) * BAND_HEIGHT;
+      effect->apply(planes, firstRow, std::min(height, firstRow + BAND_HEIGHT));
+    });
+    const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    timings.push_back(EffectTiming{effect->getName(), elapsed.count()});
+  }
+  planes.toConsole(console);
+}
+}  // namespace render
@@ -0,0 +1,275 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <libtcod/libtcod.hpp>
+#include <memory>
+#include <vector>
+
+#include "jobs/pool.hpp"
+#include "render/planar_console.hpp"
+
+namespace render {
+/**
+ * A post-processing stage of an <code>EffectPipeline</code>, run on the whole root console after the modules have
+ * rendered. Rows are processed in bands on the job pool: <code>apply()</code> is called concurrently on disjoint rows
+ * and must only touch those rows and the effect's own per-row state.
+ */
+class Effect {
+ public:
+  virtual ~Effect() = default;
+  /**
+   * Gets the name of the effect, shown by the speedometer.
+   * @return the name
+   */
+  virtual const char* getName() const = 0;
+  /**
+   * Gets ready for a frame, for instance to resize buffers. Called on the main thread before <code>apply()</code>.
+   * @param console the console about to be processed
+   */
+  virtual void prepare(const PlanarConsole&) {}
+  /**
+   * Processes rows of the console.
+   * @param console the console
+   * @param firstRow the first row to process
+   * @param lastRow the row after the last one to process
+   */
+  virtual void apply(PlanarConsole& console, int firstRow, int lastRow) = 0;
+  /**
+   * Turns the effect on or off without removing it from its pipeline.
+   * @param enabled <code>true</code> to run the effect, <code>false</code> to skip it
+   */
+  void setEnabled(bool enabled) { this->enabled = enabled; }
+  bool getEnabled() const { return enabled; }
+
+ private:
+  bool enabled{true};
+};
+
+/**
+ * Blends the whole console towards a colour, for fading in or out.
+ */
+class FadeEffect : public Effect {
+ public:
+  /**
+   * @param colour the colour faded to
+   * @param level how far the console is faded, from 0 (not at all) to 1 (only the colour is left)
+   */
+  explicit FadeEffect(const TCODColor& colour = TCODColor::black, float level = 0.0f) : colour{colour}, level{level} {}
+  const char* getName() const override { return "fade"; }
+  void apply(PlanarConsole& console, int firstRow, int lastRow) override;
+  void setColour(const TCODColor& newColour) { colour = newColour; }
+  void setLevel(float newLevel) { level = newLevel; }
+  float getLevel() const { return level; }
+
+ private:
+  TCODColor colour{};
+  float level{};
+};
+
+/**
+ * Turns the colours of the console towards grey.
+ */
+class DesaturateEffect : public Effect {
+ public:
+  /**
+   * @param amount how much the colours are greyed, from 0 to 1
+   */
+  explicit DesaturateEffect(float amount = 1.0f) : amount{amount} {}
+  const char* getName() const override { return "desaturate"; }
+  void apply(PlanarConsole& console, int firstRow, int lastRow) override;
+  void setAmount(float newAmount) { amount = newAmount; }
+
+ private:
+  float amount{};
+};
+
+/**
+ * Grades the colours of the console through a 3D lookup table of <code>SIZE</code> samples per channel, interpolated
+ * trilinearly. The identity table is used until one is set.
+ */
+class GradeEffect : public Effect {
+ public:
+  static constexpr int SIZE = 17;
+  GradeEffect();
+  const char* getName() const override { return "grade"; }
+  void apply(PlanarConsole& console, int firstRow, int lastRow) override;
+  /**
+   * Fills the lookup table by sampling a grading function.
+   * @param grade the function giving the graded colour of a colour
+   */
+  void setGrade(const std::function<TCODColor(const TCODColor&)>& grade);
+  /**
+   * Loads the lookup table from an image laid out as a strip of <code>SIZE</code> squares of <code>SIZE</code> by
+   * <code>SIZE</code> pixels: red grows to the right in each square, green downwards and blue from one square to the
+   * next. This is the layout the usual colour grading tools export.
+   * @param filename the image file
+   * @return <code>true</code> if the table was loaded, <code>false</code> if the image doesn't have the expected size
+   */
+  bool load(const char* filename);
+
+ private:
+  /**
+   * Grades a colour.
+   */
+  TCOD_ColorRGBA lookup(const TCOD_ColorRGBA& colour) const;
+  std::vector<TCOD_ColorRGB> table{};  // SIZE * SIZE * SIZE samples, red first
+};
+
+/**
+ * Darkens the edges of the console. The darkening factors are computed once per console size.
+ */
+class VignetteEffect : public Effect {
+ public:
+  /**
+   * @param strength the darkening in the corners, from 0 to 1
+   * @param radius the distance from the centre where the darkening starts, 1 being the corners
+   */
+  explicit VignetteEffect(float strength = 0.5f, float radius = 0.5f) : strength{strength}, radius{radius} {}
+  const char* getName() const override { return "vignette"; }
+  void prepare(const PlanarConsole& console) override;
+  void apply(PlanarConsole& console, int firstRow, int lastRow) override;
+  void setStrength(float newStrength);
+  void setRadius(float newRadius);
+
+ private:
+  float strength{};
+  float radius{};
+  int width{};
+  int height{};
+  std::vector<TCOD_ColorRGBA> factors{};  // one per cell
+};
+
+/**
+ * Darkens every other row, like a CRT screen.
+ */
+class ScanlineEffect : public Effect {
+ public:
+  /**
+   * @param darkness the darkening of the dark rows, from 0 to 1
+   * @param period the number of rows between dark rows
+   */
+  explicit ScanlineEffect(float darkness = 0.25f, int period = 2) : darkness{darkness}, period{period} {}
+  const char* getName() const override { return "scanline"; }
+  void apply(PlanarConsole& console, int firstRow, int lastRow) override;
+  void setDarkness(float newDarkness) { darkness = newDarkness; }
+  void setPeriod(int newPeriod) { period = newPeriod; }
+
+ private:
+  float darkness{};
+  int period{};
+};
+
+/**
+ * Leaves fading trails behind moving glyphs: glyphs that disappear from a cell keep being drawn there, dimmer every
+ * frame, until a new glyph is drawn or they are too dark to see. The backgrounds can be blurred over time as well.
+ */
+class TrailEffect : public Effect {
+ public:
+  /**
+   * @param persistence the part of a trail's brightness kept from one frame to the next, from 0 to 1
+   * @param backgroundBlur the part of the previous frame's backgrounds mixed into the current ones, from 0 to 1
+   */
+  explicit TrailEffect(float persistence = 0.8f, float backgroundBlur = 0.0f)
+      : persistence{persistence}, backgroundBlur{backgroundBlur} {}
+  const char* getName() const override { return "trail"; }
+  void prepare(const PlanarConsole& console) override;
+  void apply(PlanarConsole& console, int firstRow, int lastRow) override;
+  void setPersistence(float newPersistence) { persistence = newPersistence; }
+  void setBackgroundBlur(float newBackgroundBlur) { backgroundBlur = newBackgroundBlur; }
+
+ private:
+  float persistence{};
+  float backgroundBlur{};
+  PlanarConsole history{};  // the output of the previous frame
+};
+
+/**
+ * The time spent in an effect during the last frame.
+ */
+struct EffectTiming {
+  const char* name{};
+  float milliseconds{};
+};
+
+/**
+ * An ordered chain of effects run on the root console before it is flushed. The console is copied into a planar
+ * console once, each enabled effect then runs over row bands on the job pool, and the result is copied back.
+ */
+class EffectPipeline {
+ public:
+  /**
+   * Adds an effect at the end of the chain.
+   * @param effect the effect, owned by the pipeline from now on
+   * @return the effect
+   */
+  template <class T>
+  T& add(std::unique_ptr<T> effect) {
+    T& added = *effect;
+    effects.push_back(std::move(effect));
+    return added;
+  }
+  /**
+   * Removes an effect from the chain, destroying it.
+   * @param effect the effect
+   */
+  void remove(const Effect& effect);
+  /**
+   * Removes all the effects.
+   */
+  void clear() { effects.clear(); }
+  /**
+   * Checks whether an effect would run.
+   * @return <code>true</code> if at least one effect is enabled, <code>false</code> otherwise
+   */
+  bool isActive() const;
+  /**
+   * Runs the enabled effects on a console.
+   * @param console the console
+   * @param pool the job pool the rows are processed on
+   */
+  void apply(TCOD_Console& console, jobs::JobPool& pool);
+  /**
+   * Gets the time spent in each enabled effect during the last <code>apply()</code>, in chain order.
+   * @return the timings
+   */
+  const std::vector<EffectTiming>& getTimings() const { return timings; }
+
+ private:
+  static constexpr int BAND_HEIGHT = 8;  // rows processed by one job
+  std::vector<std::unique_ptr<Effect>> effects{};
+  std::vector<EffectTiming> timings{};
+  PlanarConsole planes{};
+};
+}  // namespace render
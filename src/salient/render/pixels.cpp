@@ -0,0 +1,365 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "render/pixels.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SALIENT_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace render {
+namespace pixels {
+namespace {
+inline uint32_t pack(const TCOD_ColorRGBA& colour) {
+  uint32_t packed;
+  std::memcpy(&packed, &colour, sizeof(packed));
+  return packed;
+}
+
+inline uint8_t* bytes(TCOD_ColorRGBA* colours) { return reinterpret_cast<uint8_t*>(colours); }
+
+inline const uint8_t* bytes(const TCOD_ColorRGBA* colours) { return reinterpret_cast<const uint8_t*>(colours); }
+
+// x * f / 255, rounded, for x and f in [0, 255]
+inline uint8_t scale(int x, int f) {
+  const int t = x * f + 128;
+  return static_cast<uint8_t>((t + (t >> 8)) >> 8);
+}
+
+// a + (b - a) * alpha / 256, for alpha in [0, 256]
+inline uint8_t mix(int a, int b, int alpha) { return static_cast<uint8_t>((a * (256 - alpha) + b * alpha) >> 8); }
+
+// select() on any 32-bit elements
+void selectWords(uint32_t* dst, const uint32_t* src, const uint8_t* keys, int level, size_t count) {
+  if (level > 255) return;
+  size_t i = 0;
+#if defined(__AVX2__)
+  const __m256i threshold = _mm256_set1_epi32(level - 1);
+  for (; i + 8 <= count; i += 8) {
+    const __m256i key = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(keys + i)));
+    const __m256i mask = _mm256_cmpgt_epi32(key, threshold);
+    __m256i* d = reinterpret_cast<__m256i*>(dst + i);
+    const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    _mm256_storeu_si256(d, _mm256_blendv_epi8(_mm256_loadu_si256(d), s, mask));
+  }
+#elif defined(SALIENT_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i threshold = _mm_set1_epi32(level - 1);
+  for (; i + 4 <= count; i += 4) {
+    int32_t packedKeys;
+    std::memcpy(&packedKeys, keys + i, sizeof(packedKeys));
+    const __m128i key = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packedKeys), zero), zero);
+    const __m128i mask = _mm_cmpgt_epi32(key, threshold);
+    __m128i* d = reinterpret_cast<__m128i*>(dst + i);
+    const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(d, _mm_or_si128(_mm_and_si128(mask, s), _mm_andnot_si128(mask, _mm_loadu_si128(d))));
+  }
+#endif
+  for (; i < count; ++i) {
+    if (keys[i] >= level) dst[i] = src[i];
+  }
+}
+}  // namespace
+
+void fill(TCOD_ColorRGBA* dst, size_t count, const TCOD_ColorRGBA& value) {
+  size_t i = 0;
+#if defined(__AVX2__)
+  const __m256i v = _mm256_set1_epi32(static_cast<int>(pack(value)));
+  for (; i + 8 <= count; i += 8) _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+#elif defined(SALIENT_SSE2)
+  const __m128i v = _mm_set1_epi32(static_cast<int>(pack(value)));
+  for (; i + 4 <= count; i += 4) _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+#endif
+  for (; i < count; ++i) dst[i] = value;
+}
+
+void multiply(TCOD_ColorRGBA* dst, size_t count, const TCOD_ColorRGBA& factor) {
+  size_t i = 0;
+  uint8_t* data = bytes(dst);
+#if defined(__AVX2__)
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i round = _mm256_set1_epi16(128);
+  const __m256i f16 = _mm256_unpacklo_epi8(_mm256_set1_epi32(static_cast<int>(pack(factor))), zero);
+  const auto scale16 = [&](__m256i x) {
+    x = _mm256_add_epi16(_mm256_mullo_epi16(x, f16), round);
+    return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+  };
+  for (; i + 8 <= count; i += 8) {
+    const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i * 4));
+    const __m256i lo = scale16(_mm256_unpacklo_epi8(x, zero));
+    const __m256i hi = scale16(_mm256_unpackhi_epi8(x, zero));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i * 4), _mm256_packus_epi16(lo, hi));
+  }
+#elif defined(SALIENT_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i round = _mm_set1_epi16(128);
+  const __m128i f16 = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(pack(factor))), zero);
+  const auto scale16 = [&](__m128i x) {
+    x = _mm_add_epi16(_mm_mullo_epi16(x, f16), round);
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+  };
+  for (; i + 4 <= count; i += 4) {
+    const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 4));
+    const __m128i lo = scale16(_mm_unpacklo_epi8(x, zero));
+    const __m128i hi = scale16(_mm_unpackhi_epi8(x, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i * 4), _mm_packus_epi16(lo, hi));
+  }
+#endif
+  for (; i < count; ++i) {
+    dst[i].r = scale(dst[i].r, factor.r);
+    dst[i].g = scale(dst[i].g, factor.g);
+    dst[i].b = scale(dst[i].b, factor.b);
+    dst[i].a = scale(dst[i].a, factor.a);
+  }
+}
+
+void multiply(TCOD_ColorRGBA* dst, const TCOD_ColorRGBA* factors, size_t count) {
+  size_t i = 0;
+  uint8_t* data = bytes(dst);
+  const uint8_t* factor = bytes(factors);
+#if defined(__AVX2__)
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i round = _mm256_set1_epi16(128);
+  const auto scale16 = [&](__m256i x, __m256i f) {
+    x = _mm256_add_epi16(_mm256_mullo_epi16(x, f), round);
+    return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+  };
+  for (; i + 8 <= count; i += 8) {
+    const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i * 4));
+    const __m256i f = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(factor + i * 4));
+    const __m256i lo = scale16(_mm256_unpacklo_epi8(x, zero), _mm256_unpacklo_epi8(f, zero));
+    const __m256i hi = scale16(_mm256_unpackhi_epi8(x, zero), _mm256_unpackhi_epi8(f, zero));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i * 4), _mm256_packus_epi16(lo, hi));
+  }
+#elif defined(SALIENT_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i round = _mm_set1_epi16(128);
+  const auto scale16 = [&](__m128i x, __m128i f) {
+    x = _mm_add_epi16(_mm_mullo_epi16(x, f), round);
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+  };
+  for (; i + 4 <= count; i += 4) {
+    const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 4));
+    const __m128i f = _mm_loadu_si128(reinterpret_cast<const __m128i*>(factor + i * 4));
+    const __m128i lo = scale16(_mm_unpacklo_epi8(x, zero), _mm_unpacklo_epi8(f, zero));
+    const __m128i hi = scale16(_mm_unpackhi_epi8(x, zero), _mm_unpackhi_epi8(f, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i * 4), _mm_packus_epi16(lo, hi));
+  }
+#endif
+  for (; i < count; ++i) {
+    dst[i].r = scale(dst[i].r, factors[i].r);
+    dst[i].g = scale(dst[i].g, factors[i].g);
+    dst[i].b = scale(dst[i].b, factors[i].b);
+    dst[i].a = scale(dst[i].a, factors[i].a);
+  }
+}
+
+void subtract(TCOD_ColorRGBA* dst, size_t count, const TCOD_ColorRGBA& amount) {
+  size_t i = 0;
+  uint8_t* data = bytes(dst);
+#if defined(__AVX2__)
+  const __m256i v = _mm256_set1_epi32(static_cast<int>(pack(amount)));
+  for (; i + 8 <= count; i += 8) {
+    __m256i* p = reinterpret_cast<__m256i*>(data + i * 4);
+    _mm256_storeu_si256(p, _mm256_subs_epu8(_mm256_loadu_si256(p), v));
+  }
+#elif defined(SALIENT_SSE2)
+  const __m128i v = _mm_set1_epi32(static_cast<int>(pack(amount)));
+  for (; i + 4 <= count; i += 4) {
+    __m128i* p = reinterpret_cast<__m128i*>(data + i * 4);
+    _mm_storeu_si128(p, _mm_subs_epu8(_mm_loadu_si128(p), v));
+  }
+#endif
+  const auto sub = [](uint8_t x, uint8_t y) { return static_cast<uint8_t>(x > y ? x - y : 0); };
+  for (; i < count; ++i) {
+    dst[i].r = sub(dst[i].r, amount.r);
+    dst[i].g = sub(dst[i].g, amount.g);
+    dst[i].b = sub(dst[i].b, amount.b);
+    dst[i].a = sub(dst[i].a, amount.a);
+  }
+}
+
+void blend(TCOD_ColorRGBA* dst, const TCOD_ColorRGBA* src, size_t count, int alpha) {
+  size_t i = 0;
+  uint8_t* data = bytes(dst);
+  const uint8_t* source = bytes(src);
+#if defined(__AVX2__)
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i a16 = _mm256_set1_epi16(static_cast<int16_t>(alpha));
+  const __m256i ia16 = _mm256_set1_epi16(static_cast<int16_t>(256 - alpha));
+  const auto mix16 = [&](__m256i d, __m256i s) {
+    return _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(d, ia16), _mm256_mullo_epi16(s, a16)), 8);
+  };
+  for (; i + 8 <= count; i += 8) {
+    const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i * 4));
+    const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i * 4));
+    const __m256i lo = mix16(_mm256_unpacklo_epi8(d, zero), _mm256_unpacklo_epi8(s, zero));
+    const __m256i hi = mix16(_mm256_unpackhi_epi8(d, zero), _mm256_unpackhi_epi8(s, zero));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i * 4), _mm256_packus_epi16(lo, hi));
+  }
+#elif defined(SALIENT_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i a16 = _mm_set1_epi16(static_cast<int16_t>(alpha));
+  const __m128i ia16 = _mm_set1_epi16(static_cast<int16_t>(256 - alpha));
+  const auto mix16 = [&](__m128i d, __m128i s) {
+    return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(d, ia16), _mm_mullo_epi16(s, a16)), 8);
+  };
+  for (; i + 4 <= count; i += 4) {
+    const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 4));
+    const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 4));
+    const __m128i lo = mix16(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(s, zero));
+    const __m128i hi = mix16(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(s, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i * 4), _mm_packus_epi16(lo, hi));
+  }
+#endif
+  for (; i < count; ++i) {
+    dst[i].r = mix(dst[i].r, src[i].r, alpha);
+    dst[i].g = mix(dst[i].g, src[i].g, alpha);
+    dst[i].b = mix(dst[i].b, src[i].b, alpha);
+    dst[i].a = mix(dst[i].a, src[i].a, alpha);
+  }
+}
+
+void blend(TCOD_ColorRGBA* dst, size_t count, const TCOD_ColorRGBA& colour, int alpha) {
+  size_t i = 0;
+  uint8_t* data = bytes(dst);
+#if defined(__AVX2__)
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i ia16 = _mm256_set1_epi16(static_cast<int16_t>(256 - alpha));
+  // colour * alpha, computed once
+  const __m256i c16 = _mm256_mullo_epi16(
+      _mm256_unpacklo_epi8(_mm256_set1_epi32(static_cast<int>(pack(colour))), zero),
+      _mm256_set1_epi16(static_cast<int16_t>(alpha)));
+  const auto mix16 = [&](__m256i d) {
+    return _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(d, ia16), c16), 8);
+  };
+  for (; i + 8 <= count; i += 8) {
+    const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i * 4));
+    const __m256i lo = mix16(_mm256_unpacklo_epi8(d, zero));
+    const __m256i hi = mix16(_mm256_unpackhi_epi8(d, zero));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i * 4), _mm256_packus_epi16(lo, hi));
+  }
+#elif defined(SALIENT_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i ia16 = _mm_set1_epi16(static_cast<int16_t>(256 - alpha));
+  const __m128i c16 = _mm_mullo_epi16(
+      _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(pack(colour))), zero),
+      _mm_set1_epi16(static_cast<int16_t>(alpha)));
+  const auto mix16 = [&](__m128i d) { return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(d, ia16), c16), 8); };
+  for (; i + 4 <= count; i += 4) {
+    const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 4));
+    const __m128i lo = mix16(_mm_unpacklo_epi8(d, zero));
+    const __m128i hi = mix16(_mm_unpackhi_epi8(d, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i * 4), _mm_packus_epi16(lo, hi));
+  }
+#endif
+  for (; i < count; ++i) {
+    dst[i].r = mix(dst[i].r, colour.r, alpha);
+    dst[i].g = mix(dst[i].g, colour.g, alpha);
+    dst[i].b = mix(dst[i].b, colour.b, alpha);
+    dst[i].a = mix(dst[i].a, colour.a, alpha);
+  }
+}
+
+void desaturate(TCOD_ColorRGBA* dst, size_t count, int amount) {
+  size_t i = 0;
+  uint8_t* data = bytes(dst);
+  // the weighted sum fits in 16 bits: 256 * 255 at most
+#if defined(__AVX2__)
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i weights = _mm256_set1_epi64x(0x0000001D0096004DLL);
+  const __m256i alphaMask = _mm256_set1_epi64x(static_cast<long long>(0xFFFF000000000000ULL));
+  const __m256i a16 = _mm256_set1_epi16(static_cast<int16_t>(amount));
+  const __m256i ia16 = _mm256_set1_epi16(static_cast<int16_t>(256 - amount));
+  const auto grey16 = [&](__m256i x) {
+    // sum the weighted channels of each colour into all four of its lanes
+    __m256i sum = _mm256_mullo_epi16(x, weights);
+    sum = _mm256_add_epi16(
+        sum, _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(sum, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1)));
+    sum = _mm256_add_epi16(
+        sum, _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(sum, _MM_SHUFFLE(1, 0, 3, 2)), _MM_SHUFFLE(1, 0, 3, 2)));
+    const __m256i grey = _mm256_or_si256(
+        _mm256_andnot_si256(alphaMask, _mm256_srli_epi16(sum, 8)), _mm256_and_si256(alphaMask, x));
+    return _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(x, ia16), _mm256_mullo_epi16(grey, a16)), 8);
+  };
+  for (; i + 8 <= count; i += 8) {
+    const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i * 4));
+    const __m256i lo = grey16(_mm256_unpacklo_epi8(x, zero));
+    const __m256i hi = grey16(_mm256_unpackhi_epi8(x, zero));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i * 4), _mm256_packus_epi16(lo, hi));
+  }
+#elif defined(SALIENT_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i weights = _mm_set_epi16(0, 29, 150, 77, 0, 29, 150, 77);
+  const __m128i alphaMask = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+  const __m128i a16 = _mm_set1_epi16(static_cast<int16_t>(amount));
+  const __m128i ia16 = _mm_set1_epi16(static_cast<int16_t>(256 - amount));
+  const auto grey16 = [&](__m128i x) {
+    __m128i sum = _mm_mullo_epi16(x, weights);
+    sum = _mm_add_epi16(
+        sum, _mm_shufflehi_epi16(_mm_shufflelo_epi16(sum, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1)));
+    sum = _mm_add_epi16(
+        sum, _mm_shufflehi_epi16(_mm_shufflelo_epi16(sum, _MM_SHUFFLE(1, 0, 3, 2)), _MM_SHUFFLE(1, 0, 3, 2)));
+    const __m128i grey = _mm_or_si128(_mm_andnot_si128(alphaMask, _mm_srli_epi16(sum, 8)), _mm_and_si128(alphaMask, x));
+    return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(x, ia16), _mm_mullo_epi16(grey, a16)), 8);
+  };
+  for (; i + 4 <= count; i += 4) {
+    const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 4));
+    const __m128i lo = grey16(_mm_unpacklo_epi8(x, zero));
+    const __m128i hi = grey16(_mm_unpackhi_epi8(x, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i * 4), _mm_packus_epi16(lo, hi));
+  }
+#endif
+  for (; i < count; ++i) {
+    const int grey = (dst[i].r * 77 + dst[i].g * 150 + dst[i].b * 29) >> 8;
+    dst[i].r = mix(dst[i].r, grey, amount);
+    dst[i].g = mix(dst[i].g, grey, amount);
+    dst[i].b = mix(dst[i].b, grey, amount);
+  }
+}
+
+void select(TCOD_ColorRGBA* dst, const TCOD_ColorRGBA* src, const uint8_t* keys, int level, size_t count) {
+  static_assert(sizeof(TCOD_ColorRGBA) == sizeof(uint32_t));
+  selectWords(reinterpret_cast<uint32_t*>(dst), reinterpret_cast<const uint32_t*>(src), keys, level, count);
+}
+
+void select(int* dst, const int* src, const uint8_t* keys, int level, size_t count) {
+  static_assert(sizeof(int) == sizeof(uint32_t));
+  selectWords(reinterpret_cast<uint32_t*>(dst), reinterpret_cast<const uint32_t*>(src), keys, level, count);
+}
+}  // namespace pixels
+}  // namespace render
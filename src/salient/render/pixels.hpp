@@ -0,0 +1,115 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <libtcod/libtcod.hpp>
+
+namespace render {
+/**
+ * Vectorised operations on runs of RGBA colours, used by the planar console and the effect stages. Each one processes
+ * 8 colours per instruction with AVX2, 4 with SSE2, and falls back to scalar code elsewhere, with identical results.
+ */
+namespace pixels {
+/**
+ * Sets colours to a value.
+ * @param dst the colours
+ * @param count the number of colours
+ * @param value the value
+ */
+void fill(TCOD_ColorRGBA* dst, size_t count, const TCOD_ColorRGBA& value);
+/**
+ * Multiplies each channel of the colours by a factor, 255 standing for 1: <code>dst = dst * factor / 255</code>.
+ * @param dst the colours
+ * @param count the number of colours
+ * @param factor the factor of each channel
+ */
+void multiply(TCOD_ColorRGBA* dst, size_t count, const TCOD_ColorRGBA& factor);
+/**
+ * Multiplies each channel of the colours by the matching channel of other colours, 255 standing for 1.
+ * @param dst the colours
+ * @param factors the factors, one colour per colour of <code>dst</code>
+ * @param count the number of colours
+ */
+void multiply(TCOD_ColorRGBA* dst, const TCOD_ColorRGBA* factors, size_t count);
+/**
+ * Subtracts an amount from each channel of the colours, stopping at 0.
+ * @param dst the colours
+ * @param count the number of colours
+ * @param amount the amount subtracted from each channel
+ */
+void subtract(TCOD_ColorRGBA* dst, size_t count, const TCOD_ColorRGBA& amount);
+/**
+ * Blends colours towards other colours: <code>dst += (src - dst) * alpha / 256</code>.
+ * @param dst the colours
+ * @param src the colours blended in
+ * @param count the number of colours
+ * @param alpha the opacity of the blended colours, from 0 to 256
+ */
+void blend(TCOD_ColorRGBA* dst, const TCOD_ColorRGBA* src, size_t count, int alpha);
+/**
+ * Blends colours towards a single colour: <code>dst += (colour - dst) * alpha / 256</code>.
+ * @param dst the colours
+ * @param count the number of colours
+ * @param colour the colour blended in
+ * @param alpha the opacity of the blended colour, from 0 to 256
+ */
+void blend(TCOD_ColorRGBA* dst, size_t count, const TCOD_ColorRGBA& colour, int alpha);
+/**
+ * Blends the red, green and blue channels of colours towards their luminance, <code>(77r + 150g + 29b) / 256</code>.
+ * The alpha channel is left untouched.
+ * @param dst the colours
+ * @param count the number of colours
+ * @param amount how much the colours are greyed, from 0 to 256
+ */
+void desaturate(TCOD_ColorRGBA* dst, size_t count, int amount);
+/**
+ * Copies the colours whose key reaches a level: <code>if (keys[i] >= level) dst[i] = src[i]</code>.
+ * @param dst the colours
+ * @param src the colours copied
+ * @param keys a key per colour
+ * @param level the level, from 0 (everything is copied) to 256 (nothing is)
+ * @param count the number of colours
+ */
+void select(TCOD_ColorRGBA* dst, const TCOD_ColorRGBA* src, const uint8_t* keys, int level, size_t count);
+/**
+ * Copies the code points whose key reaches a level, like the colour version.
+ * @param dst the code points
+ * @param src the code points copied
+ * @param keys a key per code point
+ * @param level the level, from 0 (everything is copied) to 256 (nothing is)
+ * @param count the number of code points
+ */
+void select(int* dst, const int* src, const uint8_t* keys, int level, size_t count);
+}  // namespace pixels
+}  // namespace render
@@ -0,0 +1,165 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "render/planar_console.hpp"
+
+#include <algorithm>
+
+#include "render/pixels.hpp"
+
+namespace render {
+namespace {
+int toAlpha(float alpha) { return static_cast<int>(std::clamp(alpha, 0.0f, 1.0f) * 256.0f); }
+}  // namespace
+
+PlanarConsole::PlanarConsole(int newWidth, int newHeight) { resize(newWidth, newHeight); }
+
+void PlanarConsole::resize(int newWidth, int newHeight) {
+  width = std::max(0, newWidth);
+  height = std::max(0, newHeight);
+  const size_t count = static_cast<size_t>(width) * height;
+  glyphs.resize(count);
+  foreground.resize(count);
+  background.resize(count);
+  clear();
+}
+
+base::Rect PlanarConsole::clip(const base::Rect& rect) const {
+  if (rect.w <= 0 || rect.h <= 0) return base::Rect{0, 0, width, height};
+  const int x = std::clamp(rect.x, 0, width);
+  const int y = std::clamp(rect.y, 0, height);
+  return base::Rect{x, y, std::clamp(rect.x + rect.w, 0, width) - x, std::clamp(rect.y + rect.h, 0, height) - y};
+}
+
+void PlanarConsole::clear(int ch, const TCOD_ColorRGBA& fg, const TCOD_ColorRGBA& bg) {
+  std::fill(glyphs.begin(), glyphs.end(), ch);
+  pixels::fill(foreground.data(), foreground.size(), fg);
+  pixels::fill(background.data(), background.size(), bg);
+}
+
+void PlanarConsole::fill(const base::Rect& rect, int ch, const TCOD_ColorRGBA& fg, const TCOD_ColorRGBA& bg) {
+  if (rect.w <= 0 || rect.h <= 0) return;
+  const base::Rect area = clip(rect);
+  for (int y = area.y; y < area.y + area.h; ++y) {
+    const size_t row = static_cast<size_t>(y) * width + area.x;
+    std::fill_n(glyphs.begin() + row, area.w, ch);
+    pixels::fill(foreground.data() + row, area.w, fg);
+    pixels::fill(background.data() + row, area.w, bg);
+  }
+}
+
+void PlanarConsole::fill(Plane plane, const base::Rect& rect, const TCOD_ColorRGBA& colour) {
+  const base::Rect area = clip(rect);
+  TCOD_ColorRGBA* colours = getColours(plane);
+  // rows spanning the whole console are contiguous
+  if (area.w == width) {
+    pixels::fill(colours + static_cast<size_t>(area.y) * width, static_cast<size_t>(area.w) * area.h, colour);
+    return;
+  }
+  for (int y = area.y; y < area.y + area.h; ++y) {
+    pixels::fill(colours + static_cast<size_t>(y) * width + area.x, area.w, colour);
+  }
+}
+
+void PlanarConsole::fade(Plane plane, const TCOD_ColorRGBA& amount, const base::Rect& rect) {
+  const base::Rect area = clip(rect);
+  TCOD_ColorRGBA* colours = getColours(plane);
+  if (area.w == width) {
+    pixels::subtract(colours + static_cast<size_t>(area.y) * width, static_cast<size_t>(area.w) * area.h, amount);
+    return;
+  }
+  for (int y = area.y; y < area.y + area.h; ++y) {
+    pixels::subtract(colours + static_cast<size_t>(y) * width + area.x, area.w, amount);
+  }
+}
+
+void PlanarConsole::multiply(Plane plane, const TCOD_ColorRGBA& factor, const base::Rect& rect) {
+  const base::Rect area = clip(rect);
+  TCOD_ColorRGBA* colours = getColours(plane);
+  if (area.w == width) {
+    pixels::multiply(colours + static_cast<size_t>(area.y) * width, static_cast<size_t>(area.w) * area.h, factor);
+    return;
+  }
+  for (int y = area.y; y < area.y + area.h; ++y) {
+    pixels::multiply(colours + static_cast<size_t>(y) * width + area.x, area.w, factor);
+  }
+}
+
+void PlanarConsole::blit(
+    const PlanarConsole& source,
+    const base::Rect& sourceRect,
+    int x,
+    int y,
+    float foregroundAlpha,
+    float backgroundAlpha) {
+  base::Rect area = source.clip(sourceRect);
+  if (area.w <= 0 || area.h <= 0) return;
+  // clip the destination, moving the source area along
+  const base::Rect destination = clip(base::Rect{x, y, area.w, area.h});
+  if (destination.w <= 0 || destination.h <= 0) return;
+  area.x += destination.x - x;
+  area.y += destination.y - y;
+  const int fgAlpha = toAlpha(foregroundAlpha);
+  const int bgAlpha = toAlpha(backgroundAlpha);
+  for (int row = 0; row < destination.h; ++row) {
+    const size_t from = static_cast<size_t>(area.y + row) * source.width + area.x;
+    const size_t to = static_cast<size_t>(destination.y + row) * width + destination.x;
+    pixels::blend(background.data() + to, source.background.data() + from, destination.w, bgAlpha);
+    pixels::blend(foreground.data() + to, source.foreground.data() + from, destination.w, fgAlpha);
+    if (fgAlpha >= 128) std::copy_n(source.glyphs.begin() + from, destination.w, glyphs.begin() + to);
+  }
+}
+
+void PlanarConsole::fromConsole(const TCOD_Console& console) {
+  if (console.w != width || console.h != height) resize(console.w, console.h);
+  const size_t count = glyphs.size();
+  for (size_t i = 0; i < count; ++i) {
+    const TCOD_ConsoleTile& tile = console.tiles[i];
+    glyphs[i] = tile.ch;
+    foreground[i] = tile.fg;
+    background[i] = tile.bg;
+  }
+}
+
+void PlanarConsole::toConsole(TCOD_Console& console) const {
+  const int copyWidth = std::min(width, console.w);
+  const int copyHeight = std::min(height, console.h);
+  for (int y = 0; y < copyHeight; ++y) {
+    const size_t from = static_cast<size_t>(y) * width;
+    TCOD_ConsoleTile* tiles = console.tiles + static_cast<size_t>(y) * console.w;
+    for (int x = 0; x < copyWidth; ++x) {
+      tiles[x].ch = glyphs[from + x];
+      tiles[x].fg = foreground[from + x];
+      tiles[x].bg = background[from + x];
+    }
+  }
+}
+}  // namespace render
@@ -0,0 +1,157 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <libtcod/libtcod.hpp>
+#include <vector>
+
+#include "base/rect.hpp"
+
+namespace render {
+/**
+ * A console stored as separate planes: one of code points, one of foreground colours and one of background colours.
+ * Whole-plane operations such as clearing, fading or blending then run over contiguous colours with the vectorised
+ * <code>render::pixels</code> kernels instead of walking <code>{ch, fg, bg}</code> tiles one at a time. Draw into it,
+ * apply effects, then copy it into a libtcod console before flushing.
+ */
+class PlanarConsole {
+ public:
+  /**
+   * The colour planes.
+   */
+  enum Plane { PLANE_FOREGROUND, PLANE_BACKGROUND };
+  PlanarConsole() = default;
+  /**
+   * Creates a console filled with spaces, white on black.
+   * @param width the width in cells
+   * @param height the height in cells
+   */
+  PlanarConsole(int width, int height);
+  /**
+   * Changes the size of the console, clearing it.
+   * @param width the width in cells
+   * @param height the height in cells
+   */
+  void resize(int width, int height);
+  int getWidth() const { return width; }
+  int getHeight() const { return height; }
+  /**
+   * Gets the code point plane, row by row.
+   * @return the code points
+   */
+  int* getGlyphs() { return glyphs.data(); }
+  const int* getGlyphs() const { return glyphs.data(); }
+  /**
+   * Gets a colour plane, row by row.
+   * @param plane the plane
+   * @return the colours
+   */
+  TCOD_ColorRGBA* getColours(Plane plane) { return plane == PLANE_FOREGROUND ? foreground.data() : background.data(); }
+  const TCOD_ColorRGBA* getColours(Plane plane) const {
+    return plane == PLANE_FOREGROUND ? foreground.data() : background.data();
+  }
+  /**
+   * Fills the whole console.
+   * @param ch the code point
+   * @param fg the foreground colour
+   * @param bg the background colour
+   */
+  void clear(int ch = ' ', const TCOD_ColorRGBA& fg = {255, 255, 255, 255}, const TCOD_ColorRGBA& bg = {0, 0, 0, 255});
+  /**
+   * Fills an area.
+   * @param rect the area, clipped to the console
+   * @param ch the code point
+   * @param fg the foreground colour
+   * @param bg the background colour
+   */
+  void fill(const base::Rect& rect, int ch, const TCOD_ColorRGBA& fg, const TCOD_ColorRGBA& bg);
+  /**
+   * Fills an area of a colour plane.
+   * @param plane the plane
+   * @param rect the area, clipped to the console, an empty rectangle standing for the whole console
+   * @param colour the colour
+   */
+  void fill(Plane plane, const base::Rect& rect, const TCOD_ColorRGBA& colour);
+  /**
+   * Fades the colours of a plane by subtracting an amount from each channel, stopping at 0.
+   * @param plane the plane
+   * @param amount the amount subtracted from each channel
+   * @param rect the area, clipped to the console, an empty rectangle standing for the whole console
+   */
+  void fade(Plane plane, const TCOD_ColorRGBA& amount, const base::Rect& rect = {});
+  /**
+   * Multiplies the colours of a plane by a colour, 255 standing for 1.
+   * @param plane the plane
+   * @param factor the factor of each channel
+   * @param rect the area, clipped to the console, an empty rectangle standing for the whole console
+   */
+  void multiply(Plane plane, const TCOD_ColorRGBA& factor, const base::Rect& rect = {});
+  /**
+   * Blends a part of another planar console over this one. The colours are blended with their opacity; the code points
+   * are copied where the foreground is at least half opaque.
+   * @param source the source console
+   * @param sourceRect the part of the source console, an empty rectangle standing for all of it
+   * @param x the <i>x</i> coordinate of the destination
+   * @param y the <i>y</i> coordinate of the destination
+   * @param foregroundAlpha the opacity of the foreground colours
+   * @param backgroundAlpha the opacity of the background colours
+   */
+  void blit(
+      const PlanarConsole& source,
+      const base::Rect& sourceRect,
+      int x,
+      int y,
+      float foregroundAlpha = 1.0f,
+      float backgroundAlpha = 1.0f);
+  /**
+   * Copies a libtcod console, resizing this console to match it.
+   * @param console the libtcod console
+   */
+  void fromConsole(const TCOD_Console& console);
+  /**
+   * Copies this console into a libtcod console. Cells outside of the libtcod console are left out.
+   * @param console the libtcod console
+   */
+  void toConsole(TCOD_Console& console) const;
+
+ private:
+  /**
+   * Clips an area to the console.
+   */
+  base::Rect clip(const base::Rect& rect) const;
+  int width{};
+  int height{};
+  std::vector<int> glyphs{};
+  std::vector<TCOD_ColorRGBA> foreground{};
+  std::vector<TCOD_ColorRGBA> background{};
+};
+}  // namespace render
@@ -0,0 +1,182 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "render/print.hpp"
+
+#include "render/text_layout.hpp"
+#include "vendor/utf8proc/utf8proc.h"
+
+namespace render {
+namespace {
+/**
+ * The glyphs of every group of four digits, leading zeros included.
+ */
+struct DigitGroups {
+  char digits[10000][4]{};
+  DigitGroups() {
+    for (int value = 0; value < 10000; ++value) {
+      digits[value][0] = static_cast<char>('0' + value / 1000);
+      digits[value][1] = static_cast<char>('0' + value / 100 % 10);
+      digits[value][2] = static_cast<char>('0' + value / 10 % 10);
+      digits[value][3] = static_cast<char>('0' + value % 10);
+    }
+  }
+};
+
+const DigitGroups& digitGroups() {
+  static const DigitGroups groups{};
+  return groups;
+}
+
+TCOD_Console* consoleData(TCODConsole& console) {
+  TCOD_Console* data = console.get_data();
+  return data ? data : TCOD_sys_get_internal_console();
+}
+
+int alignedX(int x, int length, TCOD_alignment_t alignment) {
+  if (alignment == TCOD_CENTER) return x - length / 2;
+  if (alignment == TCOD_RIGHT) return x - length + 1;
+  return x;
+}
+
+/**
+ * Decodes UTF-8 text with colour controls, calling <code>glyph(codepoint)</code> for each code point and
+ * <code>colour(foreground, rgb)</code> for each colour change, a null colour standing for the default one.
+ */
+template <typename Glyph, typename Colour>
+void decode(std::string_view text, Glyph&& glyph, Colour&& colour) {
+  const auto* bytes = reinterpret_cast<const utf8proc_uint8_t*>(text.data());
+  const size_t size = text.size();
+  size_t i = 0;
+  while (i < size) {
+    const uint8_t byte = bytes[i];
+    if (byte >= TCOD_COLCTRL_1 && byte <= TCOD_COLCTRL_NUMBER) {
+      colour(true, &TextLayout::getControlForeground(byte));
+      colour(false, &TextLayout::getControlBackground(byte));
+      ++i;
+    } else if (byte == TCOD_COLCTRL_FORE_RGB || byte == TCOD_COLCTRL_BACK_RGB) {
+      if (i + 3 >= size) return;
+      const TCODColor rgb{bytes[i + 1], bytes[i + 2], bytes[i + 3]};
+      colour(byte == TCOD_COLCTRL_FORE_RGB, &rgb);
+      i += 4;
+    } else if (byte == TCOD_COLCTRL_STOP) {
+      colour(true, nullptr);
+      colour(false, nullptr);
+      ++i;
+    } else {
+      utf8proc_int32_t codepoint{};
+      utf8proc_ssize_t length = utf8proc_iterate(bytes + i, static_cast<utf8proc_ssize_t>(size - i), &codepoint);
+      if (length <= 0) {
+        codepoint = 0xFFFD;
+        length = 1;
+      }
+      glyph(codepoint);
+      i += static_cast<size_t>(length);
+    }
+  }
+}
+}  // namespace
+
+int printText(
+    TCODConsole& console, int x, int y, std::string_view text, TCOD_alignment_t alignment, TCOD_bkgnd_flag_t flag) {
+  int length = 0;
+  decode(text, [&](int) { ++length; }, [](bool, const TCODColor*) {});
+  TCOD_Console* data = consoleData(console);
+  if (!data || y < 0 || y >= data->h) return length;
+  const TCODColor defaultForeground = console.getDefaultForeground();
+  const TCODColor defaultBackground = console.getDefaultBackground();
+  TCODColor foreground = defaultForeground;
+  TCODColor background = defaultBackground;
+  TCOD_ConsoleTile* row = data->tiles + static_cast<size_t>(y) * data->w;
+  int column = alignedX(x, length, alignment);
+  decode(
+      text,
+      [&](int codepoint) {
+        if (column >= 0 && column < data->w) {
+          TCOD_ConsoleTile& tile = row[column];
+          tile.ch = codepoint;
+          tile.fg = TCOD_ColorRGBA{foreground.r, foreground.g, foreground.b, 255};
+          if (flag == TCOD_BKGND_SET) {
+            tile.bg = TCOD_ColorRGBA{background.r, background.g, background.b, 255};
+          } else if (flag != TCOD_BKGND_NONE) {
+            TCOD_console_set_char_background(data, column, y, background, flag);
+          }
+        }
+        ++column;
+      },
+      [&](bool isForeground, const TCODColor* rgb) {
+        if (isForeground) {
+          foreground = rgb ? *rgb : defaultForeground;
+        } else {
+          background = rgb ? *rgb : defaultBackground;
+        }
+      });
+  return length;
+}
+
+size_t formatNumber(int64_t value, int* glyphs) {
+  const DigitGroups& groups = digitGroups();
+  // the digits are written from the end of a scratch buffer, four at a time
+  char scratch[NUMBER_GLYPHS];
+  char* end = scratch + NUMBER_GLYPHS;
+  char* start = end;
+  uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+  while (magnitude >= 10000) {
+    start -= 4;
+    std::copy_n(groups.digits[magnitude % 10000], 4, start);
+    magnitude /= 10000;
+  }
+  const char* group = groups.digits[magnitude];
+  const int digits = magnitude >= 1000 ? 4 : magnitude >= 100 ? 3 : magnitude >= 10 ? 2 : 1;
+  start -= digits;
+  std::copy_n(group + 4 - digits, digits, start);
+  if (value < 0) *--start = '-';
+  const size_t count = static_cast<size_t>(end - start);
+  std::copy_n(start, count, glyphs);
+  return count;
+}
+
+int printNumber(TCODConsole& console, int x, int y, int64_t value, TCOD_alignment_t alignment) {
+  int glyphs[NUMBER_GLYPHS];
+  const int length = static_cast<int>(formatNumber(value, glyphs));
+  TCOD_Console* data = consoleData(console);
+  if (!data || y < 0 || y >= data->h) return length;
+  const TCODColor foreground = console.getDefaultForeground();
+  const TCOD_ColorRGBA fg{foreground.r, foreground.g, foreground.b, 255};
+  TCOD_ConsoleTile* row = data->tiles + static_cast<size_t>(y) * data->w;
+  const int column = alignedX(x, length, alignment);
+  for (int i = std::max(0, -column); i < length && column + i < data->w; ++i) {
+    row[column + i].ch = glyphs[i];
+    row[column + i].fg = fg;
+  }
+  return length;
+}
+}  // namespace render
@@ -0,0 +1,134 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <libtcod/libtcod.hpp>
+#include <string_view>
+#include <utility>
+
+namespace render {
+/**
+ * The number of bytes a formatted print can produce. Longer output is cut off.
+ */
+constexpr size_t PRINT_BUFFER_SIZE = 256;
+/**
+ * The number of code points a formatted 64-bit integer can take, sign included.
+ */
+constexpr size_t NUMBER_GLYPHS = 20;
+/**
+ * Prints a line of UTF-8 text. The libtcod colour controls change the colours of the following code points, the
+ * console's default colours being used elsewhere. Nothing is allocated: the text is decoded straight into the console.
+ * @param console the console
+ * @param x the <i>x</i> coordinate of the left side, the centre or the right side of the text, depending on the
+ * alignment
+ * @param y the <i>y</i> coordinate of the text
+ * @param text the UTF-8 text, with colour controls
+ * @param alignment the alignment of the text
+ * @param flag how the background colours are applied
+ * @return the number of cells taken by the text, including those outside of the console
+ */
+int printText(
+    TCODConsole& console,
+    int x,
+    int y,
+    std::string_view text,
+    TCOD_alignment_t alignment = TCOD_LEFT,
+    TCOD_bkgnd_flag_t flag = TCOD_BKGND_NONE);
+/**
+ * Formats a line of text with fmt into a buffer on the stack, then prints it like <code>printText()</code>, without
+ * any allocation. Meant for the text of HUDs, which changes every frame.
+ * @param console the console
+ * @param x the <i>x</i> coordinate of the left side, the centre or the right side of the text
+ * @param y the <i>y</i> coordinate of the text
+ * @param alignment the alignment of the text
+ * @param flag how the background colours are applied
+ * @param format the fmt format string
+ * @param args the formatted values
+ * @return the number of cells taken by the text
+ */
+template <typename... Args>
+int print(
+    TCODConsole& console,
+    int x,
+    int y,
+    TCOD_alignment_t alignment,
+    TCOD_bkgnd_flag_t flag,
+    fmt::format_string<Args...> format,
+    Args&&... args) {
+  char buffer[PRINT_BUFFER_SIZE];
+  const auto result = fmt::format_to_n(buffer, sizeof(buffer), format, std::forward<Args>(args)...);
+  return printText(console, x, y, std::string_view{buffer, std::min(result.size, sizeof(buffer))}, alignment, flag);
+}
+/**
+ * Formats and prints a line of text, keeping the background colours.
+ * @param console the console
+ * @param x the <i>x</i> coordinate of the left side, the centre or the right side of the text
+ * @param y the <i>y</i> coordinate of the text
+ * @param alignment the alignment of the text
+ * @param format the fmt format string
+ * @param args the formatted values
+ * @return the number of cells taken by the text
+ */
+template <typename... Args>
+int print(
+    TCODConsole& console,
+    int x,
+    int y,
+    TCOD_alignment_t alignment,
+    fmt::format_string<Args...> format,
+    Args&&... args) {
+  return print(console, x, y, alignment, TCOD_BKGND_NONE, format, std::forward<Args>(args)...);
+}
+/**
+ * Converts an integer to code points through a table of the glyphs of every group of four digits, built once.
+ * @param value the integer
+ * @param glyphs the code points, at least <code>NUMBER_GLYPHS</code> of them
+ * @return the number of code points
+ */
+size_t formatNumber(int64_t value, int* glyphs);
+/**
+ * Prints an integer in the console's default foreground colour, keeping the background colours. Faster than
+ * formatting it, for the counters HUDs are full of.
+ * @param console the console
+ * @param x the <i>x</i> coordinate of the left side, the centre or the right side of the number
+ * @param y the <i>y</i> coordinate of the number
+ * @param value the integer
+ * @param alignment the alignment of the number
+ * @return the number of cells taken by the number
+ */
+int printNumber(TCODConsole& console, int x, int y, int64_t value, TCOD_alignment_t alignment = TCOD_LEFT);
+}  // namespace render
@@ -0,0 +1,256 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "render/software_renderer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SALIENT_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace render {
+namespace {
+inline uint32_t packColour(const TCOD_ColorRGBA& colour) {
+  const TCOD_ColorRGBA opaque{colour.r, colour.g, colour.b, 255};
+  uint32_t packed;
+  std::memcpy(&packed, &opaque, sizeof(packed));
+  return packed;
+}
+
+// dst = (fg * coverage + bg * (255 - coverage)) / 255, rounded, for each channel of <code>count</code> pixels
+void blendPixels(uint8_t* dst, const uint8_t* coverage, int count, uint32_t fg, uint32_t bg) {
+  int i = 0;
+#if defined(__AVX2__)
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i full = _mm256_set1_epi16(255);
+  const __m256i round = _mm256_set1_epi16(128);
+  const __m256i fg16 = _mm256_unpacklo_epi8(_mm256_set1_epi32(static_cast<int>(fg)), zero);
+  const __m256i bg16 = _mm256_unpacklo_epi8(_mm256_set1_epi32(static_cast<int>(bg)), zero);
+  const auto blend = [&](__m256i cov) {
+    __m256i x = _mm256_add_epi16(_mm256_mullo_epi16(fg16, cov), _mm256_mullo_epi16(bg16, _mm256_sub_epi16(full, cov)));
+    x = _mm256_add_epi16(x, round);
+    return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+  };
+  for (; i + 8 <= count; i += 8) {
+    const __m256i cov = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(coverage + i * 4));
+    const __m256i lo = blend(_mm256_unpacklo_epi8(cov, zero));
+    const __m256i hi = blend(_mm256_unpackhi_epi8(cov, zero));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), _mm256_packus_epi16(lo, hi));
+  }
+#elif defined(SALIENT_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i full = _mm_set1_epi16(255);
+  const __m128i round = _mm_set1_epi16(128);
+  const __m128i fg16 = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(fg)), zero);
+  const __m128i bg16 = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(bg)), zero);
+  const auto blend = [&](__m128i cov) {
+    __m128i x = _mm_add_epi16(_mm_mullo_epi16(fg16, cov), _mm_mullo_epi16(bg16, _mm_sub_epi16(full, cov)));
+    x = _mm_add_epi16(x, round);
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+  };
+  for (; i + 4 <= count; i += 4) {
+    const __m128i cov = _mm_loadu_si128(reinterpret_cast<const __m128i*>(coverage + i * 4));
+    const __m128i lo = blend(_mm_unpacklo_epi8(cov, zero));
+    const __m128i hi = blend(_mm_unpackhi_epi8(cov, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_packus_epi16(lo, hi));
+  }
+#endif
+  uint8_t fgBytes[4];
+  uint8_t bgBytes[4];
+  std::memcpy(fgBytes, &fg, 4);
+  std::memcpy(bgBytes, &bg, 4);
+  for (; i < count; ++i) {
+    for (int channel = 0; channel < 4; ++channel) {
+      const int cov = coverage[i * 4 + channel];
+      const int x = fgBytes[channel] * cov + bgBytes[channel] * (255 - cov) + 128;
+      dst[i * 4 + channel] = static_cast<uint8_t>((x + (x >> 8)) >> 8);
+    }
+  }
+}
+}  // namespace
+
+SoftwareRenderer::~SoftwareRenderer() {
+  setTileset(nullptr);
+  releaseTexture();
+}
+
+void SoftwareRenderer::setTileset(TCOD_Tileset* newTileset) {
+  if (newTileset == tileset) return;
+  if (tileset) {
+    if (observer) TCOD_tileset_observer_delete(observer);
+    TCOD_tileset_delete(tileset);  // drops our reference
+  }
+  observer = nullptr;
+  tileset = newTileset;
+  expandedTiles.clear();
+  fullRedraw = true;
+  if (!tileset) return;
+  ++tileset->ref_count;
+  tileWidth = tileset->tile_width;
+  tileHeight = tileset->tile_height;
+  for (int tileId = 0; tileId < tileset->tiles_count; ++tileId) expandTile(tileId);
+  observer = TCOD_tileset_observer_new(tileset);
+  if (observer) {
+    observer->userdata = this;
+    observer->on_tile_changed = onTileChanged;
+    observer->on_observer_delete = onObserverDelete;
+  }
+}
+
+int SoftwareRenderer::onTileChanged(TCOD_TilesetObserver* observer, int tileId) {
+  auto* self = static_cast<SoftwareRenderer*>(observer->userdata);
+  self->expandTile(tileId);
+  self->fullRedraw = true;  // the cells using the tile aren't tracked
+  return 0;
+}
+
+void SoftwareRenderer::onObserverDelete(TCOD_TilesetObserver* observer) {
+  static_cast<SoftwareRenderer*>(observer->userdata)->observer = nullptr;
+}
+
+void SoftwareRenderer::expandTile(int tileId) {
+  const size_t tileBytes = static_cast<size_t>(tileset->tile_length) * 4;
+  if (expandedTiles.size() < static_cast<size_t>(tileset->tiles_capacity) * tileBytes) {
+    expandedTiles.resize(static_cast<size_t>(tileset->tiles_capacity) * tileBytes);
+  }
+  const TCOD_ColorRGBA* source = tileset->pixels + static_cast<size_t>(tileId) * tileset->tile_length;
+  uint8_t* expanded = expandedTiles.data() + tileId * tileBytes;
+  for (int i = 0; i < tileset->tile_length; ++i) std::memset(expanded + i * 4, source[i].a, 4);
+}
+
+void SoftwareRenderer::drawRow(const TCOD_Console& console, int row) {
+  const size_t tileBytes = static_cast<size_t>(tileWidth) * tileHeight * 4;
+  const TCOD_ConsoleTile* tiles = console.tiles + static_cast<size_t>(row) * console.w;
+  TCOD_ConsoleTile* last = previous.data() + static_cast<size_t>(row) * console.w;
+  bool changed = false;
+  for (int x = 0; x < console.w; ++x) {
+    const TCOD_ConsoleTile& tile = tiles[x];
+    if (!fullRedraw && std::memcmp(&tile, &last[x], sizeof(tile)) == 0) continue;
+    last[x] = tile;
+    changed = true;
+    int tileId = 0;
+    if (tile.ch >= 0 && tile.ch < tileset->character_map_length) tileId = tileset->character_map[tile.ch];
+    if (tileId < 0 || tileId >= tileset->tiles_count) tileId = 0;
+    const uint8_t* coverage = expandedTiles.data() + tileId * tileBytes;
+    const uint32_t fg = packColour(tile.fg);
+    const uint32_t bg = packColour(tile.bg);
+    for (int y = 0; y < tileHeight; ++y) {
+      const size_t pixel = static_cast<size_t>(row * tileHeight + y) * framebuffer.width + x * tileWidth;
+      blendPixels(
+          reinterpret_cast<uint8_t*>(framebuffer.pixels.data() + pixel),
+          coverage + static_cast<size_t>(y) * tileWidth * 4,
+          tileWidth,
+          fg,
+          bg);
+    }
+  }
+  if (changed) dirtyRows[row] = 1;
+}
+
+bool SoftwareRenderer::render(const TCOD_Console& console, jobs::JobPool& pool) {
+  if (!tileset || console.w <= 0 || console.h <= 0) return false;
+  const int width = console.w * tileWidth;
+  const int height = console.h * tileHeight;
+  if (width != framebuffer.width || height != framebuffer.height ||
+      previous.size() != static_cast<size_t>(console.elements)) {
+    framebuffer.width = width;
+    framebuffer.height = height;
+    framebuffer.pixels.assign(static_cast<size_t>(width) * height, TCOD_ColorRGBA{0, 0, 0, 255});
+    previous.assign(console.elements, TCOD_ConsoleTile{});
+    dirtyRows.assign(console.h, 1);
+    fullRedraw = true;
+  }
+  // every job draws a band of rows, a few bands per worker to even out the load
+  const size_t bandCount = std::min<size_t>(console.h, (pool.getThreadCount() + 1) * 4);
+  const int rowsPerBand = static_cast<int>((console.h + bandCount - 1) / bandCount);
+  pool.parallelFor(bandCount, [&](size_t band) {
+    const int first = static_cast<int>(band) * rowsPerBand;
+    const int last = std::min(console.h, first + rowsPerBand);
+    for (int row = first; row < last; ++row) drawRow(console, row);
+  });
+  fullRedraw = false;
+  return std::find(dirtyRows.begin(), dirtyRows.end(), 1) != dirtyRows.end();
+}
+
+void SoftwareRenderer::releaseTexture() {
+  if (texture) SDL_DestroyTexture(texture);
+  texture = nullptr;
+  textureRenderer = nullptr;
+}
+
+bool SoftwareRenderer::present(SDL_Renderer* renderer) {
+  if (!renderer || framebuffer.pixels.empty()) return false;
+  int textureWidth = 0;
+  int textureHeight = 0;
+  if (texture) SDL_QueryTexture(texture, nullptr, nullptr, &textureWidth, &textureHeight);
+  if (!texture || renderer != textureRenderer || textureWidth != framebuffer.width ||
+      textureHeight != framebuffer.height) {
+    releaseTexture();
+    texture = SDL_CreateTexture(
+        renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STREAMING, framebuffer.width, framebuffer.height);
+    if (!texture) return false;
+    textureRenderer = renderer;
+    std::fill(dirtyRows.begin(), dirtyRows.end(), 1);
+  }
+  // upload each run of consecutive dirty rows with a single lock
+  const int rows = static_cast<int>(dirtyRows.size());
+  for (int first = 0; first < rows;) {
+    if (!dirtyRows[first]) {
+      ++first;
+      continue;
+    }
+    int last = first;
+    while (last < rows && dirtyRows[last]) dirtyRows[last++] = 0;
+    const SDL_Rect rect{0, first * tileHeight, framebuffer.width, (last - first) * tileHeight};
+    void* pixels = nullptr;
+    int pitch = 0;
+    if (SDL_LockTexture(texture, &rect, &pixels, &pitch) < 0) return false;
+    const size_t rowBytes = static_cast<size_t>(framebuffer.width) * sizeof(TCOD_ColorRGBA);
+    for (int y = 0; y < rect.h; ++y) {
+      std::memcpy(
+          static_cast<uint8_t*>(pixels) + static_cast<size_t>(y) * pitch,
+          framebuffer.pixels.data() + static_cast<size_t>(rect.y + y) * framebuffer.width,
+          rowBytes);
+    }
+    SDL_UnlockTexture(texture);
+    first = last;
+  }
+  SDL_RenderClear(renderer);
+  SDL_RenderCopy(renderer, texture, nullptr, nullptr);
+  SDL_RenderPresent(renderer);
+  return true;
+}
+}  // namespace render
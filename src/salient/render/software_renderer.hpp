@@ -0,0 +1,114 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <SDL_render.h>
+
+#include <cstdint>
+#include <libtcod/libtcod.hpp>
+#include <vector>
+
+#include "jobs/pool.hpp"
+
+namespace render {
+/**
+ * An RGBA image in memory, rows top to bottom, four bytes per pixel in R, G, B, A order.
+ */
+struct Framebuffer {
+  int width{};
+  int height{};
+  std::vector<TCOD_ColorRGBA> pixels{};
+};
+
+/**
+ * Draws a console into a framebuffer on the CPU, without going through libtcod's renderers. The tileset is expanded
+ * once so that every glyph pixel can be blended between the foreground and background colours with SIMD instructions,
+ * the console rows are spread across the job pool, and only the cells that changed since the previous frame are drawn
+ * again. The framebuffer can be read directly, for instance for headless rendering, or presented in a window through
+ * a streaming texture which only receives the rows that changed.
+ */
+class SoftwareRenderer {
+ public:
+  SoftwareRenderer() = default;
+  ~SoftwareRenderer();
+  SoftwareRenderer(const SoftwareRenderer&) = delete;
+  SoftwareRenderer& operator=(const SoftwareRenderer&) = delete;
+  /**
+   * Sets the tileset used to draw the glyphs. Changes to the tileset's tiles are picked up automatically.
+   * @param tileset the tileset, or <code>nullptr</code> to release the current one
+   */
+  void setTileset(TCOD_Tileset* tileset);
+  /**
+   * Draws a console into the framebuffer, which is resized to match the console and the tileset.
+   * @param console the console to be drawn
+   * @param pool the job pool the rows of the console are spread across
+   * @return <code>true</code> if any pixel changed, <code>false</code> otherwise
+   */
+  bool render(const TCOD_Console& console, jobs::JobPool& pool);
+  /**
+   * Uploads the rows that changed since the previous call to a streaming texture and presents it, stretched to fill
+   * the renderer's output.
+   * @param renderer the renderer of the window
+   * @return <code>true</code> if the frame has been presented, <code>false</code> if an SDL call failed
+   */
+  bool present(SDL_Renderer* renderer);
+  /**
+   * Gets the framebuffer holding the last frame drawn by <code>render()</code>.
+   * @return a reference to the framebuffer
+   */
+  const Framebuffer& getFramebuffer() const { return framebuffer; }
+  /**
+   * Forces the next frame to be drawn and uploaded in full.
+   */
+  void invalidate() { fullRedraw = true; }
+
+ private:
+  static int onTileChanged(TCOD_TilesetObserver* observer, int tileId);
+  static void onObserverDelete(TCOD_TilesetObserver* observer);
+  void expandTile(int tileId);
+  void drawRow(const TCOD_Console& console, int row);
+  void releaseTexture();
+
+  TCOD_Tileset* tileset{};
+  TCOD_TilesetObserver* observer{};
+  int tileWidth{};
+  int tileHeight{};
+  // the coverage (alpha) of every tile pixel, repeated in all four channels
+  std::vector<uint8_t> expandedTiles{};
+  Framebuffer framebuffer{};
+  std::vector<TCOD_ConsoleTile> previous{};  // the console as it was last drawn
+  std::vector<uint8_t> dirtyRows{};  // console rows not uploaded to the texture yet
+  bool fullRedraw{true};
+  SDL_Texture* texture{};
+  SDL_Renderer* textureRenderer{};
+};
+}  // namespace render
@@ -0,0 +1,440 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "render/terminal.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "logger/log.hpp"
+
+#ifndef _WIN32
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+namespace render {
+namespace {
+constexpr int MODIFIER_ALT = 1;
+constexpr int MODIFIER_CTRL = 2;
+constexpr int MODIFIER_SHIFT = 4;
+
+void appendNumber(std::string& out, unsigned value) {
+  char digits[10];
+  int count = 0;
+  do {
+    digits[count++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value);
+  while (count) out.push_back(digits[--count]);
+}
+
+void appendUtf8(std::string& out, int codepoint) {
+  // control characters would move the cursor
+  if (codepoint < 0x20 || (codepoint >= 0x7f && codepoint < 0xa0) || codepoint > 0x10ffff) codepoint = ' ';
+  if (codepoint < 0x80) {
+    out.push_back(static_cast<char>(codepoint));
+  } else if (codepoint < 0x800) {
+    out.push_back(static_cast<char>(0xc0 | codepoint >> 6));
+    out.push_back(static_cast<char>(0x80 | (codepoint & 0x3f)));
+  } else if (codepoint < 0x10000) {
+    out.push_back(static_cast<char>(0xe0 | codepoint >> 12));
+    out.push_back(static_cast<char>(0x80 | (codepoint >> 6 & 0x3f)));
+    out.push_back(static_cast<char>(0x80 | (codepoint & 0x3f)));
+  } else {
+    out.push_back(static_cast<char>(0xf0 | codepoint >> 18));
+    out.push_back(static_cast<char>(0x80 | (codepoint >> 12 & 0x3f)));
+    out.push_back(static_cast<char>(0x80 | (codepoint >> 6 & 0x3f)));
+    out.push_back(static_cast<char>(0x80 | (codepoint & 0x3f)));
+  }
+}
+
+bool sameColor(const TCOD_ColorRGBA& a, const TCOD_ColorRGBA& b) { return a.r == b.r && a.g == b.g && a.b == b.b; }
+
+bool sameCell(const TCOD_ConsoleTile& a, const TCOD_ConsoleTile& b) {
+  return a.ch == b.ch && sameColor(a.fg, b.fg) && sameColor(a.bg, b.bg);
+}
+
+void appendColor(std::string& out, const char* prefix, const TCOD_ColorRGBA& color) {
+  out += prefix;
+  appendNumber(out, color.r);
+  out.push_back(';');
+  appendNumber(out, color.g);
+  out.push_back(';');
+  appendNumber(out, color.b);
+}
+
+// the key of a CSI sequence ending with '~'
+TCOD_keycode_t tildeKey(int code) {
+  switch (code) {
+    case 1:
+    case 7:
+      return TCODK_HOME;
+    case 2:
+      return TCODK_INSERT;
+    case 3:
+      return TCODK_DELETE;
+    case 4:
+    case 8:
+      return TCODK_END;
+    case 5:
+      return TCODK_PAGEUP;
+    case 6:
+      return TCODK_PAGEDOWN;
+    case 11:
+    case 12:
+    case 13:
+    case 14:
+    case 15:
+      return static_cast<TCOD_keycode_t>(TCODK_F1 + code - 11);
+    case 17:
+    case 18:
+    case 19:
+    case 20:
+    case 21:
+      return static_cast<TCOD_keycode_t>(TCODK_F6 + code - 17);
+    case 23:
+    case 24:
+      return static_cast<TCOD_keycode_t>(TCODK_F11 + code - 23);
+    default:
+      return TCODK_NONE;
+  }
+}
+
+// the key of a CSI or SS3 sequence ending with a letter
+TCOD_keycode_t letterKey(uint8_t letter) {
+  switch (letter) {
+    case 'A':
+      return TCODK_UP;
+    case 'B':
+      return TCODK_DOWN;
+    case 'C':
+      return TCODK_RIGHT;
+    case 'D':
+      return TCODK_LEFT;
+    case 'H':
+      return TCODK_HOME;
+    case 'F':
+      return TCODK_END;
+    case 'P':
+    case 'Q':
+    case 'R':
+    case 'S':
+      return static_cast<TCOD_keycode_t>(TCODK_F1 + letter - 'P');
+    case 'Z':
+      return TCODK_TAB;  // shift-tab
+    default:
+      return TCODK_NONE;
+  }
+}
+}  // namespace
+
+Terminal::Terminal() = default;
+
+Terminal::~Terminal() { close(); }
+
+bool Terminal::open() {
+  if (opened) return true;
+#ifdef _WIN32
+  logger::Log::error("Terminal::open | Terminal output is not supported on this platform.");
+  return false;
+#else
+  if (!isatty(STDIN_FILENO) || !isatty(STDOUT_FILENO)) {
+    logger::Log::error("Terminal::open | The standard input and output aren't a terminal.");
+    return false;
+  }
+  savedMode = std::make_unique<termios>();
+  if (tcgetattr(STDIN_FILENO, savedMode.get()) != 0) {
+    logger::Log::error("Terminal::open | Could not read the terminal settings: %s", std::strerror(errno));
+    savedMode.reset();
+    return false;
+  }
+  // raw mode, with reads that return immediately
+  termios mode = *savedMode;
+  mode.c_iflag &= ~static_cast<tcflag_t>(BRKINT | ICRNL | INPCK | ISTRIP | IXON);
+  mode.c_oflag &= ~static_cast<tcflag_t>(OPOST);
+  mode.c_cflag |= CS8;
+  mode.c_lflag &= ~static_cast<tcflag_t>(ECHO | ICANON | IEXTEN | ISIG);
+  mode.c_cc[VMIN] = 0;
+  mode.c_cc[VTIME] = 0;
+  if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &mode) != 0) {
+    logger::Log::error("Terminal::open | Could not switch the terminal to raw mode: %s", std::strerror(errno));
+    savedMode.reset();
+    return false;
+  }
+  opened = true;
+  // alternate screen, hidden cursor
+  output = "\x1b[?1049h\x1b[?25l";
+  writeOutput();
+  invalidate();
+  columns = 0;
+  rows = 0;
+  return true;
+#endif
+}
+
+void Terminal::close() {
+  if (!opened) return;
+#ifndef _WIN32
+  output = "\x1b[0m\x1b[?25h\x1b[?1049l";
+  writeOutput();
+  tcsetattr(STDIN_FILENO, TCSAFLUSH, savedMode.get());
+#endif
+  savedMode.reset();
+  opened = false;
+  keys.clear();
+  input.clear();
+}
+
+size_t Terminal::render(const TCOD_Console& console) {
+  if (!opened) return 0;
+  output.clear();
+#ifndef _WIN32
+  winsize size{};
+  if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && (size.ws_col != columns || size.ws_row != rows)) {
+    columns = size.ws_col;
+    rows = size.ws_row;
+    invalidate();
+  }
+#endif
+  if (shadow.empty() || shadowWidth != console.w || shadowHeight != console.h) {
+    // start from a blank screen in the default colours
+    output += "\x1b[0m\x1b[2J";
+    colorsKnown = false;
+    cursorX = -1;
+    cursorY = -1;
+    shadowWidth = console.w;
+    shadowHeight = console.h;
+    shadow.assign(console.tiles, console.tiles + console.elements);
+    // mark every cell as different
+    for (auto& tile : shadow) tile.ch = -1;
+  }
+  const int width = std::min(console.w, columns);
+  const int height = std::min(console.h, rows);
+  for (int y = 0; y < height; ++y) {
+    const TCOD_ConsoleTile* tiles = console.tiles + y * console.w;
+    TCOD_ConsoleTile* shadowTiles = shadow.data() + y * console.w;
+    for (int x = 0; x < width; ++x) {
+      if (sameCell(tiles[x], shadowTiles[x])) continue;
+      moveCursor(x, y);
+      setColors(tiles[x].fg, tiles[x].bg);
+      appendUtf8(output, tiles[x].ch);
+      shadowTiles[x] = tiles[x];
+      // past the last column, the terminal's cursor position depends on its wrapping mode
+      cursorX = x + 1 < columns ? x + 1 : -1;
+    }
+  }
+  writeOutput();
+  return output.size();
+}
+
+void Terminal::moveCursor(int x, int y) {
+  if (cursorY == y && cursorX == x) return;
+  if (cursorY == y && cursorX >= 0 && x > cursorX) {
+    // forward on the same row
+    output += "\x1b[";
+    if (x - cursorX > 1) appendNumber(output, static_cast<unsigned>(x - cursorX));
+    output.push_back('C');
+  } else if (x == 0 && cursorY >= 0 && y == cursorY + 1) {
+    output += "\r\n";
+  } else if (x == 0 && y == 0) {
+    output += "\x1b[H";
+  } else {
+    output += "\x1b[";
+    appendNumber(output, static_cast<unsigned>(y + 1));
+    output.push_back(';');
+    appendNumber(output, static_cast<unsigned>(x + 1));
+    output.push_back('H');
+  }
+  cursorX = x;
+  cursorY = y;
+}
+
+void Terminal::setColors(const TCOD_ColorRGBA& fg, const TCOD_ColorRGBA& bg) {
+  const bool fgChanged = !colorsKnown || !sameColor(fg, currentFg);
+  const bool bgChanged = !colorsKnown || !sameColor(bg, currentBg);
+  if (!fgChanged && !bgChanged) return;
+  output += "\x1b[";
+  if (fgChanged) appendColor(output, "38;2;", fg);
+  if (fgChanged && bgChanged) output.push_back(';');
+  if (bgChanged) appendColor(output, "48;2;", bg);
+  output.push_back('m');
+  currentFg = fg;
+  currentBg = bg;
+  colorsKnown = true;
+}
+
+void Terminal::writeOutput() {
+#ifndef _WIN32
+  size_t written = 0;
+  while (written < output.size()) {
+    const ssize_t result = write(STDOUT_FILENO, output.data() + written, output.size() - written);
+    if (result < 0 && errno == EINTR) continue;
+    if (result <= 0) {
+      // the terminal is gone or stuck, whatever it displays is unknown now
+      invalidate();
+      return;
+    }
+    written += static_cast<size_t>(result);
+  }
+#endif
+}
+
+void Terminal::readInput() {
+#ifndef _WIN32
+  uint8_t buffer[256];
+  for (;;) {
+    const ssize_t count = read(STDIN_FILENO, buffer, sizeof(buffer));
+    if (count <= 0) return;
+    input.insert(input.end(), buffer, buffer + count);
+  }
+#endif
+}
+
+bool Terminal::pollKey(TCOD_key_t& key) {
+  if (!opened) return false;
+  if (keys.empty()) {
+    const size_t previousSize = input.size();
+    readInput();
+    // an incomplete escape sequence left from the previous call with nothing new is a lone escape key
+    const bool final = input.size() == previousSize;
+    size_t offset = 0;
+    while (offset < input.size()) {
+      const size_t consumed = decodeKey(input.data() + offset, input.size() - offset, final);
+      if (consumed == 0) break;
+      offset += consumed;
+    }
+    input.erase(input.begin(), input.begin() + static_cast<std::ptrdiff_t>(offset));
+  }
+  if (keys.empty()) return false;
+  key = keys.front();
+  keys.pop_front();
+  return true;
+}
+
+size_t Terminal::decodeKey(const uint8_t* data, size_t size, bool final) {
+  const uint8_t byte = data[0];
+  if (byte == 0x1b) {
+    if (size == 1) {
+      if (!final) return 0;
+      pushKey(TCODK_ESCAPE);
+      return 1;
+    }
+    if (data[1] == '[' || data[1] == 'O') {
+      // CSI: ESC [ parameters final, SS3: ESC O final
+      size_t end = 2;
+      while (end < size && (data[end] < 0x40 || data[end] > 0x7e)) ++end;
+      if (end == size) {
+        if (!final) return 0;
+        pushKey(TCODK_ESCAPE);
+        return 1;
+      }
+      int parameters[2] = {0, 0};
+      int count = 0;
+      bool privateSequence = false;
+      for (size_t i = 2; i < end; ++i) {
+        if (data[i] >= '0' && data[i] <= '9') {
+          if (count < 2) parameters[count] = parameters[count] * 10 + (data[i] - '0');
+        } else if (data[i] == ';') {
+          ++count;
+        } else {
+          privateSequence = true;  // mouse reports and the like
+        }
+      }
+      const TCOD_keycode_t vk = data[end] == '~' ? tildeKey(parameters[0]) : letterKey(data[end]);
+      if (vk != TCODK_NONE && !privateSequence) {
+        // xterm's modifier parameter is one plus a bit mask of shift, alt and ctrl
+        const int mask = parameters[1] > 1 ? parameters[1] - 1 : 0;
+        int modifiers = mask & 1 || data[end] == 'Z' ? MODIFIER_SHIFT : 0;
+        if (mask & 2) modifiers |= MODIFIER_ALT;
+        if (mask & 4) modifiers |= MODIFIER_CTRL;
+        pushKey(vk, vk == TCODK_TAB ? '\t' : 0, vk == TCODK_TAB ? "\t" : "", modifiers);
+      }
+      return end + 1;
+    }
+    // ESC followed by a key is that key with alt held
+    const size_t before = keys.size();
+    const size_t consumed = decodeKey(data + 1, size - 1, final);
+    if (consumed == 0) return 0;
+    for (size_t i = before; i < keys.size(); ++i) keys[i].lalt = true;
+    return consumed + 1;
+  }
+  if (byte == '\r' || byte == '\n') {
+    pushKey(TCODK_ENTER, '\r');
+  } else if (byte == '\t') {
+    pushKey(TCODK_TAB, '\t', "\t");
+  } else if (byte == 0x7f || byte == 0x08) {
+    pushKey(TCODK_BACKSPACE, '\b');
+  } else if (byte == 0) {
+    pushKey(TCODK_SPACE, ' ', " ", MODIFIER_CTRL);
+  } else if (byte < 0x20) {
+    // ctrl+letter
+    const char letter = static_cast<char>('a' + byte - 1);
+    pushKey(TCODK_CHAR, letter, "", MODIFIER_CTRL);
+  } else if (byte < 0x80) {
+    const char c = static_cast<char>(byte);
+    const char text[2] = {c, 0};
+    const int modifiers = (c >= 'A' && c <= 'Z') ? MODIFIER_SHIFT : 0;
+    if (c == ' ')
+      pushKey(TCODK_SPACE, c, text);
+    else if (c >= '0' && c <= '9')
+      pushKey(static_cast<TCOD_keycode_t>(TCODK_0 + c - '0'), c, text);
+    else
+      pushKey(TCODK_CHAR, c, text, modifiers);
+  } else {
+    // a UTF-8 sequence, reported as text
+    const size_t length = byte >= 0xf0 ? 4 : byte >= 0xe0 ? 3 : byte >= 0xc0 ? 2 : 1;
+    if (length == 1) return 1;  // stray continuation byte
+    if (size < length) return final ? size : 0;
+    char text[5] = {};
+    std::memcpy(text, data, length);
+    pushKey(TCODK_TEXT, 0, text);
+    return length;
+  }
+  return 1;
+}
+
+void Terminal::pushKey(TCOD_keycode_t vk, char c, const char* text, int modifiers) {
+  TCOD_key_t key{};
+  key.vk = vk;
+  key.c = c;
+  std::strncpy(key.text, text, sizeof(key.text) - 1);
+  key.lalt = modifiers & MODIFIER_ALT;
+  key.lctrl = modifiers & MODIFIER_CTRL;
+  key.shift = modifiers & MODIFIER_SHIFT;
+  key.pressed = true;
+  keys.push_back(key);
+  key.pressed = false;
+  keys.push_back(key);
+}
+}  // namespace render
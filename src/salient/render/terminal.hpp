@@ -0,0 +1,118 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <libtcod/libtcod.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct termios;
+
+namespace render {
+/**
+ * Draws a console on a VT100/xterm compatible terminal instead of a window, so that games can be played over SSH.
+ *
+ * A shadow copy of what the terminal displays is kept, and each frame only emits the cursor moves, 24-bit SGR colour
+ * changes and characters of the cells that differ from it, picking the shortest cursor movement and skipping colour
+ * changes the terminal already has. The whole frame goes out in a single write, so the bandwidth and the work both
+ * follow what changed on screen. Input bytes are decoded into <code>TCOD_key_t</code> events.
+ *
+ * Only available on POSIX systems.
+ */
+class Terminal {
+ public:
+  Terminal();
+  ~Terminal();
+  Terminal(const Terminal&) = delete;
+  Terminal& operator=(const Terminal&) = delete;
+  /**
+   * Switches the terminal to raw mode and to its alternate screen, and hides the cursor.
+   * @return <code>true</code> if the standard input and output are a terminal that could be set up,
+   * <code>false</code> otherwise
+   */
+  bool open();
+  /**
+   * Restores the terminal to the state it was in before <code>open()</code>. Also done on destruction.
+   */
+  void close();
+  /**
+   * Checks whether the terminal is in use.
+   * @return <code>true</code> if the terminal has been opened, <code>false</code> otherwise
+   */
+  bool isOpen() const { return opened; }
+  /**
+   * Draws the cells of a console that changed since the previous frame. Cells that don't fit the terminal are
+   * clipped. Everything is redrawn when the terminal is resized.
+   * @param console the console to be drawn
+   * @return the number of bytes written to the terminal
+   */
+  size_t render(const TCOD_Console& console);
+  /**
+   * Forces the next frame to redraw every cell, for instance after something else wrote to the terminal.
+   */
+  void invalidate() { shadow.clear(); }
+  /**
+   * Reads the pending terminal input and gets the next key event. Terminals only report key presses, so each press is
+   * followed by the matching release on the next call.
+   * @param key the key event, left untouched if there is none
+   * @return <code>true</code> if an event was read, <code>false</code> otherwise
+   */
+  bool pollKey(TCOD_key_t& key);
+
+ private:
+  void moveCursor(int x, int y);
+  void setColors(const TCOD_ColorRGBA& fg, const TCOD_ColorRGBA& bg);
+  void readInput();
+  size_t decodeKey(const uint8_t* data, size_t size, bool final);
+  void pushKey(TCOD_keycode_t vk, char c = 0, const char* text = "", int modifiers = 0);
+  void writeOutput();
+
+  bool opened{false};
+  std::unique_ptr<termios> savedMode{};  // the terminal settings to restore
+  int columns{};  // size of the terminal
+  int rows{};
+  int shadowWidth{};  // size of the console in the shadow copy
+  int shadowHeight{};
+  std::vector<TCOD_ConsoleTile> shadow{};  // what the terminal displays, empty when unknown
+  std::string output{};  // the escape sequences of the frame being drawn
+  int cursorX{-1};  // -1 when unknown
+  int cursorY{-1};
+  TCOD_ColorRGBA currentFg{};
+  TCOD_ColorRGBA currentBg{};
+  bool colorsKnown{false};
+  std::vector<uint8_t> input{};  // bytes read but not decoded yet
+  std::deque<TCOD_key_t> keys{};
+};
+}  // namespace render
@@ -0,0 +1,192 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "render/text_layout.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include "vendor/utf8proc/utf8proc.h"
+
+namespace render {
+void TextLayout::setColourControl(TCOD_colctrl_t control, const TCODColor& foreground, const TCODColor& background) {
+  if (control < TCOD_COLCTRL_1 || control > TCOD_COLCTRL_NUMBER) return;
+  controlForeground[control - TCOD_COLCTRL_1] = foreground;
+  controlBackground[control - TCOD_COLCTRL_1] = background;
+  TCODConsole::setColorControl(control, foreground, background);
+}
+
+void TextLayout::setText(std::string_view newText) {
+  if (parsed && newText == text) return;
+  text = newText;
+  parse();
+}
+
+void TextLayout::parse() {
+  glyphs.clear();
+  palette.clear();
+  uint16_t foreground = DEFAULT_COLOUR;
+  uint16_t background = DEFAULT_COLOUR;
+  const auto* bytes = reinterpret_cast<const utf8proc_uint8_t*>(text.data());
+  const size_t size = text.size();
+  size_t i = 0;
+  while (i < size) {
+    const uint8_t byte = bytes[i];
+    if (byte >= TCOD_COLCTRL_1 && byte <= TCOD_COLCTRL_NUMBER) {
+      foreground = background = byte;
+      ++i;
+    } else if (byte == TCOD_COLCTRL_FORE_RGB || byte == TCOD_COLCTRL_BACK_RGB) {
+      // followed by the red, green and blue bytes
+      if (i + 3 >= size) break;
+      palette.push_back(TCOD_ColorRGB{bytes[i + 1], bytes[i + 2], bytes[i + 3]});
+      const auto index = static_cast<uint16_t>(FIRST_RGB + palette.size() - 1);
+      (byte == TCOD_COLCTRL_FORE_RGB ? foreground : background) = index;
+      i += 4;
+    } else if (byte == TCOD_COLCTRL_STOP) {
+      foreground = background = DEFAULT_COLOUR;
+      ++i;
+    } else {
+      utf8proc_int32_t codepoint{};
+      utf8proc_ssize_t length = utf8proc_iterate(bytes + i, static_cast<utf8proc_ssize_t>(size - i), &codepoint);
+      if (length <= 0) {
+        // invalid UTF-8: show a replacement character and resynchronise on the next byte
+        codepoint = 0xFFFD;
+        length = 1;
+      }
+      glyphs.push_back(Glyph{codepoint, foreground, background});
+      i += static_cast<size_t>(length);
+    }
+  }
+  // the text changed: the lines must be broken again
+  parsed = true;
+  layoutWidth = -1;
+}
+
+void TextLayout::layout(int width) {
+  if (!parsed) parse();
+  const int newWidth = std::max(0, width);
+  if (newWidth == layoutWidth) return;
+  layoutWidth = newWidth;
+  lines.clear();
+  if (glyphs.empty()) return;
+  const size_t limit = newWidth > 0 ? static_cast<size_t>(newWidth) : std::numeric_limits<size_t>::max();
+  const size_t none = std::numeric_limits<size_t>::max();
+  const auto addLine = [&](size_t first, size_t end) {
+    while (end > first && glyphs[end - 1].ch == ' ') --end;
+    lines.push_back(Line{first, static_cast<int>(end - first)});
+  };
+  size_t start = 0;
+  size_t lastSpace = none;
+  for (size_t i = 0; i < glyphs.size(); ++i) {
+    const int ch = glyphs[i].ch;
+    if (ch == '\n') {
+      addLine(start, i);
+      start = i + 1;
+      lastSpace = none;
+      continue;
+    }
+    if (i - start >= limit) {
+      if (ch == ' ') {
+        // break on this space, dropping it
+        addLine(start, i);
+        start = i + 1;
+        lastSpace = none;
+        continue;
+      }
+      if (lastSpace != none) {
+        addLine(start, lastSpace);
+        start = lastSpace + 1;
+      } else {
+        // the word doesn't fit on a line: split it
+        addLine(start, i);
+        start = i;
+      }
+      lastSpace = none;
+    }
+    if (ch == ' ') lastSpace = i;
+  }
+  addLine(start, glyphs.size());
+}
+
+int TextLayout::getHeight(int width) {
+  layout(width);
+  return static_cast<int>(lines.size());
+}
+
+int TextLayout::getWidth(int width) {
+  layout(width);
+  int longest = 0;
+  for (const Line& line : lines) longest = std::max(longest, line.length);
+  return longest;
+}
+
+TCODColor TextLayout::colour(uint16_t index, bool foreground, const TCODColor& defaultColour) const {
+  if (index == DEFAULT_COLOUR) return defaultColour;
+  if (index < FIRST_RGB) return foreground ? controlForeground[index - 1] : controlBackground[index - 1];
+  return TCODColor{palette[index - FIRST_RGB]};
+}
+
+int TextLayout::draw(
+    TCODConsole& console, int x, int y, int width, int height, TCOD_alignment_t alignment, TCOD_bkgnd_flag_t flag) {
+  layout(width);
+  TCOD_Console* data = console.get_data();
+  if (!data) data = TCOD_sys_get_internal_console();
+  if (!data) return 0;
+  const TCODColor defaultForeground = console.getDefaultForeground();
+  const TCODColor defaultBackground = console.getDefaultBackground();
+  const int count = height > 0 ? std::min(height, static_cast<int>(lines.size())) : static_cast<int>(lines.size());
+  for (int index = 0; index < count; ++index) {
+    const Line& line = lines[index];
+    const int row = y + index;
+    if (row < 0 || row >= data->h) continue;
+    int column = x;
+    if (alignment == TCOD_CENTER) column -= line.length / 2;
+    if (alignment == TCOD_RIGHT) column -= line.length - 1;
+    const int first = std::max(0, -column);
+    const int last = std::min(line.length, data->w - column);
+    TCOD_ConsoleTile* tiles = data->tiles + static_cast<size_t>(row) * data->w + column;
+    for (int i = first; i < last; ++i) {
+      const Glyph& glyph = glyphs[line.first + i];
+      const TCODColor foreground = colour(glyph.foreground, true, defaultForeground);
+      tiles[i].ch = glyph.ch;
+      tiles[i].fg = TCOD_ColorRGBA{foreground.r, foreground.g, foreground.b, 255};
+      if (flag == TCOD_BKGND_NONE) continue;
+      const TCODColor background = colour(glyph.background, false, defaultBackground);
+      if (flag == TCOD_BKGND_SET) {
+        tiles[i].bg = TCOD_ColorRGBA{background.r, background.g, background.b, 255};
+      } else {
+        TCOD_console_set_char_background(data, column + i, row, background, flag);
+      }
+    }
+  }
+  return count;
+}
+}  // namespace render
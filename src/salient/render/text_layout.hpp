@@ -0,0 +1,159 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <cstdint>
+#include <libtcod/libtcod.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace render {
+/**
+ * Text laid out once and drawn many times, as a replacement for <code>printRectEx()</code> on text that seldom
+ * changes. The UTF-8 text and its libtcod colour controls (<code>TCOD_COLCTRL_1</code> to <code>TCOD_COLCTRL_5</code>,
+ * <code>TCOD_COLCTRL_FORE_RGB</code>, <code>TCOD_COLCTRL_BACK_RGB</code> and <code>TCOD_COLCTRL_STOP</code>) are parsed
+ * when the text is set, and the lines are broken again only when the text or the width changes. Drawing copies the
+ * cached code points and colours into the console.
+ */
+class TextLayout {
+ public:
+  TextLayout() = default;
+  /**
+   * Creates a layout of a text.
+   * @param text the UTF-8 text
+   */
+  explicit TextLayout(std::string_view text) { setText(text); }
+  /**
+   * Changes the text. Nothing is done if it is the same as before.
+   * @param text the UTF-8 text
+   */
+  void setText(std::string_view text);
+  const std::string& getText() const { return text; }
+  /**
+   * Breaks the text into lines no wider than a width, unless it was already done for that width. Words longer than the
+   * width are split. Drawing does this by itself.
+   * @param width the width in cells, 0 or less for no wrapping
+   */
+  void layout(int width);
+  /**
+   * Gets the number of lines of the text, laid out for a width.
+   * @param width the width in cells, 0 or less for no wrapping
+   * @return the number of lines
+   */
+  int getHeight(int width);
+  /**
+   * Gets the length of the longest line of the text, laid out for a width.
+   * @param width the width in cells, 0 or less for no wrapping
+   * @return the length of the longest line in cells
+   */
+  int getWidth(int width);
+  /**
+   * Draws the text the way <code>printRectEx()</code> would. The default foreground colour of the console is used
+   * where no colour control applies, and its default background colour is applied with the background flag.
+   * @param console the console
+   * @param x the <i>x</i> coordinate of the left side, the centre or the right side of the text, depending on the
+   * alignment
+   * @param y the <i>y</i> coordinate of the first line
+   * @param width the width the text is wrapped at, 0 or less for no wrapping
+   * @param height the maximum number of lines drawn, 0 or less for all of them
+   * @param alignment the alignment of the lines
+   * @param flag how the background colours are applied
+   * @return the number of lines drawn
+   */
+  int draw(
+      TCODConsole& console,
+      int x,
+      int y,
+      int width,
+      int height,
+      TCOD_alignment_t alignment = TCOD_LEFT,
+      TCOD_bkgnd_flag_t flag = TCOD_BKGND_NONE);
+  /**
+   * Sets the colours of a colour control, for every layout and libtcod's own printing functions alike.
+   * @param control the control, from <code>TCOD_COLCTRL_1</code> to <code>TCOD_COLCTRL_5</code>
+   * @param foreground the foreground colour
+   * @param background the background colour
+   */
+  static void setColourControl(TCOD_colctrl_t control, const TCODColor& foreground, const TCODColor& background);
+  /**
+   * Gets the foreground colour of a colour control.
+   * @param control the control, from <code>TCOD_COLCTRL_1</code> to <code>TCOD_COLCTRL_5</code>
+   * @return the colour
+   */
+  static const TCODColor& getControlForeground(int control) { return controlForeground[control - TCOD_COLCTRL_1]; }
+  /**
+   * Gets the background colour of a colour control.
+   * @param control the control, from <code>TCOD_COLCTRL_1</code> to <code>TCOD_COLCTRL_5</code>
+   * @return the colour
+   */
+  static const TCODColor& getControlBackground(int control) { return controlBackground[control - TCOD_COLCTRL_1]; }
+
+ private:
+  /**
+   * A parsed code point with the indices of its colours in the palette.
+   */
+  struct Glyph {
+    int ch{};
+    uint16_t foreground{};
+    uint16_t background{};
+  };
+  /**
+   * A line, as a range of glyphs. Trailing spaces are left out.
+   */
+  struct Line {
+    size_t first{};
+    int length{};
+  };
+  static constexpr uint16_t DEFAULT_COLOUR = 0;  // the console's default colour
+  static constexpr uint16_t FIRST_RGB = 1 + TCOD_COLCTRL_NUMBER;  // palette indices before this are colour controls
+  static inline TCODColor controlForeground[TCOD_COLCTRL_NUMBER]{
+      TCODColor{255, 255, 255}, TCODColor{255, 255, 255}, TCODColor{255, 255, 255}, TCODColor{255, 255, 255},
+      TCODColor{255, 255, 255}};
+  static inline TCODColor controlBackground[TCOD_COLCTRL_NUMBER]{};
+  /**
+   * Parses the text into glyphs.
+   */
+  void parse();
+  /**
+   * Gets the colour of a palette index.
+   */
+  TCODColor colour(uint16_t index, bool foreground, const TCODColor& defaultColour) const;
+
+  std::string text{};
+  std::vector<Glyph> glyphs{};  // the parsed text, line feeds included
+  std::vector<TCOD_ColorRGB> palette{};  // the colours of TCOD_COLCTRL_FORE_RGB and TCOD_COLCTRL_BACK_RGB
+  std::vector<Line> lines{};
+  int layoutWidth{};
+  bool parsed{false};
+};
+}  // namespace render
@@ -0,0 +1,163 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "render/transition.hpp"
+
+#include <SDL_timer.h>
+
+#include <algorithm>
+
+#include "render/pixels.hpp"
+
+namespace render {
+namespace {
+constexpr PlanarConsole::Plane PLANES[] = {PlanarConsole::PLANE_FOREGROUND, PlanarConsole::PLANE_BACKGROUND};
+}  // namespace
+
+void Transition::start(const TCOD_Console& outgoing, const module::TransitionSettings& newSettings) {
+  snapshot.fromConsole(outgoing);
+  begin(newSettings);
+}
+
+void Transition::start(const TCODColor& colour, int width, int height, const module::TransitionSettings& newSettings) {
+  snapshot.resize(width, height);
+  const TCOD_ColorRGBA plain{colour.r, colour.g, colour.b, 255};
+  snapshot.clear(' ', plain, plain);
+  begin(newSettings);
+}
+
+void Transition::begin(const module::TransitionSettings& newSettings) {
+  settings = newSettings;
+  running = settings.type != module::TRANSITION_NONE;
+  started = false;
+  progress = 0.0f;
+  if (settings.type == module::TRANSITION_DISSOLVE) {
+    // a scrambled but stable order, so the dissolve doesn't flicker
+    order.resize(static_cast<size_t>(snapshot.getWidth()) * snapshot.getHeight());
+    uint32_t state = 0x9E3779B9u;
+    for (uint8_t& key : order) {
+      state ^= state << 13;
+      state ^= state >> 17;
+      state ^= state << 5;
+      key = static_cast<uint8_t>(state >> 24);
+    }
+  }
+}
+
+void Transition::apply(TCOD_Console& console, jobs::JobPool& pool) {
+  if (!running) return;
+  if (console.w != snapshot.getWidth() || console.h != snapshot.getHeight()) {
+    // the screen was resized: the snapshot can't be used anymore
+    running = false;
+    return;
+  }
+  const uint32_t now = SDL_GetTicks();
+  if (!started) {
+    startTime = now;
+    started = true;
+  }
+  progress = settings.duration ? std::min(1.0f, static_cast<float>(now - startTime) / settings.duration) : 1.0f;
+  if (progress >= 1.0f) {
+    // the last frame is the incoming screen as it is
+    running = false;
+    return;
+  }
+  const int level = static_cast<int>(progress * 256.0f);
+  frame.fromConsole(console);
+  const int height = frame.getHeight();
+  const size_t bands = static_cast<size_t>((height + BAND_HEIGHT - 1) / BAND_HEIGHT);
+  pool.parallelFor(bands, [&](size_t band) {
+    const int firstRow = static_cast<int>(band) * BAND_HEIGHT;
+    blendRows(firstRow, std::min(height, firstRow + BAND_HEIGHT), level);
+  });
+  frame.toConsole(console);
+}
+
+void Transition::blendRows(int firstRow, int lastRow, int level) {
+  const int width = frame.getWidth();
+  const size_t offset = static_cast<size_t>(firstRow) * width;
+  const size_t count = static_cast<size_t>(lastRow - firstRow) * width;
+  int* glyphs = frame.getGlyphs() + offset;
+  const int* oldGlyphs = snapshot.getGlyphs() + offset;
+  switch (settings.type) {
+    case module::TRANSITION_CROSSFADE:
+      for (PlanarConsole::Plane plane : PLANES) {
+        pixels::blend(frame.getColours(plane) + offset, snapshot.getColours(plane) + offset, count, 256 - level);
+      }
+      if (level < 128) std::copy_n(oldGlyphs, count, glyphs);
+      break;
+    case module::TRANSITION_FADE: {
+      const TCOD_ColorRGBA colour{settings.colour.r, settings.colour.g, settings.colour.b, 255};
+      // the first half fades the outgoing screen out, the second half fades the incoming one in
+      const bool outgoing = level < 128;
+      if (outgoing) std::copy_n(oldGlyphs, count, glyphs);
+      for (PlanarConsole::Plane plane : PLANES) {
+        TCOD_ColorRGBA* colours = frame.getColours(plane) + offset;
+        if (outgoing) std::copy_n(snapshot.getColours(plane) + offset, count, colours);
+        pixels::blend(colours, count, colour, outgoing ? level * 2 : (256 - level) * 2);
+      }
+      break;
+    }
+    case module::TRANSITION_WIPE: {
+      // the columns left of the front show the incoming screen, followed by a soft edge
+      const int front = level * (width + WIPE_EDGE) / 256 - WIPE_EDGE;
+      const int hidden = std::max(0, front + WIPE_EDGE);
+      for (int y = firstRow; y < lastRow; ++y) {
+        const size_t row = static_cast<size_t>(y) * width;
+        int* rowGlyphs = frame.getGlyphs() + row;
+        const int* oldRowGlyphs = snapshot.getGlyphs() + row;
+        for (PlanarConsole::Plane plane : PLANES) {
+          TCOD_ColorRGBA* colours = frame.getColours(plane) + row;
+          const TCOD_ColorRGBA* oldColours = snapshot.getColours(plane) + row;
+          for (int x = std::max(0, front); x < std::min(width, hidden); ++x) {
+            pixels::blend(colours + x, oldColours + x, 1, (x - front) * 256 / WIPE_EDGE);
+          }
+          if (hidden < width) std::copy(oldColours + hidden, oldColours + width, colours + hidden);
+        }
+        for (int x = std::max(0, front); x < std::min(width, hidden); ++x) {
+          if ((x - front) * 2 >= WIPE_EDGE) rowGlyphs[x] = oldRowGlyphs[x];
+        }
+        if (hidden < width) std::copy(oldRowGlyphs + hidden, oldRowGlyphs + width, rowGlyphs + hidden);
+      }
+      break;
+    }
+    case module::TRANSITION_DISSOLVE:
+      pixels::select(glyphs, oldGlyphs, order.data() + offset, level, count);
+      for (PlanarConsole::Plane plane : PLANES) {
+        pixels::select(
+            frame.getColours(plane) + offset, snapshot.getColours(plane) + offset, order.data() + offset, level, count);
+      }
+      break;
+    case module::TRANSITION_NONE:
+      break;
+  }
+}
+}  // namespace render
@@ -0,0 +1,112 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <cstdint>
+#include <libtcod/libtcod.hpp>
+#include <vector>
+
+#include "jobs/pool.hpp"
+#include "module/module.hpp"
+#include "render/planar_console.hpp"
+
+namespace render {
+/**
+ * Plays a transition between two screens without rendering the outgoing one again: the outgoing screen is captured
+ * once, when the transition starts, and each following frame of the incoming screen is blended with that snapshot on
+ * the job pool, over row bands.
+ *
+ * The transition's clock starts on the first blended frame rather than in <code>start()</code>, so a slow first frame
+ * of the incoming modules doesn't eat into it. It then follows the time, not the frame count, and always ends on time.
+ */
+class Transition {
+ public:
+  /**
+   * Starts a transition from a console.
+   * @param outgoing the last frame of the outgoing screen
+   * @param settings the transition settings; <code>TRANSITION_NONE</code> cancels the running transition
+   */
+  void start(const TCOD_Console& outgoing, const module::TransitionSettings& settings);
+  /**
+   * Starts a transition from a plain colour, for instance to fade a screen in.
+   * @param colour the colour
+   * @param width the width of the screen
+   * @param height the height of the screen
+   * @param settings the transition settings; <code>TRANSITION_NONE</code> cancels the running transition
+   */
+  void start(const TCODColor& colour, int width, int height, const module::TransitionSettings& settings);
+  /**
+   * Stops the running transition, the incoming screen being shown as it is from then on.
+   */
+  void cancel() { running = false; }
+  /**
+   * Checks whether a transition is running.
+   * @return <code>true</code> if a transition is running, <code>false</code> otherwise
+   */
+  bool isRunning() const { return running; }
+  /**
+   * Gets how far the running transition is.
+   * @return the progress, from 0 to 1
+   */
+  float getProgress() const { return progress; }
+  /**
+   * Blends a frame of the incoming screen with the outgoing one. The transition stops on its last frame, or if the
+   * console's size doesn't match the snapshot anymore.
+   * @param console the frame of the incoming screen, blended in place
+   * @param pool the job pool the rows are blended on
+   */
+  void apply(TCOD_Console& console, jobs::JobPool& pool);
+
+ private:
+  static constexpr int BAND_HEIGHT = 8;  // rows blended by one job
+  static constexpr int WIPE_EDGE = 4;  // width of the soft edge of a wipe, in cells
+  /**
+   * Sets up a transition once the snapshot is taken.
+   */
+  void begin(const module::TransitionSettings& newSettings);
+  /**
+   * Blends rows of the frame with the snapshot.
+   * @param firstRow the first row
+   * @param lastRow the row after the last one
+   * @param level the progress, from 0 to 256
+   */
+  void blendRows(int firstRow, int lastRow, int level);
+  module::TransitionSettings settings{};
+  PlanarConsole snapshot{};  // the outgoing screen
+  PlanarConsole frame{};  // the incoming screen
+  std::vector<uint8_t> order{};  // the dissolve order of each cell
+  uint32_t startTime{};
+  bool started{false};
+  bool running{false};
+  float progress{};
+};
+}  // namespace render
@@ -38,17 +38,24 @@
 #include "globals.h"
 
 #ifdef __cplusplus
+#include "base/bit_plane.hpp"
 #include "base/circle.hpp"
 #include "base/font.hpp"
 #include "base/key.hpp"
 #include "base/point.hpp"
 #include "base/rect.hpp"
+#include "base/tile_map.hpp"
 #include "config/config.hpp"
+#include "ecs/scheduler.hpp"
+#include "ecs/world.hpp"
+#include "ecs/world_module.hpp"
 #include "engine/engine.hpp"
 #include "events/callback.hpp"
 #include "events/delegate.hpp"
 #include "events/events.hpp"
 #include "events/signal.hpp"
+#include "fov/fov_cache.hpp"
+#include "fov/shadowcast.hpp"
 #include "imod/bsod.hpp"
 #include "imod/credits.hpp"
 #include "imod/speed.hpp"
@@ -56,9 +63,20 @@
 #include "logger/log.hpp"
 #include "module/factory.hpp"
 #include "module/module.hpp"
+#include "render/effects.hpp"
+#include "render/planar_console.hpp"
+#include "render/print.hpp"
+#include "render/text_layout.hpp"
+#include "render/transition.hpp"
+#include "screen/screen.hpp"
 #include "version.hpp"
 #include "widget/button.hpp"
 #include "widget/checkbox.hpp"
+#include "widget/layout.hpp"
+#include "widget/list_view.hpp"
+#include "widget/log_view.hpp"
+#include "widget/style_rules.hpp"
+#include "widget/table_view.hpp"
 #include "widget/widget.hpp"
 #endif  // __cplusplus
 
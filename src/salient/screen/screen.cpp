@@ -0,0 +1,63 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "screen/screen.hpp"
+
+#include "engine/engine.hpp"
+
+namespace screen {
+void Screen::setFadeIn(int lengthInMilli, TCODColor col) {
+  fadeInLength = lengthInMilli;
+  fadeInColor = col;
+}
+
+void Screen::setFadeOut(int lengthInMilli, TCODColor col) {
+  fadeOutLength = lengthInMilli;
+  fadeOutColor = col;
+  module::TransitionSettings settings{};
+  if (lengthInMilli > 0) {
+    // the fade through the colour has an outgoing and an incoming half
+    settings.type = module::TRANSITION_FADE;
+    settings.duration = static_cast<uint32_t>(lengthInMilli) * 2;
+    settings.colour = col;
+  }
+  setTransition(settings);
+}
+
+void Screen::onActivate() {
+  engine::Engine* engine = getEngine();
+  if (fadeInLength <= 0 || engine->getTransition().isRunning()) return;
+  module::TransitionSettings settings{};
+  settings.type = module::TRANSITION_CROSSFADE;
+  settings.duration = static_cast<uint32_t>(fadeInLength);
+  engine->getTransition().start(fadeInColor, engine->getRootWidth(), engine->getRootHeight(), settings);
+}
+}  // namespace screen
@@ -1,36 +1,40 @@
 #pragma once
 #include <libtcod/libtcod.hpp>
 
+#include "module/module.hpp"
+
 namespace screen {
-class Screen : public Module {
+/**
+ * A module standing for a whole screen of the game, such as a menu or a chapter. It can fade in when it's activated
+ * and fade out when it ends, through the engine's transitions: the screens are never rendered twice to do so.
+ */
+class Screen : public module::Module {
  public:
-  Screen(float fadeLvl) : Module{}, fadeLvl{fadeLvl} {}
-  Screen(const char* name, float fadeLvl) : UmbraModule{name}, fadeLvl{fadeLvl} {}
-  void render() override = 0;
-  virtual bool update(float elapsed, TCOD_key_t k, TCOD_mouse_t mouse) = 0;
-  void onEvent(const SDL_Event&) override;
-  // void keyboard(TCOD_key_t& key) override { key_ = key; }
-  //  void mouse(TCOD_mouse_t& ms) override { ms_ = ms; }
-  bool update(void) override;
-
-  void setFadeIn(int lengthInMilli, TCODColor col = TCODColor::black);  // set fade lengths in milliseconds
-  void setFadeOut(int lengthInMilli, TCODColor col = TCODColor::black);  // set fade lengths in milliseconds
+  Screen() = default;
+  explicit Screen(const char* name) : Module{name} {}
+  /**
+   * Sets the fade in played when the screen is activated. It is skipped if a transition is already running, for
+   * instance the fade out of the previous screen.
+   * @param lengthInMilli the length of the fade in milliseconds, 0 for none
+   * @param col the colour the screen fades in from
+   */
+  void setFadeIn(int lengthInMilli, TCODColor col = TCODColor::black);
+  /**
+   * Sets the fade out played when the screen ends. The screen fades to the colour, then the screens left once it has
+   * ended, such as its fallback, fade in from the colour for as long.
+   * @param lengthInMilli the length of the fade in milliseconds, 0 for none
+   * @param col the colour the screen fades out to
+   */
+  void setFadeOut(int lengthInMilli, TCODColor col = TCODColor::black);
 
  protected:
-  float timefix{};  // remove activate execution time for smooth animation
-  float fadeLvl{};
+  /**
+   * Starts the fade in. Screens overriding it must call it.
+   */
+  void onActivate() override;
   int fadeInLength{};
   TCODColor fadeInColor{};
   int fadeOutLength{};
   TCODColor fadeOutColor{};
-
-  enum { FADE_UP, FADE_DOWN, FADE_OFF, FADE_NONE } fade{FADE_UP};
-  TCOD_key_t key_{};
-  TCOD_mouse_t ms_{};
-  TCODImage* loadChapterPicture(bool big = false);
-  void onActivate() override {
-    fadeLvl = 0;
-    fade = FADE_UP;
-  }
 };
 }  // namespace screen
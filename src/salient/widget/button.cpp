@@ -35,48 +35,48 @@
 
 namespace widget {
 Button::Button(widget::Widget* parent, int x, int y, int w, int h, const char* tag) {
-  this->parent = parent;
+  setParent(parent);
   rect.set(x, y, w, h);
   this->tag = tag;
 }
 
 Button::Button(widget::Widget* new_parent, int x, int y, int w, int h, std::string new_tag) {
-  parent = new_parent;
+  setParent(new_parent);
   rect.set(x, y, w, h);
   tag = new_tag;
 }
 
 void Button::set(widget::Widget* new_parent, int x, int y, int w, int h, const char* new_tag) {
-  parent = new_parent;
+  setParent(new_parent);
   rect.set(x, y, w, h);
   tag = new_tag;
+  markLayoutDirty();
 }
 
 void Button::render(TCODConsole* con) {
   if (!visible) return;
+  refreshStyle();
   TCODColor col = con->getDefaultForeground();
-  widget::StyleSheetSet* s;
-  if (rect.mouseHover) {
-    if (rect.mouseDown)
-      s = &style.active;
-    else
-      s = &style.hover;
-  } else
-    s = &style.normal;
+  widget::StyleSheetSet* s = &style.get(rect.mouseHover ? (rect.mouseDown ? STYLE_ACTIVE : STYLE_HOVER) : STYLE_NORMAL);
 
   con->setDefaultForeground(s->borderColour());
   con->setDefaultBackground(s->backgroundColour());
   con->printFrame(rect.x, rect.y, rect.w, rect.h, true, TCOD_BKGND_SET, NULL);
   con->setDefaultForeground(s->colour());
-  if (!tag.empty())
-    con->printRectEx(
-        rect.x + (rect.w / 2),
-        rect.y + (rect.h / 2),
-        rect.w - 2,
-        rect.h - 2,
-        TCOD_BKGND_NONE,
-        TCOD_CENTER,
-        tag.c_str());
+  if (!tag.empty()) {
+    label.setText(tag);
+    label.draw(*con, rect.x + (rect.w / 2), rect.y + (rect.h / 2), rect.w - 2, rect.h - 2, TCOD_CENTER);
+  }
   con->setDefaultForeground(col);
 }
+
+base::Point Button::measureContent() {
+  // the label inside a frame
+  label.setText(tag);
+  return base::Point{label.getWidth(0) + 2, label.getHeight(0) + 2};
+}
+
+void Button::hashState(RenderState& state) {
+  state.add(visible).add(rect.x).add(rect.y).add(rect).add(style).add(tag);
+}
 }  // namespace widget
@@ -34,6 +34,7 @@
 #include <iostream>
 
 #include "base/rect.hpp"
+#include "render/text_layout.hpp"
 #include "widget/widget.hpp"
 
 namespace widget {
@@ -69,7 +70,17 @@ class Button : public widget::Widget {
    * Renders the button.
    */
   virtual void render(TCODConsole* con);
+  /**
+   * Adds the button's look to the render state of the widget containing it.
+   * @param state the render state
+   */
+  void hashState(RenderState& state) override;
+  const char* getStyleTag() const override { return "button"; }
+  base::Point measureContent() override;
   bool visible{true};  // visibility (can be toggled)
   std::string tag{""};  // the descriptive tag
+
+ private:
+  render::TextLayout label{};  // the tag, laid out
 };
 }  // namespace widget
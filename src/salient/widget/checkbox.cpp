@@ -60,7 +60,8 @@ void Checkbox::set(widget::Widget* new_parent, int x, int y, int w, int h, const
 
 void Checkbox::mouse(TCOD_mouse_t& ms) {
   if (!visible) return;
-  if (area.contains(ms.cx - parent->rect.x, ms.cy - parent->rect.y)) {
+  const base::Point origin = parent->getScreenPosition();
+  if (area.contains(ms.cx - origin.x, ms.cy - origin.y)) {
     area.mouseHover = true;
     onMouseOver();
   } else
@@ -0,0 +1,88 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+namespace widget {
+/**
+ * How a widget places its children.
+ */
+enum LayoutMode {
+  /**
+   * The children are left where they have been put, in the widget's coordinates.
+   */
+  LAYOUT_NONE,
+  /**
+   * The children are placed side by side, from left to right.
+   */
+  LAYOUT_ROW,
+  /**
+   * The children are placed one below the other, from top to bottom.
+   */
+  LAYOUT_COLUMN,
+  /**
+   * The children are placed on top of each other, each one taking the whole inner area of the widget.
+   */
+  LAYOUT_STACK
+};
+
+/**
+ * Where children are put within the space they are given.
+ */
+enum LayoutAlign {
+  ALIGN_START,  // left or top
+  ALIGN_CENTER,
+  ALIGN_END,  // right or bottom
+  ALIGN_STRETCH  // the whole space (cross axis only)
+};
+
+/**
+ * The layout a widget applies to its children.
+ */
+struct Layout {
+  LayoutMode mode{LAYOUT_NONE};
+  int padding{0};  // cells left free inside the widget's borders, on every side
+  int gap{0};  // cells left free between two children
+  LayoutAlign align{ALIGN_STRETCH};  // placement on the cross axis, and on both axes in a stack
+  LayoutAlign justify{ALIGN_START};  // placement on the main axis of the space no child grows into
+};
+
+/**
+ * The constraints a widget gives its parent's layout.
+ */
+struct LayoutConstraints {
+  int width{-1};  // preferred width, -1 to measure the widget's contents
+  int height{-1};  // preferred height, -1 to measure the widget's contents
+  int minWidth{0};
+  int minHeight{0};
+  int grow{0};  // share of the parent's free space on the main axis the widget takes, 0 for none
+};
+}  // namespace widget
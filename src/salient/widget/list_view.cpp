@@ -0,0 +1,89 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "widget/list_view.hpp"
+
+#include "render/print.hpp"
+
+namespace widget {
+uint32_t ListView::add(std::string_view text, const TCODColor& colour) {
+  const auto index = static_cast<uint32_t>(items.size());
+  items.push_back(ListItem{std::string{text}, colour});
+  insertRow(index);
+  return index;
+}
+
+void ListView::set(uint32_t index, std::string_view text, const TCODColor& colour) {
+  detachRow(index);
+  ListItem& item = items[index];
+  item.text = text;
+  item.colour = colour;
+  insertRow(index);
+}
+
+void ListView::remove(uint32_t index) {
+  const auto last = static_cast<uint32_t>(items.size() - 1);
+  detachRow(index);
+  if (index != last) {
+    detachRow(last);
+    items[index] = std::move(items[last]);
+  }
+  items.pop_back();
+  eraseRow(index, last);
+}
+
+void ListView::clear() {
+  items.clear();
+  resetRows(0);
+}
+
+void ListView::sortByText(bool ascending) {
+  setCompare([this, ascending](uint32_t a, uint32_t b) {
+    return ascending ? items[a].text < items[b].text : items[b].text < items[a].text;
+  });
+}
+
+void ListView::filterByText(std::string_view text) {
+  if (text.empty()) {
+    setFilter({});
+    return;
+  }
+  setFilter([this, needle = std::string{text}](uint32_t row) {
+    return items[row].text.find(needle) != std::string::npos;
+  });
+}
+
+void ListView::drawRow(TCODConsole& console, uint32_t row, int y, bool selected) {
+  const ListItem& item = items[row];
+  if (!selected) console.setDefaultForeground(item.colour);
+  render::printText(console, 0, y, item.text);
+}
+}  // namespace widget
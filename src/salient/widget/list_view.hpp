@@ -0,0 +1,100 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <cstdint>
+#include <libtcod/libtcod.hpp>
+#include <string>
+#include <string_view>
+
+#include "base/chunked_vector.hpp"
+#include "widget/virtual_view.hpp"
+
+namespace widget {
+/**
+ * An item of a list view.
+ */
+struct ListItem {
+  std::string text{};  // UTF-8 text, libtcod colour controls included
+  TCODColor colour{TCODColor::white};
+};
+
+/**
+ * A scrolling list of one line items, meant for lists of thousands of them such as inventories. Only the visible items
+ * are drawn; the items are stored in chunks, and sorting and filtering work on item indices.
+ */
+class ListView : public VirtualView {
+ public:
+  /**
+   * Appends an item.
+   * @param text the item's text
+   * @param colour the item's colour
+   * @return the item's index
+   */
+  uint32_t add(std::string_view text, const TCODColor& colour = TCODColor::white);
+  /**
+   * Changes an item. It is moved to its new place if the list is sorted.
+   * @param index the item's index
+   * @param text the item's text
+   * @param colour the item's colour
+   */
+  void set(uint32_t index, std::string_view text, const TCODColor& colour);
+  const ListItem& get(uint32_t index) const { return items[index]; }
+  /**
+   * Removes an item. The last item takes its index.
+   * @param index the item's index
+   */
+  void remove(uint32_t index);
+  /**
+   * Removes all the items.
+   */
+  void clear();
+  size_t size() const { return items.size(); }
+  /**
+   * Sorts the items by text.
+   * @param ascending <code>true</code> for alphabetical order, <code>false</code> for the reverse
+   */
+  void sortByText(bool ascending = true);
+  /**
+   * Shows only the items whose text contains a string.
+   * @param text the string to look for, empty to show all the items
+   */
+  void filterByText(std::string_view text);
+  const char* getStyleTag() const override { return "list"; }
+
+ protected:
+  void drawRow(TCODConsole& console, uint32_t row, int y, bool selected) override;
+
+ private:
+  base::ChunkedVector<ListItem> items{};
+};
+}  // namespace widget
@@ -0,0 +1,161 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "widget/log_view.hpp"
+
+#include <algorithm>
+
+namespace widget {
+static constexpr int WHEEL_ROWS = 3;  // rows scrolled per mouse wheel notch
+
+LogView::LogView(size_t capacity) : lines{capacity} { heights.resize(lines.capacity()); }
+
+void LogView::add(std::string_view text, const TCODColor& colour) {
+  const bool endVisible = offsetOf(lines.size()) < scroll + rect.h;
+  if (lines.size() == lines.capacity()) {
+    // the oldest line is dropped: move the view along with the remaining ones
+    const int dropped = heights.get(lines.slot(0));
+    if (scroll < dropped) ++contentVersion;
+    scroll = std::max<int64_t>(0, scroll - dropped);
+    droppedRows += dropped;
+  }
+  LogLine line{std::string{text}, colour};
+  const int height = measure(line);
+  heights.set(lines.push_back(std::move(line)), height);
+  if (following)
+    scroll = getMaxScroll();
+  else if (endVisible)
+    ++contentVersion;
+}
+
+void LogView::clear() {
+  lines.clear();
+  heights.resize(lines.capacity());
+  scroll = droppedRows = 0;
+  following = true;
+  ++contentVersion;
+}
+
+void LogView::setCapacity(size_t capacity) {
+  const size_t anchor = lineAt(scroll);
+  const size_t before = lines.size();
+  lines.setCapacity(capacity);
+  const size_t dropped = before - lines.size();
+  rebuild(anchor > dropped ? anchor - dropped : 0);
+}
+
+void LogView::scrollToLine(size_t index) {
+  if (index >= lines.size()) return;
+  const int64_t top = offsetOf(index);
+  const int64_t bottom = top + heights.get(lines.slot(index));
+  if (top < scroll)
+    scroll = top;
+  else if (bottom > scroll + rect.h)
+    scroll = std::min(top, bottom - rect.h);
+  following = scroll >= getMaxScroll();
+}
+
+void LogView::scrollBy(int rows) {
+  scroll = std::clamp<int64_t>(scroll + rows, 0, getMaxScroll());
+  following = scroll >= getMaxScroll();
+}
+
+void LogView::scrollToEnd() {
+  scroll = getMaxScroll();
+  following = true;
+}
+
+void LogView::onEvent(const SDL_Event& ev) {
+  Widget::onEvent(ev);
+  if (ev.type == SDL_MOUSEWHEEL && rect.mouseHover) scrollBy(-ev.wheel.y * WHEEL_ROWS);
+}
+
+void LogView::render() {
+  updateLayout();
+  if (rect.w > 0 && rect.w != wrapWidth) rewrap();
+  if (following) scroll = getMaxScroll();
+  renderCached();
+}
+
+void LogView::hashState(RenderState& state) { state.add(scroll + droppedRows).add(contentVersion); }
+
+void LogView::renderSurface(TCODConsole& console) {
+  console.setDefaultForeground(style.normal.colour());
+  console.setDefaultBackground(style.normal.backgroundColour());
+  console.clear();
+  size_t index = lineAt(scroll);
+  int y = static_cast<int>(offsetOf(index) - scroll);
+  for (; index < lines.size() && y < console.getHeight(); ++index) {
+    const LogLine& line = lines[index];
+    scratch.setText(line.text);
+    console.setDefaultForeground(line.colour);
+    scratch.draw(console, 0, y, console.getWidth(), 0, TCOD_LEFT);
+    y += heights.get(lines.slot(index));
+  }
+}
+
+int LogView::measure(const LogLine& line) {
+  scratch.setText(line.text);
+  return std::max(1, scratch.getHeight(std::max(0, wrapWidth)));
+}
+
+void LogView::rewrap() {
+  const size_t anchor = lineAt(scroll);
+  wrapWidth = rect.w;
+  rebuild(anchor);
+}
+
+void LogView::rebuild(size_t anchor) {
+  heights.resize(lines.capacity());
+  for (size_t i = 0; i < lines.size(); ++i) heights.set(lines.slot(i), measure(lines[i]));
+  scroll = following ? getMaxScroll() : std::min(offsetOf(std::min(anchor, lines.size())), getMaxScroll());
+  ++contentVersion;
+}
+
+int64_t LogView::offsetOf(size_t index) const {
+  if (index >= lines.size()) return heights.total();
+  const size_t head = lines.slot(0);
+  const size_t slot = lines.slot(index);
+  if (slot >= head) return heights.offset(slot) - heights.offset(head);
+  // the line is stored before the oldest one: count the rows up to the end of the buffer, then from its start
+  return heights.total() - heights.offset(head) + heights.offset(slot);
+}
+
+size_t LogView::lineAt(int64_t offset) const {
+  if (offset >= heights.total()) return lines.size();
+  const size_t head = lines.slot(0);
+  const int64_t target = heights.offset(head) + std::max<int64_t>(0, offset);
+  if (target < heights.total()) return heights.find(target) - head;
+  return heights.find(target - heights.total()) + lines.capacity() - head;
+}
+
+int64_t LogView::getMaxScroll() const { return std::max<int64_t>(0, heights.total() - rect.h); }
+}  // namespace widget
@@ -0,0 +1,147 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <SDL_events.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <libtcod/libtcod.hpp>
+#include <string>
+#include <string_view>
+
+#include "base/ring_buffer.hpp"
+#include "render/text_layout.hpp"
+#include "widget/row_index.hpp"
+#include "widget/widget.hpp"
+
+namespace widget {
+/**
+ * A line of a log view.
+ */
+struct LogLine {
+  std::string text{};  // UTF-8 text, libtcod colour controls included
+  TCODColor colour{TCODColor::white};
+};
+
+/**
+ * A scrollback of wrapped text lines, such as a message log. The lines are kept in a ring buffer, the oldest ones being
+ * dropped once it is full, and their wrapped heights in a row index, so that scrolling to any line or offset is
+ * logarithmic. Only the visible lines are laid out and drawn. The view follows new lines while it is scrolled to the
+ * end, and otherwise stays on the lines it shows.
+ */
+class LogView : public Widget {
+ public:
+  /**
+   * Creates a log view.
+   * @param capacity the number of lines kept
+   */
+  explicit LogView(size_t capacity = 100000);
+  /**
+   * Appends a line, dropping the oldest one if the log is full.
+   * @param text the line's text
+   * @param colour the line's colour
+   */
+  void add(std::string_view text, const TCODColor& colour = TCODColor::white);
+  /**
+   * Removes all the lines.
+   */
+  void clear();
+  /**
+   * Changes the number of lines kept. The oldest lines are dropped if there are too many.
+   * @param capacity the number of lines kept
+   */
+  void setCapacity(size_t capacity);
+  size_t size() const { return lines.size(); }
+  const LogLine& get(size_t index) const { return lines[index]; }
+  /**
+   * Scrolls just enough for a line to be visible.
+   * @param index the line's index, 0 being the oldest
+   */
+  void scrollToLine(size_t index);
+  /**
+   * Scrolls by a number of rows. Scrolling to the end makes the view follow new lines again.
+   * @param rows the number of rows, negative to scroll back
+   */
+  void scrollBy(int rows);
+  /**
+   * Scrolls to the end and follows new lines.
+   */
+  void scrollToEnd();
+  bool isFollowing() const { return following; }
+  /**
+   * Scrolls with the mouse wheel, then passes the event on to the children.
+   */
+  void onEvent(const SDL_Event& ev) override;
+  void render() override;
+  void hashState(RenderState& state) override;
+  const char* getStyleTag() const override { return "log"; }
+
+ protected:
+  void renderSurface(TCODConsole& console) override;
+
+ private:
+  /**
+   * Gets the number of rows a line takes once wrapped.
+   */
+  int measure(const LogLine& line);
+  /**
+   * Wraps all the lines again, for the current width.
+   */
+  void rewrap();
+  /**
+   * Measures all the lines again and scrolls back to a line, unless following new lines.
+   * @param anchor the index of the line to be shown at the top
+   */
+  void rebuild(size_t anchor);
+  /**
+   * Gets the offset of the top of a line, from the top of the oldest one.
+   * @param index the line's index, up to the number of lines
+   */
+  int64_t offsetOf(size_t index) const;
+  /**
+   * Finds the line covering an offset from the top of the oldest one.
+   * @return the line's index, or the number of lines if the offset is past the last one
+   */
+  size_t lineAt(int64_t offset) const;
+  int64_t getMaxScroll() const;
+
+  base::RingBuffer<LogLine> lines;
+  RowIndex heights{};  // heights of the wrapped lines, by ring buffer slot
+  render::TextLayout scratch{};  // lays out one line at a time
+  int wrapWidth{-1};  // the width the lines have been wrapped for
+  int64_t scroll{0};  // offset of the top of the view, from the top of the oldest line
+  int64_t droppedRows{0};  // rows dropped with the oldest lines: scroll + droppedRows identifies the view
+  bool following{true};
+  uint32_t contentVersion{0};  // incremented whenever a visible line changes
+};
+}  // namespace widget
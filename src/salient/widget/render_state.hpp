@@ -0,0 +1,109 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <cstdint>
+#include <libtcod/libtcod.hpp>
+#include <string_view>
+
+#include "base/point.hpp"
+#include "base/rect.hpp"
+#include "widget/stylesheet.hpp"
+
+namespace widget {
+/**
+ * Fingerprint of everything a widget's look depends on. Widgets feed it the values they draw, and their cached surface
+ * is only drawn again when the fingerprint changes.
+ */
+class RenderState {
+ public:
+  /**
+   * Adds an integral value or a flag to the fingerprint.
+   * @param value the value
+   * @return reference to the render state, for chaining
+   */
+  RenderState& add(int64_t value) {
+    for (int i = 0; i < 8; ++i) mix(static_cast<uint8_t>(value >> (8 * i)));
+    return *this;
+  }
+  /**
+   * Adds a colour to the fingerprint.
+   * @param colour the colour
+   * @return reference to the render state, for chaining
+   */
+  RenderState& add(const TCODColor& colour) { return add(colour.r << 16 | colour.g << 8 | colour.b); }
+  /**
+   * Adds a text to the fingerprint.
+   * @param text the text
+   * @return reference to the render state, for chaining
+   */
+  RenderState& add(std::string_view text) {
+    for (char c : text) mix(static_cast<uint8_t>(c));
+    return add(static_cast<int64_t>(text.size()));
+  }
+  /**
+   * Adds the size and the mouse interaction flags of an area to the fingerprint.
+   * @param rect the area
+   * @return reference to the render state, for chaining
+   */
+  RenderState& add(const base::Rect& rect) {
+    return add(rect.w).add(rect.h).add(rect.mouseHover << 1 | rect.mouseDown);
+  }
+  /**
+   * Adds the mouse interaction flags of a point to the fingerprint.
+   * @param point the point
+   * @return reference to the render state, for chaining
+   */
+  RenderState& add(const base::Point& point) { return add(point.mouseHover << 1 | point.mouseDown); }
+  /**
+   * Adds every colour of a style sheet to the fingerprint.
+   * @param style the style sheet
+   * @return reference to the render state, for chaining
+   */
+  RenderState& add(StyleSheet& style) {
+    for (StyleSheetSet* set : {&style.normal, &style.hover, &style.active}) {
+      add(set->colour()).add(set->backgroundColour()).add(set->borderColour());
+    }
+    return *this;
+  }
+  /**
+   * Gets the fingerprint.
+   * @return the fingerprint, never 0
+   */
+  uint64_t value() const { return hash | 1; }
+
+ private:
+  // FNV-1a
+  void mix(uint8_t byte) { hash = (hash ^ byte) * 0x100000001b3ull; }
+  uint64_t hash{0xcbf29ce484222325ull};
+};
+}  // namespace widget
@@ -0,0 +1,68 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "widget/row_index.hpp"
+
+namespace widget {
+void RowIndex::resize(size_t count) {
+  heights.assign(count, 0);
+  tree.assign(count + 1, 0);
+}
+
+void RowIndex::set(size_t row, int height) {
+  const int64_t delta = height - heights[row];
+  if (delta == 0) return;
+  heights[row] = height;
+  for (size_t i = row + 1; i < tree.size(); i += i & (~i + 1)) tree[i] += delta;
+}
+
+int64_t RowIndex::offset(size_t row) const {
+  int64_t sum = 0;
+  for (size_t i = row; i > 0; i -= i & (~i + 1)) sum += tree[i];
+  return sum;
+}
+
+size_t RowIndex::find(int64_t offset) const {
+  if (offset < 0) return 0;
+  // descend the tree, from the highest power of two below the size
+  size_t step = 1;
+  while (step * 2 < tree.size()) step *= 2;
+  size_t position = 0;  // number of rows whose total height is not past the offset
+  for (; step > 0; step /= 2) {
+    const size_t next = position + step;
+    if (next < tree.size() && tree[next] <= offset) {
+      position = next;
+      offset -= tree[next];
+    }
+  }
+  return position;
+}
+}  // namespace widget
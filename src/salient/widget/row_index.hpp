@@ -0,0 +1,81 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace widget {
+/**
+ * The heights of a sequence of rows, kept in a Fenwick tree so that both the offset of a row and the row at an offset
+ * are found in logarithmic time, and changing the height of a row costs as much. Used to scroll through rows of
+ * different heights, such as wrapped log lines, without walking them.
+ */
+class RowIndex {
+ public:
+  /**
+   * Sets the number of rows. All the heights are reset to 0.
+   * @param count the number of rows
+   */
+  void resize(size_t count);
+  size_t size() const noexcept { return heights.size(); }
+  /**
+   * Sets the height of a row.
+   * @param row the row's index
+   * @param height the row's height
+   */
+  void set(size_t row, int height);
+  int get(size_t row) const { return heights[row]; }
+  /**
+   * Gets the total height of the rows before a row.
+   * @param row the row's index, up to the number of rows
+   * @return the row's offset
+   */
+  int64_t offset(size_t row) const;
+  /**
+   * Gets the total height of all the rows.
+   * @return the total height
+   */
+  int64_t total() const { return offset(heights.size()); }
+  /**
+   * Finds the row covering an offset.
+   * @param offset the offset, from the top of the first row
+   * @return the index of the row, or the number of rows if the offset is past the last one
+   */
+  size_t find(int64_t offset) const;
+
+ private:
+  std::vector<int> heights{};
+  std::vector<int64_t> tree{};  // 1-based: node i holds the sum of the heights of the rows (i - lowbit(i), i]
+};
+}  // namespace widget
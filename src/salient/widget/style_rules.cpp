@@ -0,0 +1,173 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "widget/style_rules.hpp"
+
+#include <string.h>
+
+#include <algorithm>
+#include <array>
+#include <libtcod/libtcod.hpp>
+
+#include "config/config.hpp"
+
+namespace widget {
+static constexpr std::array propertyName = {"colour", "backgroundColour", "borderColour"};
+static constexpr std::array stateName = {"normal", "hover", "active"};
+
+// reads the style rules. The default listener would exit the program on a syntax error, which is not an option when
+// the file is being edited while the program runs.
+class StyleRulesReader : public ITCODParserListener {
+ public:
+  StyleRulesReader(std::vector<StyleRule>& rules, std::string& error) : rules(rules), error_(error) {}
+  bool parserNewStruct(TCODParser*, const TCODParserStruct*, const char* name) override {
+    rule = &rules.emplace_back();
+    if (name && StyleRules::parseSelector(name, *rule)) return true;
+    error_ = std::string("invalid style selector \"") + (name ? name : "") + "\"";
+    return false;
+  }
+  bool parserFlag(TCODParser*, const char*) override { return true; }
+  bool parserProperty(TCODParser*, const char* name, TCOD_value_type_t, TCOD_value_t value) override {
+    if (!rule) return true;
+    for (size_t i = 0; i < propertyName.size(); ++i) {
+      if (strcmp(name, propertyName[i]) == 0) {
+        rule->values[i] = TCODColor(value.col.r, value.col.g, value.col.b);
+        rule->properties |= 1u << i;
+      }
+    }
+    return true;
+  }
+  bool parserEndStruct(TCODParser*, const TCODParserStruct*, const char*) override {
+    rule = nullptr;
+    return true;
+  }
+  void error(const char* msg) override { error_ = msg; }
+
+ private:
+  std::vector<StyleRule>& rules;
+  std::string& error_;
+  StyleRule* rule{};
+};
+
+bool StyleRules::compile(const std::filesystem::path& path, std::vector<StyleRule>& rules, std::string& error) {
+  if (!std::filesystem::exists(path)) {
+    error = "Style sheet " + path.string() + " is missing.";
+    return false;
+  }
+  TCODParser parser;
+  TCODParserStruct* style = parser.newStructure("style");
+  for (const char* name : propertyName) style->addProperty(name, TCOD_TYPE_COLOR, false);
+  StyleRulesReader reader{rules, error};
+  {
+    std::lock_guard lock{config::Config::parserMutex};
+    parser.run(path.string().c_str(), &reader);
+  }
+  if (!error.empty()) return false;
+  // the rules are applied in this order when resolving a style, each one overriding the previous ones. A state makes
+  // a rule more specific than the same selector without one.
+  std::stable_sort(rules.begin(), rules.end(), [](const StyleRule& a, const StyleRule& b) {
+    if (a.specificity != b.specificity) return a.specificity < b.specificity;
+    return a.state < 0 && b.state >= 0;
+  });
+  return true;
+}
+
+bool StyleRules::parseSelector(std::string_view selector, StyleRule& rule) {
+  size_t end = selector.find_first_of(".#:");
+  rule.tag = selector.substr(0, end);
+  while (end != std::string_view::npos) {
+    const char kind = selector[end];
+    const size_t start = end + 1;
+    end = selector.find_first_of(".#:", start);
+    const std::string_view part = selector.substr(start, end == std::string_view::npos ? end : end - start);
+    if (part.empty()) return false;
+    if (kind == '.') {
+      if (!rule.styleClass.empty()) return false;  // a single class per selector
+      rule.styleClass = part;
+    } else if (kind == '#') {
+      if (!rule.id.empty()) return false;
+      rule.id = part;
+    } else {
+      if (end != std::string_view::npos) return false;  // the state comes last
+      const auto state = std::find(stateName.begin(), stateName.end(), part);
+      if (state == stateName.end()) return false;
+      rule.state = static_cast<int>(state - stateName.begin());
+    }
+  }
+  if (!rule.id.empty())
+    rule.specificity = SPECIFICITY_ID;
+  else if (!rule.styleClass.empty())
+    rule.specificity = SPECIFICITY_CLASS;
+  else
+    rule.specificity = SPECIFICITY_TAG;
+  return true;
+}
+
+void StyleRules::setRules(std::vector<StyleRule> newRules) {
+  rules = std::move(newRules);
+  resolved.clear();
+  ++generation;
+}
+
+// checks whether a class is in a space separated list of classes
+static bool hasClass(std::string_view classes, std::string_view styleClass) {
+  while (!classes.empty()) {
+    const size_t end = classes.find(' ');
+    if (classes.substr(0, end) == styleClass) return true;
+    if (end == std::string_view::npos) break;
+    classes.remove_prefix(end + 1);
+  }
+  return false;
+}
+
+const StyleSheet* StyleRules::resolve(std::string_view tag, std::string_view styleClass, std::string_view id) {
+  std::string key{tag};
+  key.append(1, '\n').append(styleClass).append(1, '\n').append(id);
+  auto found = resolved.find(key);
+  if (found != resolved.end()) return found->second.get();
+  auto style = std::make_unique<StyleSheet>();
+  for (const StyleRule& rule : rules) {
+    if (!rule.tag.empty() && rule.tag != tag) continue;
+    if (!rule.styleClass.empty() && !hasClass(styleClass, rule.styleClass)) continue;
+    if (!rule.id.empty() && rule.id != id) continue;
+    for (int state = STYLE_NORMAL; state < STYLE_STATE_COUNT; ++state) {
+      if (rule.state >= 0 && rule.state != state) continue;
+      StyleSheetSet& set = style->get(static_cast<StyleState>(state));
+      for (int property = 0; property < STYLE_PROPERTY_COUNT; ++property) {
+        if (rule.properties & (1u << property)) {
+          set.apply(static_cast<StyleProperty>(property), rule.values[property], rule.specificity);
+        }
+      }
+    }
+  }
+  return resolved.emplace(std::move(key), std::move(style)).first->second.get();
+}
+}  // namespace widget
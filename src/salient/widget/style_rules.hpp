@@ -0,0 +1,122 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "widget/stylesheet.hpp"
+
+namespace widget {
+/**
+ * A style sheet rule, compiled from a style sheet file. The selector has the form
+ * <code>tag.class#id:state</code>, where every part is optional: <code>button</code>, <code>.menu</code>,
+ * <code>button.menu:hover</code> and <code>#quit:active</code> are all valid. A rule without a state applies to all
+ * three of them.
+ */
+struct StyleRule {
+  std::string tag{};  // widget type, empty for any
+  std::string styleClass{};  // widget class, empty for any
+  std::string id{};  // widget ID, empty for any
+  int state{-1};  // a StyleState, or -1 for all of them
+  StyleSheetSpecificity specificity{SPECIFICITY_TAG};  // taken from the most specific part of the selector
+  uint32_t properties{0};  // bit mask of the StyleProperty values the rule sets
+  TCODColor values[STYLE_PROPERTY_COUNT]{};
+};
+
+/**
+ * The compiled rules of a style sheet, and the styles resolved from them. A style sheet file is parsed once into a rule
+ * table sorted by precedence; a widget's style is then resolved once per combination of tag, class and ID and cached,
+ * so that widgets only look it up again when their class or ID changes or when the rules are replaced.
+ *
+ * The file uses the libtcod parser syntax, with one <code>style</code> structure per rule:
+ * <pre>
+ * style "button:hover" {
+ *   backgroundColour = "128,0,0"
+ *   borderColour = "#8080ff"
+ * }
+ * </pre>
+ */
+class StyleRules {
+ public:
+  StyleRules() = default;
+  StyleRules(const StyleRules&) = delete;
+  StyleRules& operator=(const StyleRules&) = delete;
+  /**
+   * Parses and compiles a style sheet file. It touches no engine state, so it can run on the file watcher thread.
+   * @param path the style sheet file
+   * @param rules the vector to be filled with the compiled rules
+   * @param error the error message, set if parsing failed
+   * @return <code>true</code> if the file has been compiled, <code>false</code> otherwise
+   */
+  static bool compile(const std::filesystem::path& path, std::vector<StyleRule>& rules, std::string& error);
+  /**
+   * Parses a selector into a rule.
+   * @param selector the selector, e.g. <code>button.menu:hover</code>
+   * @param rule the rule whose selector fields are to be filled
+   * @return <code>true</code> if the selector is valid, <code>false</code> otherwise
+   */
+  static bool parseSelector(std::string_view selector, StyleRule& rule);
+  /**
+   * Replaces the rules. Every resolved style is dropped and the generation is incremented, so that the widgets resolve
+   * their style again on their next frame.
+   * @param rules the compiled rules
+   */
+  void setRules(std::vector<StyleRule> rules);
+  const std::vector<StyleRule>& getRules() const { return rules; }
+  /**
+   * Fetches the style resolved for a widget, resolving it if it is not cached yet. The pointer stays valid until the
+   * rules are replaced.
+   * @param tag the widget's type
+   * @param styleClass the widget's classes, separated with spaces
+   * @param id the widget's ID
+   * @return pointer to the resolved style
+   */
+  const StyleSheet* resolve(std::string_view tag, std::string_view styleClass, std::string_view id);
+  /**
+   * Fetches the generation of the rules, incremented whenever they are replaced. Resolved style pointers obtained under
+   * a previous generation are no longer valid.
+   * @return the generation
+   */
+  uint32_t getGeneration() const { return generation; }
+
+ private:
+  std::vector<StyleRule> rules{};  // sorted by specificity, then state, then order in the file
+  std::unordered_map<std::string, std::unique_ptr<StyleSheet>> resolved{};  // keyed by tag, class and ID
+  uint32_t generation{1};
+};
+}  // namespace widget
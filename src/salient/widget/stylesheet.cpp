@@ -42,13 +42,41 @@ StyleSheetSet::StyleSheetSet() {
   borderColour.set(TCODColor::blue);
 }
 
+void StyleSheetSet::apply(StyleProperty property, const TCODColor& value, StyleSheetSpecificity specificity) {
+  switch (property) {
+    case STYLE_COLOUR:
+      colour.set(value, specificity);
+      break;
+    case STYLE_BACKGROUND_COLOUR:
+      backgroundColour.set(value, specificity);
+      break;
+    case STYLE_BORDER_COLOUR:
+      borderColour.set(value, specificity);
+      break;
+    default:
+      break;
+  }
+}
+
+void StyleSheetSet::inherit(const StyleSheetSet& resolved) {
+  colour.inherit(resolved.colour);
+  backgroundColour.inherit(resolved.backgroundColour);
+  borderColour.inherit(resolved.borderColour);
+}
+
 StyleSheet::StyleSheet() {
-  // placeholder --- hardcoded values
-  active.colour(TCODColor::yellow);
-  hover.backgroundColour(TCODColor::darkRed);
-  active.backgroundColour(TCODColor::red);
-  hover.borderColour(TCODColor::lightBlue);
-  active.borderColour(TCODColor::lighterBlue);
+  // defaults, overridden by the style rules
+  active.apply(STYLE_COLOUR, TCODColor::yellow, SPECIFICITY_DEFAULT);
+  hover.apply(STYLE_BACKGROUND_COLOUR, TCODColor::darkRed, SPECIFICITY_DEFAULT);
+  active.apply(STYLE_BACKGROUND_COLOUR, TCODColor::red, SPECIFICITY_DEFAULT);
+  hover.apply(STYLE_BORDER_COLOUR, TCODColor::lightBlue, SPECIFICITY_DEFAULT);
+  active.apply(STYLE_BORDER_COLOUR, TCODColor::lighterBlue, SPECIFICITY_DEFAULT);
+}
+
+void StyleSheet::inherit(const StyleSheet& resolved) {
+  normal.inherit(resolved.normal);
+  hover.inherit(resolved.hover);
+  active.inherit(resolved.active);
 }
 
 StyleSheet& StyleSheet::colour(TCODColor val) {
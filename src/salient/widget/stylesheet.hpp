@@ -64,6 +64,16 @@ enum StyleSheetSpecificity {
   SPECIFICITY_MANUAL
 };
 
+/**
+ * The properties held by a style sheet set. Used by the style rules to address them.
+ */
+enum StyleProperty { STYLE_COLOUR, STYLE_BACKGROUND_COLOUR, STYLE_BORDER_COLOUR, STYLE_PROPERTY_COUNT };
+
+/**
+ * The mouse interaction states a style sheet holds a set for.
+ */
+enum StyleState { STYLE_NORMAL, STYLE_HOVER, STYLE_ACTIVE, STYLE_STATE_COUNT };
+
 class StyleSheetSet;  // forward declaration
 
 /**
@@ -81,7 +91,7 @@ class StyleSheetProperty {
   /**
    * The level at which the property has been set (tag, class, ID or manual). Used to determine the precedence.
    */
-  StyleSheetSpecificity specificity;
+  StyleSheetSpecificity specificity{SPECIFICITY_DEFAULT};
 
  public:
   /**
@@ -114,12 +124,17 @@ class StyleSheetProperty {
    * @return the property's value
    */
   inline T& operator()() { return val; }
+  /**
+   * Fetches the level at which the property has been set.
+   * @return the property's specificity
+   */
+  inline StyleSheetSpecificity getSpecificity() const { return specificity; }
 
  private:
   /**
-   * Sets the property's value and specificity. If
+   * Sets the property's value and specificity, unless the property has already been set at a higher level.
    * @param x the property's value
-   * @param l the property's specificity
+   * @param s the property's specificity
    * @return the property object reference
    */
   inline StyleSheetProperty& set(const T& x, StyleSheetSpecificity s = SPECIFICITY_DEFAULT) {
@@ -129,6 +144,15 @@ class StyleSheetProperty {
     }
     return *this;
   }
+  /**
+   * Takes the value and specificity of a resolved property, unless this one has been set manually.
+   * @param resolved the property as resolved from the style rules
+   */
+  inline void inherit(const StyleSheetProperty& resolved) {
+    if (specificity == SPECIFICITY_MANUAL) return;
+    val = resolved.val;
+    specificity = resolved.specificity;
+  }
 };
 
 /**
@@ -152,15 +176,25 @@ class StyleSheetSet {
    * Widget's border colour.
    */
   StyleSheetProperty<TCODColor> borderColour;
+  /**
+   * Sets a property at the given specificity level, unless it has already been set at a higher one. Used when
+   * resolving the style rules.
+   * @param property the property to be set
+   * @param value the property's value
+   * @param specificity the level of the rule the value comes from
+   */
+  void apply(StyleProperty property, const TCODColor& value, StyleSheetSpecificity specificity);
+  /**
+   * Takes the values of a resolved set for every property that has not been set manually.
+   * @param resolved the set resolved from the style rules
+   */
+  void inherit(const StyleSheetSet& resolved);
 };
 
 /**
  * The style sheet class. It stores the information about a widget's appearance.
  */
 class StyleSheet {
- private:
-  static TCODParser parser;
-
  public:  // style sheets
   /**
    * Default style sheet for the widget.
@@ -195,6 +229,24 @@ class StyleSheet {
    */
   StyleSheet& borderColour(TCODColor val);
 
+ public:
+  /**
+   * Fetches the set used in a given mouse interaction state.
+   * @param state the mouse interaction state
+   * @return reference to the style sheet set
+   */
+  StyleSheetSet& get(StyleState state) {
+    return state == STYLE_ACTIVE ? active : state == STYLE_HOVER ? hover : normal;
+  }
+  const StyleSheetSet& get(StyleState state) const {
+    return state == STYLE_ACTIVE ? active : state == STYLE_HOVER ? hover : normal;
+  }
+  /**
+   * Takes the values of a resolved style sheet for every property that has not been set manually.
+   * @param resolved the style sheet resolved from the style rules
+   */
+  void inherit(const StyleSheet& resolved);
+
  public:  // ctor
   /**
    * The constructor for the style sheet class. Fills all styles with default values.
@@ -0,0 +1,157 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "widget/table_view.hpp"
+
+#include <stdlib.h>
+
+#include "render/print.hpp"
+
+namespace widget {
+// reads a cell holding nothing but a number, NaN excluded as it can't be ordered
+static bool parseNumber(const std::string& text, double& number) {
+  if (text.empty()) return false;
+  char* end = nullptr;
+  number = strtod(text.c_str(), &end);
+  return *end == '\0' && number == number;
+}
+
+// compares two cells: numbers come first, in numeric order, then text in lexical order
+static int compareCells(const std::string& a, const std::string& b) {
+  double numberA = 0.0;
+  double numberB = 0.0;
+  const bool isNumberA = parseNumber(a, numberA);
+  const bool isNumberB = parseNumber(b, numberB);
+  if (isNumberA != isNumberB) return isNumberA ? -1 : 1;
+  if (isNumberA) return numberA < numberB ? -1 : numberB < numberA ? 1 : 0;
+  return a.compare(b);
+}
+
+void TableView::setColumns(std::vector<TableColumn> newColumns) {
+  columns = std::move(newColumns);
+  cells.clear();
+  sortColumn = -1;
+  setCompare({});
+  resetRows(0);
+}
+
+uint32_t TableView::addRow(std::initializer_list<std::string_view> rowCells) {
+  const auto row = static_cast<uint32_t>(size());
+  auto cell = rowCells.begin();
+  for (size_t column = 0; column < columns.size(); ++column) {
+    cells.push_back(cell != rowCells.end() ? std::string{*cell++} : std::string{});
+  }
+  insertRow(row);
+  return row;
+}
+
+void TableView::setCell(uint32_t row, size_t column, std::string_view text) {
+  detachRow(row);
+  cells[row * columns.size() + column] = text;
+  insertRow(row);
+}
+
+void TableView::removeRow(uint32_t row) {
+  const auto last = static_cast<uint32_t>(size() - 1);
+  const size_t width = columns.size();
+  detachRow(row);
+  if (row != last) detachRow(last);
+  for (size_t column = width; column-- > 0;) {
+    if (row != last) cells[row * width + column] = std::move(cells[last * width + column]);
+    cells.pop_back();
+  }
+  eraseRow(row, last);
+}
+
+void TableView::clear() {
+  cells.clear();
+  resetRows(0);
+}
+
+void TableView::sortBy(int column, bool ascending) {
+  sortColumn = column >= 0 && column < static_cast<int>(columns.size()) ? column : -1;
+  sortAscending = ascending;
+  if (sortColumn < 0) {
+    setCompare({});
+    return;
+  }
+  setCompare([this, index = static_cast<size_t>(sortColumn), ascending](uint32_t a, uint32_t b) {
+    const int result = compareCells(getCell(a, index), getCell(b, index));
+    return ascending ? result < 0 : result > 0;
+  });
+}
+
+int TableView::columnWidth(size_t column, int x) const {
+  const int width = columns[column].width;
+  return width > 0 ? width : std::max(0, rect.w - x);
+}
+
+void TableView::drawHeader(TCODConsole& console) {
+  console.setDefaultForeground(style.normal.colour());
+  console.setDefaultBackground(style.normal.borderColour());
+  console.rect(0, 0, console.getWidth(), 1, true, TCOD_BKGND_SET);
+  int x = 0;
+  for (size_t column = 0; column < columns.size(); ++column) {
+    const int width = columnWidth(column, x);
+    console.rect(x, 0, width + 1, 1, true, TCOD_BKGND_SET);
+    const int length = render::printText(console, x, 0, columns[column].title);
+    if (static_cast<int>(column) == sortColumn && length < width) {
+      render::printText(console, x + length + 1, 0, sortAscending ? "▲" : "▼");
+    }
+    x += width + 1;
+  }
+  console.setDefaultBackground(style.normal.backgroundColour());
+}
+
+void TableView::onHeaderClick(int x, int) {
+  int left = 0;
+  for (size_t column = 0; column < columns.size(); ++column) {
+    const int width = columnWidth(column, left);
+    if (x >= left && x < left + width) {
+      const int clicked = static_cast<int>(column);
+      sortBy(clicked, clicked == sortColumn ? !sortAscending : true);
+      return;
+    }
+    left += width + 1;
+  }
+}
+
+void TableView::drawRow(TCODConsole& console, uint32_t row, int y, bool) {
+  int x = 0;
+  for (size_t column = 0; column < columns.size(); ++column) {
+    // clear the column, and the separator after it, of whatever the previous cell overflowed with
+    const int width = columnWidth(column, x);
+    console.rect(x, y, width + 1, 1, true, TCOD_BKGND_NONE);
+    render::printText(console, x, y, getCell(row, column));
+    x += width + 1;
+  }
+}
+}  // namespace widget
@@ -0,0 +1,122 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#include <libtcod/libtcod.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "base/chunked_vector.hpp"
+#include "widget/virtual_view.hpp"
+
+namespace widget {
+/**
+ * A column of a table view.
+ */
+struct TableColumn {
+  std::string title{};
+  int width{0};  // width in cells, 0 or less for the rest of the table's width
+};
+
+/**
+ * A scrolling table with a title line, sorted by clicking on the column titles. Only the visible rows are drawn; the
+ * cells are stored row after row, in chunks.
+ */
+class TableView : public VirtualView {
+ public:
+  /**
+   * Sets the columns. All the rows are removed.
+   * @param columns the columns
+   */
+  void setColumns(std::vector<TableColumn> columns);
+  const std::vector<TableColumn>& getColumns() const { return columns; }
+  /**
+   * Appends a row. Missing cells are left empty, extra ones are ignored.
+   * @param cells the cells' texts
+   * @return the row's index
+   */
+  uint32_t addRow(std::initializer_list<std::string_view> cells);
+  /**
+   * Changes a cell. The row is moved to its new place if the table is sorted.
+   * @param row the row's index
+   * @param column the column's index
+   * @param text the cell's text
+   */
+  void setCell(uint32_t row, size_t column, std::string_view text);
+  const std::string& getCell(uint32_t row, size_t column) const { return cells[row * columns.size() + column]; }
+  /**
+   * Removes a row. The last row takes its index.
+   * @param row the row's index
+   */
+  void removeRow(uint32_t row);
+  /**
+   * Removes all the rows.
+   */
+  void clear();
+  size_t size() const { return columns.empty() ? 0 : cells.size() / columns.size(); }
+  /**
+   * Sorts the rows by a column. Cells holding numbers come first, in numeric order, then the others in lexical order.
+   * @param column the column's index, or -1 to restore the insertion order
+   * @param ascending <code>true</code> for the ascending order, <code>false</code> for the descending one
+   */
+  void sortBy(int column, bool ascending = true);
+  int getSortColumn() const { return sortColumn; }
+  bool isSortAscending() const { return sortAscending; }
+  const char* getStyleTag() const override { return "table"; }
+
+ protected:
+  int getHeaderHeight() const override { return 1; }
+  void drawHeader(TCODConsole& console) override;
+  /**
+   * Sorts the rows by the clicked column, in reverse order if it was already the sort column.
+   */
+  void onHeaderClick(int x, int y) override;
+  void drawRow(TCODConsole& console, uint32_t row, int y, bool selected) override;
+
+ private:
+  /**
+   * Gets the width of a column, as drawn.
+   * @param column the column's index
+   * @param x the column's left side
+   * @return the width in cells
+   */
+  int columnWidth(size_t column, int x) const;
+
+  std::vector<TableColumn> columns{};
+  base::ChunkedVector<std::string> cells{};  // row after row
+  int sortColumn{-1};
+  bool sortAscending{true};
+};
+}  // namespace widget
@@ -0,0 +1,164 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "widget/virtual_view.hpp"
+
+#include <algorithm>
+
+namespace widget {
+static constexpr int WHEEL_ROWS = 3;  // rows scrolled per mouse wheel notch
+
+void VirtualView::setFilter(Filter newFilter) {
+  filter = std::move(newFilter);
+  resetRows(rowCount);
+}
+
+void VirtualView::setCompare(Compare newCompare) {
+  compare = std::move(newCompare);
+  std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return before(a, b); });
+  ++contentVersion;
+}
+
+bool VirtualView::scrollTo(uint32_t row) {
+  const size_t position = lowerBound(row);
+  if (position == order.size() || order[position] != row) return false;
+  const int page = getPageHeight();
+  if (static_cast<int>(position) < scroll)
+    setScroll(static_cast<int>(position));
+  else if (static_cast<int>(position) >= scroll + page)
+    setScroll(static_cast<int>(position) - page + 1);
+  return true;
+}
+
+void VirtualView::setScroll(int position) {
+  scroll = std::clamp(position, 0, std::max(0, static_cast<int>(order.size()) - getPageHeight()));
+}
+
+void VirtualView::setSelected(int64_t row) { selected = row; }
+
+void VirtualView::onEvent(const SDL_Event& ev) {
+  Widget::onEvent(ev);
+  if (ev.type == SDL_MOUSEWHEEL) {
+    if (rect.mouseHover) scrollBy(-ev.wheel.y * WHEEL_ROWS);
+  } else if (ev.type == SDL_MOUSEBUTTONDOWN && ev.button.button == SDL_BUTTON_LEFT && rect.mouseDown) {
+    TCOD_mouse_t tcod_mouse{};
+    tcod::sdl2::process_event(ev, tcod_mouse);
+    const base::Point position = getScreenPosition();
+    const int x = tcod_mouse.cx - position.x;
+    const int y = tcod_mouse.cy - position.y;
+    if (y < getHeaderHeight()) {
+      onHeaderClick(x, y);
+    } else {
+      const size_t line = static_cast<size_t>(scroll + y - getHeaderHeight());
+      if (line < order.size()) setSelected(order[line]);
+    }
+  }
+}
+
+void VirtualView::hashState(RenderState& state) { state.add(scroll - scrollShift).add(selected).add(contentVersion); }
+
+void VirtualView::insertRow(uint32_t row) {
+  rowCount = std::max(rowCount, row + 1);
+  if (filter && !filter(row)) return;
+  const size_t position = lowerBound(row);
+  order.insert(order.begin() + position, row);
+  // keep the view still when the row goes above it
+  if (static_cast<int>(position) < scroll) {
+    ++scroll;
+    ++scrollShift;
+  } else
+    touch(position);
+}
+
+void VirtualView::detachRow(uint32_t row) {
+  const size_t position = lowerBound(row);
+  if (position < order.size() && order[position] == row) erasePosition(position);
+}
+
+void VirtualView::eraseRow(uint32_t row, uint32_t last) {
+  rowCount = last;
+  if (selected == row) selected = -1;
+  if (row == last) return;
+  // the last row moved into the erased one's place: its index changed, and with it its place among equal rows
+  insertRow(row);
+  if (selected == last) selected = row;
+}
+
+void VirtualView::resetRows(uint32_t count) {
+  rowCount = count;
+  order.clear();
+  for (uint32_t row = 0; row < count; ++row) {
+    if (!filter || filter(row)) order.push_back(row);
+  }
+  if (compare) std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return before(a, b); });
+  setScroll(scroll);
+  ++contentVersion;
+}
+
+void VirtualView::touch(size_t position) {
+  if (static_cast<int>(position) < scroll + getPageHeight()) ++contentVersion;
+}
+
+void VirtualView::renderSurface(TCODConsole& console) {
+  console.setDefaultForeground(style.normal.colour());
+  console.setDefaultBackground(style.normal.backgroundColour());
+  console.clear();
+  drawHeader(console);
+  const int header = getHeaderHeight();
+  const int page = getPageHeight();
+  const int first = std::min(scroll, std::max(0, static_cast<int>(order.size()) - page));
+  for (int line = 0; line < page && first + line < static_cast<int>(order.size()); ++line) {
+    const uint32_t row = order[first + line];
+    const bool isSelected = row == selected;
+    StyleSheetSet& set = isSelected ? style.active : style.normal;
+    console.setDefaultForeground(set.colour());
+    console.setDefaultBackground(set.backgroundColour());
+    if (isSelected) console.rect(0, header + line, console.getWidth(), 1, true, TCOD_BKGND_SET);
+    drawRow(console, row, header + line, isSelected);
+  }
+}
+
+size_t VirtualView::lowerBound(uint32_t row) const {
+  const auto found =
+      std::lower_bound(order.begin(), order.end(), row, [this](uint32_t a, uint32_t b) { return before(a, b); });
+  return static_cast<size_t>(found - order.begin());
+}
+
+void VirtualView::erasePosition(size_t position) {
+  order.erase(order.begin() + position);
+  if (static_cast<int>(position) < scroll) {
+    --scroll;
+    --scrollShift;
+  } else
+    touch(position);
+  setScroll(scroll);
+}
+}  // namespace widget
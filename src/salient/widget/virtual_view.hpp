@@ -0,0 +1,197 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <SDL_events.h>
+
+#include <cstddef>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <libtcod/libtcod.hpp>
+#include <vector>
+
+#include "widget/widget.hpp"
+
+namespace widget {
+/**
+ * Base class of the widgets showing a large number of one cell high rows, of which only the visible ones are drawn.
+ * Rows are identified by their index in the subclass's storage. The view keeps the indices of the rows passing the
+ * filter, in sorted order; a row's position is found with a binary search, so adding, changing or removing a row only
+ * costs a logarithmic number of comparisons plus moving the indices after it, and the surface is only drawn again when
+ * a visible row changed. Rows inserted above the visible ones shift the scroll position along, so that the view doesn't
+ * move.
+ */
+class VirtualView : public Widget {
+ public:
+  /**
+   * Tells whether a row is shown.
+   */
+  using Filter = std::function<bool(uint32_t row)>;
+  /**
+   * Tells whether a row goes before another one. Must be a strict weak ordering; rows comparing equal keep the order of
+   * their indices.
+   */
+  using Compare = std::function<bool(uint32_t a, uint32_t b)>;
+
+  /**
+   * Sets the filter, or removes it if empty. All the rows are filtered again.
+   * @param filter the filter
+   */
+  void setFilter(Filter filter);
+  /**
+   * Sets the sort order, or restores the storage order if empty. The shown rows are sorted again.
+   * @param compare the comparison function
+   */
+  void setCompare(Compare compare);
+  /**
+   * Gets the number of rows passing the filter.
+   * @return the number of shown rows
+   */
+  size_t getShownCount() const { return order.size(); }
+  /**
+   * Gets the row shown at a position.
+   * @param position the position, 0 being the first shown row
+   * @return the row's index
+   */
+  uint32_t getShownRow(size_t position) const { return order[position]; }
+  /**
+   * Scrolls just enough for a row to be visible. The row is found with a binary search.
+   * @param row the row's index
+   * @return <code>true</code> if the row is shown, <code>false</code> if it has been filtered out
+   */
+  bool scrollTo(uint32_t row);
+  /**
+   * Sets the position of the first visible row. It is clamped so that the view stays filled.
+   * @param position the position of the first visible row
+   */
+  void setScroll(int position);
+  void scrollBy(int rows) { setScroll(scroll + rows); }
+  int getScroll() const { return scroll; }
+  /**
+   * Selects a row.
+   * @param row the row's index, or -1 for none
+   */
+  void setSelected(int64_t row);
+  int64_t getSelected() const { return selected; }
+  /**
+   * Gets the number of rows that fit in the view.
+   * @return the number of visible rows
+   */
+  int getPageHeight() const { return std::max(0, rect.h - getHeaderHeight()); }
+  /**
+   * Scrolls with the mouse wheel and selects rows with a click, then passes the event on to the children.
+   */
+  void onEvent(const SDL_Event& ev) override;
+  void render() override { renderCached(); }
+  void hashState(RenderState& state) override;
+
+ protected:
+  /**
+   * Adds a row to the shown rows, if it passes the filter. Called by subclasses after storing a row.
+   * @param row the row's index
+   */
+  void insertRow(uint32_t row);
+  /**
+   * Takes a row out of the shown rows. It is found with a binary search, so this must be called while the row still
+   * holds the contents it was sorted by: subclasses changing a row detach it, change it, then insert it again.
+   * @param row the row's index
+   */
+  void detachRow(uint32_t row);
+  /**
+   * Finishes removing a row. Subclasses remove rows by moving the last one into their place: they detach both rows
+   * first, move the storage, then call this, which shows the moved row again under its new index.
+   * @param row the row's index
+   * @param last the highest row index, before the removal
+   */
+  void eraseRow(uint32_t row, uint32_t last);
+  /**
+   * Rebuilds the shown rows from scratch.
+   * @param count the number of rows in the storage
+   */
+  void resetRows(uint32_t count);
+  /**
+   * Draws a row.
+   * @param console the widget's surface
+   * @param row the row's index
+   * @param y the line the row goes on
+   * @param selected whether the row is selected
+   */
+  virtual void drawRow(TCODConsole& console, uint32_t row, int y, bool selected) = 0;
+  /**
+   * Gets the number of lines above the rows, for column titles for instance.
+   * @return the header's height
+   */
+  virtual int getHeaderHeight() const { return 0; }
+  /**
+   * Draws the lines above the rows.
+   */
+  virtual void drawHeader(TCODConsole&) {}
+  /**
+   * Reacts to a click on the header.
+   * @param x the clicked column, in the widget's coordinates
+   * @param y the clicked line, in the widget's coordinates
+   */
+  virtual void onHeaderClick(int, int) {}
+  /**
+   * Marks the surface as out of date if a position is visible.
+   * @param position the position of a shown row
+   */
+  void touch(size_t position);
+  void renderSurface(TCODConsole& console) override;
+
+ private:
+  /**
+   * Finds the position a row goes at, with a binary search.
+   * @param row the row's index
+   * @return the position of the first shown row not going before the row
+   */
+  size_t lowerBound(uint32_t row) const;
+  /**
+   * Tells whether a row goes before another one, the indices breaking ties.
+   */
+  bool before(uint32_t a, uint32_t b) const { return compare ? compare(a, b) || (!compare(b, a) && a < b) : a < b; }
+  /**
+   * Removes the row at a position.
+   */
+  void erasePosition(size_t position);
+
+  std::vector<uint32_t> order{};  // the shown rows
+  Filter filter{};
+  Compare compare{};
+  int scroll{0};  // position of the first visible row
+  int64_t scrollShift{0};  // scrolling done to keep the view still: scroll - scrollShift identifies the view
+  int64_t selected{-1};
+  uint32_t rowCount{0};  // number of rows in the subclass's storage
+  uint32_t contentVersion{0};  // incremented whenever a visible row changes
+};
+}  // namespace widget
@@ -31,17 +31,25 @@
  */
 #include "widget/widget.hpp"
 
+#include <algorithm>
 #include <libtcod.hpp>
+#include <vector>
 
 #include "engine/engine.hpp"
 #include "widget/stylesheet.hpp"
 
 namespace widget {
+Widget::~Widget() {
+  setParent(nullptr);
+  for (Widget* child : children) child->parent = nullptr;
+}
+
 void Widget::onEvent(const SDL_Event& ev) {
   TCOD_mouse_t tcod_mouse{};
   tcod::sdl2::process_event(ev, tcod_mouse);
-  const int mouse_x = tcod_mouse.cx - (parent ? parent->rect.x : 0);
-  const int mouse_y = tcod_mouse.cy - (parent ? parent->rect.y : 0);
+  const base::Point origin = parent ? parent->getScreenPosition() : base::Point{};
+  const int mouse_x = tcod_mouse.cx - origin.x;
+  const int mouse_y = tcod_mouse.cy - origin.y;
   const int local_x = mouse_x - rect.x;
   const int local_y = mouse_y - rect.y;
   switch (ev.type) {
@@ -85,10 +93,218 @@ void Widget::onEvent(const SDL_Event& ev) {
     default:
       break;
   }
+  // by index: a handler may add or remove children
+  for (size_t i = 0; i < children.size(); ++i) children[i]->onEvent(ev);
+}
+
+void Widget::onResize(int width, int height) {
+  if (parent) return;  // positioned relative to its parent
+  rect.x = std::clamp(rect.x, 0, std::max(0, width - rect.w));
+  rect.y = std::clamp(rect.y, 0, std::max(0, height - rect.h));
+}
+
+void Widget::setStyleClass(std::string_view newClass) {
+  if (styleClass == newClass) return;
+  styleClass = newClass;
+  resolvedStyle = nullptr;
+}
+
+void Widget::setStyleId(std::string_view id) {
+  if (styleId == id) return;
+  styleId = id;
+  resolvedStyle = nullptr;
+}
+
+void Widget::refreshStyle() {
+  StyleRules& rules = getEngine()->getStyleRules();
+  if (resolvedStyle && styleGeneration == rules.getGeneration()) return;
+  resolvedStyle = rules.resolve(getStyleTag(), styleClass, styleId);
+  styleGeneration = rules.getGeneration();
+  style.inherit(*resolvedStyle);
+}
+
+void Widget::renderCached(float foregroundAlpha, float backgroundAlpha) {
+  updateLayout();
+  if (rect.w <= 0 || rect.h <= 0) return;
+  refreshStyle();
+  RenderState state{};
+  state.add(rect).add(dragZone).add(minimiseButton).add(closeButton).add(isDragging).add(style);
+  state.add(layoutGeneration);
+  for (Widget* child : children) child->hashState(state);
+  hashState(state);
+  if (!surface || surface->getWidth() != rect.w || surface->getHeight() != rect.h) {
+    surface = std::make_unique<TCODConsole>(rect.w, rect.h);
+    surfaceState = 0;
+  }
+  if (state.value() != surfaceState) {
+    renderSurface(*surface);
+    surfaceState = state.value();
+  }
+  const base::Point position = getScreenPosition();
+  TCODConsole::blit(
+      surface.get(), 0, 0, rect.w, rect.h, TCODConsole::root, position.x, position.y, foregroundAlpha, backgroundAlpha);
 }
 
 void Widget::setDragZone(int x, int y, int w, int h) {
   dragZone.set(x, y, w, h);
   if (w > 0 && h > 0) canDrag = true;
 }
+
+void Widget::setParent(Widget* newParent) {
+  if (newParent == parent) return;
+  if (parent) {
+    auto& siblings = parent->children;
+    siblings.erase(std::remove(siblings.begin(), siblings.end(), this), siblings.end());
+    parent->markLayoutDirty();
+  }
+  parent = newParent;
+  if (parent) {
+    parent->children.push_back(this);
+    parent->markLayoutDirty();
+  }
+  resolvedStyle = nullptr;
+}
+
+base::Point Widget::getScreenPosition() const {
+  base::Point position{rect.x, rect.y};
+  for (const Widget* ancestor = parent; ancestor; ancestor = ancestor->parent) {
+    position.x += ancestor->rect.x;
+    position.y += ancestor->rect.y;
+  }
+  return position;
+}
+
+void Widget::setLayout(const Layout& newLayout) {
+  layout = newLayout;
+  markLayoutDirty();
+}
+
+void Widget::setConstraints(const LayoutConstraints& newConstraints) {
+  constraints = newConstraints;
+  markLayoutDirty();
+}
+
+void Widget::markLayoutDirty() {
+  // a dirty widget's ancestors are always dirty as well: stop at the first one
+  for (Widget* widget = this; widget && !(widget->measureDirty && widget->arrangeDirty); widget = widget->parent) {
+    widget->measureDirty = true;
+    widget->arrangeDirty = true;
+  }
+}
+
+void Widget::updateLayout() {
+  if (parent) return;  // laid out by its parent
+  if (!arrangeDirty && rect.w == arrangedSize.x && rect.h == arrangedSize.y) return;
+  const base::Point size = measure();
+  arrange(base::Rect{rect.x, rect.y, rect.w > 0 ? rect.w : size.x, rect.h > 0 ? rect.h : size.y});
+}
+
+base::Point Widget::measure() {
+  if (!measureDirty) return measuredSize;
+  base::Point content{};
+  if (layout.mode == LAYOUT_NONE || children.empty()) {
+    content = measureContent();
+  } else {
+    for (Widget* child : children) {
+      const base::Point size = child->measure();
+      if (layout.mode == LAYOUT_ROW) {
+        content.x += size.x;
+        content.y = std::max(content.y, size.y);
+      } else if (layout.mode == LAYOUT_COLUMN) {
+        content.x = std::max(content.x, size.x);
+        content.y += size.y;
+      } else {
+        content.x = std::max(content.x, size.x);
+        content.y = std::max(content.y, size.y);
+      }
+    }
+    const int gaps = layout.gap * (static_cast<int>(children.size()) - 1);
+    if (layout.mode == LAYOUT_ROW) content.x += gaps;
+    if (layout.mode == LAYOUT_COLUMN) content.y += gaps;
+    content.x += 2 * layout.padding;
+    content.y += 2 * layout.padding;
+  }
+  measuredSize.x = std::max(constraints.width >= 0 ? constraints.width : content.x, constraints.minWidth);
+  measuredSize.y = std::max(constraints.height >= 0 ? constraints.height : content.y, constraints.minHeight);
+  measureDirty = false;
+  return measuredSize;
+}
+
+// offset of an item of a given size within a space, depending on the alignment
+static int alignOffset(LayoutAlign align, int space, int size) {
+  if (align == ALIGN_CENTER) return (space - size) / 2;
+  if (align == ALIGN_END) return space - size;
+  return 0;
+}
+
+void Widget::arrange(const base::Rect& area) {
+  const bool resized = area.w != arrangedSize.x || area.h != arrangedSize.y;
+  rect.set(area.x, area.y, area.w, area.h);
+  if (!resized && !arrangeDirty) return;
+  arrangeDirty = false;
+  arrangedSize = base::Point{area.w, area.h};
+  if (children.empty()) return;
+  // the child areas, in the widget's coordinates
+  std::vector<base::Rect> areas(children.size());
+  if (layout.mode == LAYOUT_NONE) {
+    for (size_t i = 0; i < children.size(); ++i) areas[i] = children[i]->rect;
+  } else {
+    const base::Rect inner{
+        layout.padding,
+        layout.padding,
+        std::max(0, area.w - 2 * layout.padding),
+        std::max(0, area.h - 2 * layout.padding)};
+    if (layout.mode == LAYOUT_STACK) {
+      for (size_t i = 0; i < children.size(); ++i) {
+        const base::Point size = children[i]->measure();
+        const int w = layout.align == ALIGN_STRETCH ? inner.w : std::min(size.x, inner.w);
+        const int h = layout.align == ALIGN_STRETCH ? inner.h : std::min(size.y, inner.h);
+        areas[i].set(
+            inner.x + alignOffset(layout.align, inner.w, w), inner.y + alignOffset(layout.align, inner.h, h), w, h);
+      }
+    } else {
+      const bool row = layout.mode == LAYOUT_ROW;
+      const int mainSpace = row ? inner.w : inner.h;
+      const int crossSpace = row ? inner.h : inner.w;
+      int used = layout.gap * (static_cast<int>(children.size()) - 1);
+      int totalGrow = 0;
+      for (Widget* child : children) {
+        const base::Point size = child->measure();
+        used += row ? size.x : size.y;
+        totalGrow += std::max(0, child->constraints.grow);
+      }
+      const int free = std::max(0, mainSpace - used);
+      int position = totalGrow > 0 ? 0 : alignOffset(layout.justify, free, 0);
+      int remaining = totalGrow > 0 ? free : 0;  // given to the growing children, the rounding going to the last one
+      int remainingGrow = totalGrow;
+      for (size_t i = 0; i < children.size(); ++i) {
+        Widget* child = children[i];
+        const base::Point size = child->measure();
+        int main = row ? size.x : size.y;
+        const int grow = std::max(0, child->constraints.grow);
+        if (grow > 0) {
+          const int extra = grow == remainingGrow ? remaining : free * grow / totalGrow;
+          main += extra;
+          remaining -= extra;
+          remainingGrow -= grow;
+        }
+        const int cross = layout.align == ALIGN_STRETCH ? crossSpace : std::min(row ? size.y : size.x, crossSpace);
+        const int crossPosition = alignOffset(layout.align, crossSpace, cross);
+        if (row)
+          areas[i].set(inner.x + position, inner.y + crossPosition, main, cross);
+        else
+          areas[i].set(inner.x + crossPosition, inner.y + position, cross, main);
+        position += main + layout.gap;
+      }
+    }
+  }
+  bool moved = false;
+  for (size_t i = 0; i < children.size(); ++i) {
+    const base::Rect& old = children[i]->rect;
+    const base::Rect& next = areas[i];
+    moved = moved || old.x != next.x || old.y != next.y || old.w != next.w || old.h != next.h;
+    children[i]->arrange(next);
+  }
+  if (moved) ++layoutGeneration;
+}
 }  // namespace widget
@@ -30,11 +30,18 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 #pragma once
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include "base/point.hpp"
 #include "base/rect.hpp"
 #include "events/events.hpp"
 #include "events/signal.hpp"
 #include "module/module.hpp"
+#include "widget/layout.hpp"
+#include "widget/render_state.hpp"
 #include "widget/stylesheet.hpp"
 
 namespace widget {
@@ -44,12 +51,90 @@ class Widget : public module::Module {
 
  public:
   Widget() = default;
+  Widget(const Widget&) = delete;
+  Widget& operator=(const Widget&) = delete;
+  /**
+   * Detaches the widget from its parent and its children.
+   */
+  ~Widget() override;
   /**
    * Custom, widget-specific code interpreting the mouse input.
    * @param ms reference to the mouse object
    */
   void mouse(TCOD_mouse_t&) override {}
+  /**
+   * Updates the mouse interaction flags and drags the widget, then passes the event on to the children.
+   */
   void onEvent(const SDL_Event&) override;
+  /**
+   * Moves the widget back inside the root console if it has been resized.
+   */
+  void onResize(int width, int height) override;
+  /**
+   * Adds whatever the widget's look depends on, besides its own size, style, mouse interaction flags and children, to
+   * the render state: displayed values, texts...
+   * @param state the render state
+   */
+  virtual void hashState(RenderState&) {}
+  /**
+   * Sets the widget's classes, which the style sheet rules select with <code>.class</code>. The style is resolved again
+   * on the next frame.
+   * @param styleClass the classes, separated with spaces
+   */
+  void setStyleClass(std::string_view styleClass);
+  const std::string& getStyleClass() const { return styleClass; }
+  /**
+   * Sets the widget's ID, which the style sheet rules select with <code>#id</code>. The style is resolved again on the
+   * next frame.
+   * @param id the ID
+   */
+  void setStyleId(std::string_view id);
+  const std::string& getStyleId() const { return styleId; }
+  /**
+   * Fetches the widget's type, which the style sheet rules select by name.
+   * @return the type name
+   */
+  virtual const char* getStyleTag() const { return "widget"; }
+
+  /**
+   * Moves the widget into another parent's child list. The widget's position becomes relative to the new parent.
+   * @param parent the new parent, or <code>nullptr</code> to make the widget a top level one
+   */
+  void setParent(Widget* parent);
+  Widget* getParent() const { return parent; }
+  /**
+   * Fetches the child widgets, in layout and event order. The parent doesn't own them.
+   * @return the child widgets
+   */
+  const std::vector<Widget*>& getChildren() const { return children; }
+  /**
+   * Gets the position of the widget's top left corner on the root console.
+   * @return the position on the root console
+   */
+  base::Point getScreenPosition() const;
+  /**
+   * Sets how the children are placed. They are laid out again on the next frame.
+   * @param layout the layout
+   */
+  void setLayout(const Layout& layout);
+  const Layout& getLayout() const { return layout; }
+  /**
+   * Sets the size constraints the parent's layout applies to the widget. The parent is laid out again on the next
+   * frame.
+   * @param constraints the constraints
+   */
+  void setConstraints(const LayoutConstraints& constraints);
+  const LayoutConstraints& getConstraints() const { return constraints; }
+  /**
+   * Marks the widget as needing to be measured and laid out again, for instance after its contents changed. The
+   * ancestors are marked as well, as their size may depend on the widget's; siblings are moved but not re-measured.
+   */
+  void markLayoutDirty();
+  /**
+   * Lays the widget tree out if anything changed since the last time. Only subtrees that are dirty or whose size
+   * changed are visited. Called by top level widgets before rendering; does nothing on child widgets.
+   */
+  void updateLayout();
 
   /**
    * Signal launched when the mouse cursor enters the widget.
@@ -90,6 +175,34 @@ class Widget : public module::Module {
   widget::StyleSheet style{};
 
  protected:
+  /**
+   * Composites the widget onto the root console at its position on the screen. Its look is kept in an offscreen console which is only
+   * drawn again, through <code>renderSurface()</code>, when the widget's size, style, mouse interaction flags or
+   * <code>hashState()</code> changed since the previous frame; otherwise only the blit is paid for.
+   * @param foregroundAlpha the opacity of the foreground colours
+   * @param backgroundAlpha the opacity of the background colours
+   */
+  void renderCached(float foregroundAlpha = 1.0f, float backgroundAlpha = 1.0f);
+  /**
+   * Draws the widget's look. Called by <code>renderCached()</code> when the cached look is out of date.
+   * @param surface the offscreen console, the size of the widget, still holding the previous look
+   */
+  virtual void renderSurface(TCODConsole&) {}
+  /**
+   * Forces the cached look to be drawn again on the next frame.
+   */
+  void invalidate() { surfaceState = 0; }
+  /**
+   * Brings the style up to date with the engine's style rules. The resolved style is only looked up again when the
+   * widget's class or ID changed or the rules have been reloaded; properties set manually are left untouched.
+   */
+  void refreshStyle();
+  /**
+   * Measures the size the widget's contents need, when no preferred size is given in its constraints. Only called on
+   * widgets that don't lay children out.
+   * @return the contents' width and height
+   */
+  virtual base::Point measureContent() { return base::Point{}; }
   /**
    * Sets the widget's active zone reacting to dragging.
    * @param x the drag zone's top left corner's <i>x</i> coordinate
@@ -121,5 +234,31 @@ class Widget : public module::Module {
   base::Point closeButton{};  // close button coordinates
   bool canDrag{false};
   bool isDragging{false};
+
+ private:
+  std::unique_ptr<TCODConsole> surface{};  // the cached look of the widget
+  uint64_t surfaceState{0};  // render state the surface was drawn with, 0 if none
+  std::string styleClass{};
+  std::string styleId{};
+  const StyleSheet* resolvedStyle{nullptr};  // the style resolved from the rules, null if out of date
+  uint32_t styleGeneration{0};  // generation of the rules the style was resolved from
+  std::vector<Widget*> children{};
+  Layout layout{};
+  LayoutConstraints constraints{};
+  base::Point measuredSize{};  // size wanted by the widget, valid unless measureDirty is set
+  base::Point arrangedSize{-1, -1};  // size the children have been laid out for
+  bool measureDirty{true};
+  bool arrangeDirty{true};
+  uint32_t layoutGeneration{0};  // incremented whenever a child is moved or resized
+  /**
+   * Computes the size the widget wants, from its constraints, its children or its contents.
+   * @return the width and height
+   */
+  base::Point measure();
+  /**
+   * Places the widget and lays its children out, unless its size didn't change and nothing is dirty.
+   * @param area the widget's area, relative to its parent
+   */
+  void arrange(const base::Rect& area);
 };
 }  // namespace widget
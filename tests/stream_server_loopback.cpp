@@ -0,0 +1,149 @@
+/* BSD 3-Clause License
+ *
+ * Copyright © 2008-2022, Jice, Odiminox and the salient contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+// Streams a console over loopback TCP and a Unix domain socket at the same time and checks that both spectators
+// decode the frames the server was given.
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+#include <salient/net/stream_server.hpp>
+
+namespace {
+constexpr uint16_t FIRST_PORT = 47310;
+constexpr int PORT_ATTEMPTS = 20;
+constexpr auto TIMEOUT = std::chrono::seconds{5};
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+  if (condition) return;
+  std::fprintf(stderr, "FAILED: %s\n", what);
+  ++failures;
+}
+
+int connectTcp(uint16_t port) {
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+int connectUnix(const std::filesystem::path& path) {
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+  if (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+bool sameConsole(const tcod::Console& a, const tcod::Console& b) {
+  if (a.get_width() != b.get_width() || a.get_height() != b.get_height()) return false;
+  for (auto i = a.begin(), j = b.begin(); i != a.end(); ++i, ++j) {
+    if (i->ch != j->ch || i->fg.r != j->fg.r || i->fg.g != j->fg.g || i->fg.b != j->fg.b || i->bg.r != j->bg.r ||
+        i->bg.g != j->bg.g || i->bg.b != j->bg.b) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// resubmits the frame until the spectator has decoded it, as the server only streams the latest frame it is given
+bool receive(net::ConsoleStreamServer& server, int fd, net::ConsoleStreamDecoder& decoder, const tcod::Console& frame) {
+  const auto deadline = std::chrono::steady_clock::now() + TIMEOUT;
+  while (std::chrono::steady_clock::now() < deadline) {
+    server.submitFrame(*frame.get());
+    pollfd polled{fd, POLLIN, 0};
+    if (poll(&polled, 1, 10) <= 0) continue;
+    uint8_t buffer[4096];
+    const ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+    if (received <= 0 || !decoder.feed(buffer, static_cast<size_t>(received))) return false;
+    if (sameConsole(decoder.getConsole(), frame)) return true;
+  }
+  return false;
+}
+}  // namespace
+
+int main() {
+  const std::filesystem::path unixPath =
+      std::filesystem::temp_directory_path() / ("salient_stream_" + std::to_string(getpid()) + ".sock");
+  net::ConsoleStreamServer server{};
+  uint16_t port = FIRST_PORT;
+  while (!server.listenTcp(port) && port < FIRST_PORT + PORT_ATTEMPTS) ++port;
+  check(server.isRunning(), "listening on a loopback TCP port");
+  // adding a listener to a running server must keep the others
+  check(server.listenUnix(unixPath), "listening on a Unix domain socket");
+  check(std::filesystem::exists(unixPath), "the socket file exists while the server runs");
+
+  const int tcpClient = connectTcp(port);
+  const int unixClient = connectUnix(unixPath);
+  check(tcpClient >= 0, "connecting over TCP");
+  check(unixClient >= 0, "connecting over the Unix domain socket");
+
+  tcod::Console frame{40, 12};
+  for (auto& tile : frame) tile = TCOD_ConsoleTile{'.', {200, 200, 200, 255}, {0, 0, 40, 255}};
+  net::ConsoleStreamDecoder tcpDecoder{};
+  net::ConsoleStreamDecoder unixDecoder{};
+  if (tcpClient >= 0) check(receive(server, tcpClient, tcpDecoder, frame), "TCP spectator receives the keyframe");
+  if (unixClient >= 0) check(receive(server, unixClient, unixDecoder, frame), "Unix spectator receives the keyframe");
+
+  // a delta touching a few cells
+  frame.at({3, 2}) = TCOD_ConsoleTile{'@', {255, 255, 0, 255}, {0, 0, 40, 255}};
+  frame.at({39, 11}) = TCOD_ConsoleTile{0x2588, {10, 20, 30, 255}, {40, 50, 60, 255}};
+  if (tcpClient >= 0) check(receive(server, tcpClient, tcpDecoder, frame), "TCP spectator receives the delta");
+  if (unixClient >= 0) check(receive(server, unixClient, unixDecoder, frame), "Unix spectator receives the delta");
+
+  if (tcpClient >= 0) close(tcpClient);
+  if (unixClient >= 0) close(unixClient);
+  server.stop();
+  check(!std::filesystem::exists(unixPath), "the socket file is removed when the server stops");
+  if (failures == 0) std::puts("stream_server_loopback: OK");
+  return failures == 0 ? 0 : 1;
+}